@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <memory>
+#include <sys/wait.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include <glib.h>
+#pragma GCC diagnostic pop
+
+#include "async_command.hh"
+#include "messages.h"
+
+struct RunningCommand
+{
+    const std::string command_;
+    Automounter::CommandDoneFn done_;
+    const gint64 started_us_;
+
+    explicit RunningCommand(const std::string &command,
+                            Automounter::CommandDoneFn &&done):
+        command_(command),
+        done_(std::move(done)),
+        started_us_(g_get_monotonic_time())
+    {}
+};
+
+static void command_terminated(GPid pid, gint status, gpointer user_data)
+{
+    std::unique_ptr<RunningCommand> cmd(static_cast<RunningCommand *>(user_data));
+    const int64_t duration_us = g_get_monotonic_time() - cmd->started_us_;
+
+    g_spawn_close_pid(pid);
+
+    const bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    if(succeeded)
+        msg_vinfo(MESSAGE_LEVEL_DIAG, "Command \"%s\" took %lld us",
+                  cmd->command_.c_str(), static_cast<long long>(duration_us));
+    else
+        msg_error(0, LOG_ERR, "Command \"%s\" failed (status %d)",
+                  cmd->command_.c_str(), status);
+
+    cmd->done_(succeeded, duration_us);
+}
+
+bool Automounter::run_command_async(const std::string &command, CommandDoneFn &&done)
+{
+    msg_vinfo(MESSAGE_LEVEL_NORMAL, "Executing: %s", command.c_str());
+
+    gchar *argv[] =
+    {
+        const_cast<gchar *>("/bin/sh"),
+        const_cast<gchar *>("-c"),
+        const_cast<gchar *>(command.c_str()),
+        nullptr,
+    };
+
+    GPid pid;
+    GError *error = nullptr;
+
+    if(!g_spawn_async(nullptr, argv, nullptr, G_SPAWN_DO_NOT_REAP_CHILD,
+                      nullptr, nullptr, &pid, &error))
+    {
+        msg_error(0, LOG_ERR, "Failed running \"%s\": %s",
+                  command.c_str(), error != nullptr ? error->message : "unknown error");
+
+        if(error != nullptr)
+            g_error_free(error);
+
+        return false;
+    }
+
+    g_child_watch_add(pid, command_terminated,
+                      new RunningCommand(command, std::move(done)));
+
+    return true;
+}
+
+struct NativeMountJob
+{
+    const Automounter::NativeMountRequest request_;
+    Automounter::NativeMountDoneFn done_;
+    const gint64 started_us_;
+    GThread *thread_;
+    bool succeeded_;
+    std::string error_message_;
+
+    explicit NativeMountJob(Automounter::NativeMountRequest &&request,
+                            Automounter::NativeMountDoneFn &&done):
+        request_(std::move(request)),
+        done_(std::move(done)),
+        started_us_(g_get_monotonic_time()),
+        thread_(nullptr),
+        succeeded_(false)
+    {}
+};
+
+static gboolean native_mount_finished(gpointer user_data)
+{
+    std::unique_ptr<NativeMountJob> job(static_cast<NativeMountJob *>(user_data));
+    const int64_t duration_us = g_get_monotonic_time() - job->started_us_;
+
+    g_thread_join(job->thread_);
+
+    if(job->succeeded_)
+        msg_vinfo(MESSAGE_LEVEL_DIAG, "Mounting %s took %lld us",
+                  job->request_.source_.c_str(), static_cast<long long>(duration_us));
+    else
+        msg_error(0, LOG_ERR, "Failed mounting %s to %s: %s",
+                  job->request_.source_.c_str(), job->request_.target_.c_str(),
+                  job->error_message_.c_str());
+
+    job->done_(job->succeeded_, duration_us, job->error_message_);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*!
+ * Worker thread, must not touch anything but its job.
+ */
+static gpointer native_mount_thread(gpointer user_data)
+{
+    auto *job = static_cast<NativeMountJob *>(user_data);
+
+    job->succeeded_ = Automounter::mount_native(job->request_, job->error_message_);
+    g_idle_add(native_mount_finished, job);
+
+    return nullptr;
+}
+
+bool Automounter::run_native_mount_async(NativeMountRequest &&request,
+                                         NativeMountDoneFn &&done)
+{
+    msg_vinfo(MESSAGE_LEVEL_NORMAL, "Mounting %s (%s) to %s",
+              request.source_.c_str(), request.fstype_.c_str(),
+              request.target_.c_str());
+
+    auto *job = new NativeMountJob(std::move(request), std::move(done));
+    GError *error = nullptr;
+
+    /* the thread cannot finish before we have returned to the main loop */
+    job->thread_ = g_thread_try_new("mount", native_mount_thread, job, &error);
+
+    if(job->thread_ == nullptr)
+    {
+        msg_error(0, LOG_ERR, "Failed starting mount thread: %s",
+                  error != nullptr ? error->message : "unknown error");
+
+        if(error != nullptr)
+            g_error_free(error);
+
+        delete job;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef ASYNC_COMMAND_HH
+#define ASYNC_COMMAND_HH
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+#include "native_mount.hh"
+
+namespace Automounter
+{
+
+/*!
+ * Function called when a command run by #Automounter::run_command_async()
+ * has terminated.
+ *
+ * The first parameter tells whether or not the command has exited with
+ * status 0, the second parameter is its run time in microseconds.
+ */
+using CommandDoneFn = std::function<void(bool, int64_t)>;
+
+/*!
+ * Run shell command without blocking the main loop.
+ *
+ * The command is passed to \c /bin/sh in a child process. Once the child has
+ * terminated, \p done is called from the main loop.
+ *
+ * \returns
+ *     True if the child process has been started, false on error. The
+ *     callback is not called in the latter case.
+ */
+bool run_command_async(const std::string &command, CommandDoneFn &&done);
+
+/*!
+ * Function called when a mount started by
+ * #Automounter::run_native_mount_async() has finished.
+ *
+ * Like #Automounter::CommandDoneFn, with the reason of failure as third
+ * parameter (empty on success).
+ */
+using NativeMountDoneFn = std::function<void(bool, int64_t, const std::string &)>;
+
+/*!
+ * Mount file system in a worker thread without blocking the main loop.
+ *
+ * See #Automounter::mount_native(). Once the mount has finished, \p done is
+ * called from the main loop.
+ *
+ * \returns
+ *     True if the worker thread has been started, false on error. The
+ *     callback is not called in the latter case.
+ */
+bool run_native_mount_async(NativeMountRequest &&request, NativeMountDoneFn &&done);
+
+}
+
+#endif /* !ASYNC_COMMAND_HH */
@@ -19,10 +19,25 @@
  * MA  02110-1301, USA.
  */
 
+#include <cstdio>
+
 #include "autodir.hh"
 #include "external_tools.hh"
 #include "os.h"
 
+std::string Automounter::mk_numbered_path(const std::string &dir, int number)
+{
+    char buffer[16];
+    const int length = snprintf(buffer, sizeof(buffer), "/%d", number);
+
+    std::string result;
+    result.reserve(dir.length() + length);
+    result.append(dir);
+    result.append(buffer, length);
+
+    return result;
+}
+
 bool Automounter::Directory::create()
 {
     if(is_created_)
@@ -122,33 +137,62 @@ bool Automounter::Mountpoint::probe(bool store_state)
     return is_mounted;
 }
 
-bool Automounter::Mountpoint::mount(const std::string &device_name,
-                                    const std::string &mount_options)
+std::string
+Automounter::Mountpoint::mk_mount_command(const std::string &device_name,
+                                          const std::string &mount_options) const
 {
     if(directory_.str().empty())
     {
         MSG_BUG("Cannot mount empty mointpoint");
-        return false;
+        return std::string();
     }
 
     if(!directory_.exists(FailIf::NOT_FOUND))
     {
         MSG_BUG("Mointpoint \"%s\" does not exist", directory_.str().c_str());
-        return false;
+        return std::string();
     }
 
     if(is_mounted_)
     {
         MSG_BUG("Mointpoint \"%s\" already mounted", directory_.str().c_str());
-        return false;
+        return std::string();
     }
 
-    if(os_system_formatted(msg_is_verbose(MESSAGE_LEVEL_NORMAL),
-                           "%s %s %s %s \"%s\"",
-                           tools_.mount_.executable_.c_str(),
-                           tools_.mount_.options_.c_str(),
-                           mount_options.c_str(),
-                           device_name.c_str(), directory_.str().c_str()) != 0)
+    std::string command;
+    command.reserve(tools_.mount_.executable_.length() +
+                    tools_.mount_.options_.length() + mount_options.length() +
+                    device_name.length() + directory_.str().length() + 6);
+    command.append(tools_.mount_.executable_).push_back(' ');
+    command.append(tools_.mount_.options_).push_back(' ');
+    command.append(mount_options).push_back(' ');
+    command.append(device_name).append(" \"");
+    command.append(directory_.str()).push_back('"');
+
+    return command;
+}
+
+std::string Automounter::Mountpoint::mk_unmount_command() const
+{
+    std::string command;
+    command.reserve(tools_.unmount_.executable_.length() +
+                    tools_.unmount_.options_.length() +
+                    directory_.str().length() + 4);
+    command.append(tools_.unmount_.executable_).push_back(' ');
+    command.append(tools_.unmount_.options_).append(" \"");
+    command.append(directory_.str()).push_back('"');
+
+    return command;
+}
+
+bool Automounter::Mountpoint::mount(const std::string &device_name,
+                                    const std::string &mount_options)
+{
+    const auto command(mk_mount_command(device_name, mount_options));
+
+    if(command.empty() ||
+       os_system_formatted(msg_is_verbose(MESSAGE_LEVEL_NORMAL),
+                           "%s", command.c_str()) != 0)
         return false;
 
     is_mounted_ = true;
@@ -162,10 +206,7 @@ void Automounter::Mountpoint::do_cleanup(bool thoroughly)
         is_mounted_ = false;
 
         if(os_system_formatted(msg_is_verbose(MESSAGE_LEVEL_NORMAL),
-                               "%s %s \"%s\"",
-                               tools_.unmount_.executable_.c_str(),
-                               tools_.unmount_.options_.c_str(),
-                               directory_.str().c_str()) == 0)
+                               "%s", mk_unmount_command().c_str()) == 0)
             msg_vinfo(MESSAGE_LEVEL_DIAG,
                       "Unmounted %s", directory_.str().c_str());
         else
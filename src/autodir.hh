@@ -30,6 +30,14 @@ namespace Automounter
 
 class ExternalTools;
 
+/*!
+ * Compose path to a numbered entry in given directory.
+ *
+ * The result is \p dir, followed by a slash and the decimal representation
+ * of \p number. The string is allocated at its final size.
+ */
+std::string mk_numbered_path(const std::string &dir, int number);
+
 enum class FailIf
 {
     NOT_FOUND,
@@ -124,6 +132,28 @@ class Mountpoint
     bool mount(const std::string &device_name,
                const std::string &mount_options);
 
+    /*!
+     * Command line for mounting a device to this mountpoint.
+     *
+     * For running the mount tool asynchronously. Report the outcome by
+     * calling #Automounter::Mountpoint::set_mounted().
+     *
+     * \returns
+     *     The command, or an empty string if the mountpoint cannot be used.
+     */
+    std::string mk_mount_command(const std::string &device_name,
+                                 const std::string &mount_options) const;
+
+    /*!
+     * Command line for unmounting this mountpoint.
+     */
+    std::string mk_unmount_command() const;
+
+    /*!
+     * Record result of asynchronously run mount or unmount tool.
+     */
+    void set_mounted(bool is_mounted) { is_mounted_ = is_mounted; }
+
     bool exists(FailIf fail_if) const { return directory_.exists(fail_if); }
     bool is_mounted() const { return is_mounted_; }
     const std::string &str() const { return directory_.str(); }
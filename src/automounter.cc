@@ -23,57 +23,109 @@
 #include <config.h>
 #endif /* HAVE_CONFIG_H */
 
-#include <sstream>
 #include <cstring>
 #include <climits>
 #include <algorithm>
-#include <array>
+#include <memory>
 
 #include "automounter.hh"
+#include "async_command.hh"
+#include "devices_os.hh"
+#include "usb_topology.hh"
 #include "external_tools.hh"
 #include "dbus_iface_deep.h"
+#include "dbus_properties.hh"
+#include "dbus_objects.h"
+#include "dbus_wait.h"
+#include "dbus_changes.hh"
+#include "shm_snapshot.hh"
+#include "event_socket.hh"
+#include "notify_socket.hh"
 #include "messages.h"
 #include "os.h"
 
-const char *Automounter::FSMountOptions::get_options(const std::string &fstype) const
+static void emit_new_volume(const Devices::Volume &vol)
 {
-    auto it = options_.find(fstype);
+    const unsigned int index = vol.get_index() >= 0 ? vol.get_index() : UINT_MAX;
 
-    if(it != options_.end())
-    {
-        if(it->second != nullptr)
-            return it->second;
-    }
-    else
-        msg_error(0, LOG_NOTICE,
-                  "WARNING: Encountered unsupported file system \"%s\"",
-                  fstype.c_str());
-
-    return "";
-}
-
-static void announce_new_volume(const Devices::Volume &vol)
-{
     /* note: this duplicates part of #dbusmethod_get_all() */
     tdbus_moun_ta_emit_new_volume(dbus_get_mounta_iface(),
-                                  vol.get_index() >= 0 ? vol.get_index() : UINT_MAX,
+                                  index,
                                   vol.get_label().c_str(),
                                   vol.get_mountpoint_name().c_str(),
                                   vol.get_device()->get_id(),
                                   vol.get_volume_uuid().c_str());
+    tdbus_moun_ta2_emit_new_volume(dbus_get_mounta2_iface(),
+                                   index,
+                                   vol.get_label().c_str(),
+                                   vol.get_mountpoint_name().c_str(),
+                                   vol.get_device()->get_id(),
+                                   vol.get_volume_uuid().c_str(),
+                                   dbus_mk_volume_properties(vol));
+    dbus_objects_add_volume(vol);
+}
+
+static void emit_new_device(const Devices::Device &dev)
+{
+    /* note: this duplicates part of #dbusmethod_get_all() */
+    tdbus_moun_ta_emit_new_usbdevice(dbus_get_mounta_iface(),
+                                     dev.get_id(),
+                                     dev.get_display_name(),
+                                     dev.get_device_uuid().c_str(),
+                                     dev.get_working_directory().str().c_str(),
+                                     dev.get_usb_port().c_str());
+    tdbus_moun_ta2_emit_new_usbdevice(dbus_get_mounta2_iface(),
+                                      dev.get_id(),
+                                      dev.get_display_name(),
+                                      dev.get_device_uuid().c_str(),
+                                      dev.get_working_directory().str().c_str(),
+                                      dev.get_usb_port().c_str(),
+                                      dbus_mk_device_properties(dev));
+    dbus_objects_add_device(dev);
+}
+
+static void announce_new_volume(const Devices::Volume &vol,
+                                Automounter::ChangeLog &changes)
+{
+    changes.append(Automounter::ChangeLog::Kind::VOLUME_ADDED,
+                   vol.get_device()->get_id(),
+                   vol.get_index() >= 0 ? vol.get_index() : UINT_MAX);
+
+    if(dbus_is_ready())
+        emit_new_volume(vol);
+
+    dbus_wait_volume_mounted(vol);
+    event_socket_volume_added(vol, changes.get_generation());
+}
+
+static void announce_unmounted_volume(const Devices::Volume &vol,
+                                      Automounter::ChangeLog &changes)
+{
+    changes.append(Automounter::ChangeLog::Kind::VOLUME_REMOVED,
+                   vol.get_device()->get_id(),
+                   vol.get_index() >= 0 ? vol.get_index() : UINT_MAX);
+
+    if(dbus_is_ready())
+        tdbus_moun_ta2_emit_volume_removed(dbus_get_mounta2_iface(),
+                                           vol.get_index() >= 0 ? vol.get_index() : UINT_MAX,
+                                           vol.get_device()->get_id(),
+                                           vol.get_volume_uuid().c_str());
+
+    dbus_objects_remove_volume(vol);
+    event_socket_volume_removed(vol, changes.get_generation());
 }
 
-static void announce_new_device(const Devices::Device &dev)
+static void announce_new_device(const Devices::Device &dev,
+                                Automounter::ChangeLog &changes)
 {
     if(dev.get_working_directory().exists(Automounter::FailIf::NOT_FOUND))
     {
-        /* note: this duplicates part of #dbusmethod_get_all() */
-        tdbus_moun_ta_emit_new_usbdevice(dbus_get_mounta_iface(),
-                                         dev.get_id(),
-                                         dev.get_display_name().c_str(),
-                                         dev.get_device_uuid().c_str(),
-                                         dev.get_working_directory().str().c_str(),
-                                         dev.get_usb_port().c_str());
+        changes.append(Automounter::ChangeLog::Kind::DEVICE_ADDED, dev.get_id());
+
+        if(dbus_is_ready())
+            emit_new_device(dev);
+
+        event_socket_device_added(dev, changes.get_generation());
     }
 }
 
@@ -81,15 +133,9 @@ static void announce_new_device(const Devices::Device &dev)
  * Check whether or not a device symlink name is of interest to us.
  */
 static bool is_device_name_acceptable(const char *device_name,
+                                      const std::vector<std::string> &allowed_prefixes,
                                       bool check_for_tempfiles)
 {
-    /* allow only certain prefixes */
-    static const std::array<const std::string, 2> allowed_prefixes
-    {
-        "usb-",
-        "ata-",
-    };
-
     if(check_for_tempfiles)
     {
         const char *temp = strrchr(device_name, '/');
@@ -97,6 +143,7 @@ static bool is_device_name_acceptable(const char *device_name,
             device_name = temp + 1;
     }
 
+    /* allow only certain prefixes */
     if(std::none_of(allowed_prefixes.begin(), allowed_prefixes.end(),
             [&device_name] (const auto &prefix)
             {
@@ -135,29 +182,51 @@ static bool is_device_name_acceptable(const char *device_name,
 /*!
  * Filter devices here.
  */
-static void apply_device_filter(Devices::Device &dev)
+static void apply_device_filter(Devices::Device &dev,
+                                const std::vector<std::string> &allowed_prefixes)
 {
     msg_log_assert(dev.get_state() == Devices::Device::PROBED);
 
-    if(is_device_name_acceptable(dev.get_display_name().c_str(), false))
+    if(is_device_name_acceptable(dev.get_display_name(), allowed_prefixes, false))
         dev.accept();
     else
         dev.reject();
 }
 
 /*!
- * We could filter volumes here.
+ * Filter out volumes we cannot or should not mount.
  *
- * In case a volume should be filtered out, #Devices::Volume::reject() should
- * be called.
+ * Volumes with a file system type classified as unsupported or not allowed
+ * by the configured policy are rejected right away. Unknown file systems are
+ * tried anyway (unless there is a list of allowed file systems), but without
+ * any extra mount options.
  */
-static void apply_volume_filter(Devices::Volume &vol)
+static void apply_volume_filter(Devices::Volume &vol,
+                                const Automounter::FSMountOptions &mount_options)
 {
     msg_log_assert(vol.get_state() == Devices::Volume::PENDING);
+
+    const auto *const fs = mount_options.lookup(vol.get_fstype());
+
+    if(!mount_options.is_allowed(vol.get_fstype()))
+    {
+        msg_info("Rejected volume %s (file system \"%s\" not allowed by policy)",
+                 vol.get_device_name().c_str(), vol.get_fstype().c_str());
+        vol.reject();
+    }
+    else if(fs == nullptr)
+        msg_error(0, LOG_NOTICE,
+                  "WARNING: Encountered unknown file system \"%s\"",
+                  vol.get_fstype().c_str());
+    else if(!fs->is_supported())
+    {
+        msg_info("Rejected volume %s (unsupported file system \"%s\")",
+                 vol.get_device_name().c_str(), fs->name);
+        vol.reject();
+    }
 }
 
-static void try_mount_volume(Devices::Volume &vol,
-                             const Automounter::FSMountOptions &mount_options)
+void Automounter::Core::try_mount_volume(Devices::Volume &vol)
 {
     switch(vol.get_state())
     {
@@ -180,6 +249,15 @@ static void try_mount_volume(Devices::Volume &vol,
       case Devices::Volume::REMOVED:
         MSG_BUG("Attempted to remount removed device");
         return;
+
+      case Devices::Volume::MOUNTING:
+      case Devices::Volume::UNMOUNTING:
+        /* operation requested by client is in progress */
+        return;
+
+      case Devices::Volume::UNMOUNTED:
+        /* stays unmounted until a client asks for it */
+        return;
     }
 
     /*
@@ -188,18 +266,18 @@ static void try_mount_volume(Devices::Volume &vol,
      * the device, but not the filtered volumes. If all available volumes are
      * filtered, then the device will still be visible, but appear empty.
      */
-    apply_volume_filter(vol);
+    apply_volume_filter(vol, mount_options_);
 
     if(vol.get_state() != Devices::Volume::PENDING)
         return;
 
-    if(!vol.get_device()->get_working_directory().exists(Automounter::FailIf::NOT_FOUND))
+    if(!vol.get_device()->get_working_directory().exists(FailIf::NOT_FOUND))
         return;
 
     /*
      * None of the filters kicked in, so we'll try to mount the volume now.
      */
-    if(!vol.get_device()->get_working_directory().exists(Automounter::FailIf::JUST_WATCHING))
+    if(!vol.get_device()->get_working_directory().exists(FailIf::JUST_WATCHING))
     {
         /* watch mode */
         vol.set_unmanaged_mountpoint_directory();
@@ -210,30 +288,190 @@ static void try_mount_volume(Devices::Volume &vol,
                  vol.get_mountpoint_name().c_str(),
                  vol.get_device()->get_usb_port().c_str());
 
-        announce_new_volume(vol);
+        announce_new_volume(vol, changes_);
     }
-    else if(vol.mk_mountpoint_directory() && vol.mount(mount_options))
+    else
     {
-        vol.set_mounted();
+        /* mounted in the background, see #Automounter::Core::finish_mount_volume() */
+        mount_queue_.emplace_back(vol.get_device()->get_id(), vol.get_index());
+        start_queued_mounts();
+    }
+}
 
-        msg_info("Mounted %s to %s (USB port %s)",
-                 vol.get_device_name().c_str(),
-                 vol.get_mountpoint_name().c_str(),
-                 vol.get_device()->get_usb_port().c_str());
+/*!
+ * Start mount tools for queued volumes, up to the configured limit.
+ *
+ * Volumes of a device are independent of each other, so there is no need to
+ * mount them one after another. Each volume is announced as soon as its own
+ * mount has completed.
+ */
+void Automounter::Core::start_queued_mounts()
+{
+    while(running_mounts_ < max_parallel_mounts_ && !mount_queue_.empty())
+    {
+        const auto next(mount_queue_.front());
+        mount_queue_.pop_front();
+
+        auto *vol = find_volume(next.first, next.second);
+
+        /* removed, or mounted on request in the meantime */
+        if(vol == nullptr || vol->get_state() != Devices::Volume::PENDING)
+            continue;
 
-        announce_new_volume(vol);
+        std::string command;
+
+        if(!vol->begin_mount(mount_options_, select_driver(*vol, nullptr), command))
+        {
+            msg_error(0, LOG_ERR, "Failed mounting device %s",
+                      vol->get_device_name().c_str());
+            continue;
+        }
+
+        const std::string devname(vol->get_device_name());
+        const std::string mountpoint(vol->get_mountpoint_name());
+
+        if(start_mount(*vol, command,
+                [this, next, devname, mountpoint]
+                (bool succeeded, int64_t duration_us,
+                 const std::string &error_message)
+                {
+                    OperationResult result;
+
+                    --running_mounts_;
+                    finish_mount_volume(next.first, next.second, devname,
+                                        mountpoint, succeeded, error_message,
+                                        result);
+                    start_queued_mounts();
+                }))
+            ++running_mounts_;
+        else
+        {
+            vol->finish_mount(false);
+            msg_error(0, LOG_ERR, "Failed mounting device %s", devname.c_str());
+        }
     }
-    else
+
+    if(initial_scan_done_ && running_mounts_ == 0 && mount_queue_.empty())
+        set_initial_scan_complete();
+}
+
+/*!
+ * Preferred driver for mounting given volume, or the one after \p previous.
+ */
+const Automounter::FSDriver *
+Automounter::Core::select_driver(const Devices::Volume &vol,
+                                 const FSDriver *previous) const
+{
+    const auto *const fs = mount_options_.lookup(vol.get_fstype());
+
+    return fs != nullptr
+        ? mount_options_.select_driver(*fs, use_native_mount_, previous)
+        : nullptr;
+}
+
+/*!
+ * Mount volume in the background, either by the mount tool or natively.
+ *
+ * The \p command is taken from #Devices::Volume::begin_mount(). It is
+ * ignored if the kernel mount API is to be used. If a specific file system
+ * driver has been chosen and fails, the next available driver is tried
+ * before \p done is called.
+ */
+bool Automounter::Core::start_mount(const Devices::Volume &vol,
+                                    const std::string &command,
+                                    NativeMountDoneFn &&done)
+{
+    const auto *const driver = vol.get_fs_driver();
+
+    if(driver != nullptr)
     {
-        vol.set_unusable();
+        const auto device_id = vol.get_device()->get_id();
+        const int volume_index = vol.get_index();
+        const std::string devname(vol.get_device_name());
 
-        msg_error(0, LOG_ERR, "Failed mounting device %s",
-                  vol.get_device_name().c_str());
+        done =
+            [this, device_id, volume_index, devname, driver, done = std::move(done)]
+            (bool succeeded, int64_t duration_us, const std::string &error_message)
+            {
+                if(succeeded ||
+                   !retry_mount_with_next_driver(device_id, volume_index, devname,
+                                                 *driver, duration_us, done))
+                    done(succeeded, duration_us, error_message);
+            };
+    }
+
+    if(use_native_mount_)
+    {
+        const std::string &fstype(vol.get_fstype());
+
+        /* same order as on the mount tool's command line, so that file
+         * system options may override the generic ones */
+        std::string options(tools_.mount_.options_);
+        options.push_back(' ');
+        options.append(driver != nullptr
+                       ? mount_options_.get_driver_options(*driver)
+                       : mount_options_.get_options(fstype));
+
+        return run_native_mount_async(
+                    NativeMountRequest(vol.get_device_name(),
+                                       vol.get_mountpoint_name(),
+                                       driver != nullptr ? driver->name : fstype,
+                                       options.c_str(),
+                                       mount_options_.get_mount_flags(fstype)),
+                    std::move(done));
     }
+
+    return run_command_async(command,
+                [done = std::move(done)] (bool succeeded, int64_t duration_us)
+                {
+                    done(succeeded, duration_us, std::string());
+                });
+}
+
+/*!
+ * Automatic fallback to the next file system driver.
+ *
+ * \returns
+ *     True if another driver is being tried, in which case \p done will be
+ *     called when that attempt has finished (with the run times of both
+ *     attempts added up). False if there is no other driver or the volume
+ *     is gone; the caller must call \p done then.
+ */
+bool Automounter::Core::retry_mount_with_next_driver(Devices::ID::value_type device_id,
+                                                     int volume_index,
+                                                     const std::string &devname,
+                                                     const FSDriver &failed_driver,
+                                                     int64_t failed_us,
+                                                     const NativeMountDoneFn &done)
+{
+    auto *vol = find_volume(device_id, volume_index);
+
+    if(vol == nullptr || vol->get_state() != Devices::Volume::MOUNTING ||
+       vol->get_device_name() != devname)
+        return false;
+
+    const auto *const next = select_driver(*vol, &failed_driver);
+
+    if(next == nullptr)
+        return false;
+
+    msg_info("Mounting %s using driver %s failed, trying %s",
+             devname.c_str(), failed_driver.name, next->name);
+
+    std::string command;
+
+    if(!vol->retry_mount(mount_options_, *next, command))
+        return false;
+
+    return start_mount(*vol, command,
+                [done, failed_us]
+                (bool succeeded, int64_t duration_us, const std::string &error_message)
+                {
+                    done(succeeded, failed_us + duration_us, error_message);
+                });
 }
 
-static void mount_all_pending_volumes(Devices::Device &dev,
-                                      const Automounter::FSMountOptions &mount_options)
+void Automounter::Core::mount_all_pending_volumes(Devices::Device &dev)
 {
     for(const auto &volinfo : dev)
     {
@@ -241,7 +479,7 @@ static void mount_all_pending_volumes(Devices::Device &dev,
             continue;
 
         if(volinfo.second->get_state() == Devices::Volume::PENDING)
-            try_mount_volume(*volinfo.second, mount_options);
+            try_mount_volume(*volinfo.second);
     }
 }
 
@@ -249,7 +487,7 @@ void Automounter::Core::handle_new_device(const char *device_path)
 {
     msg_log_assert(device_path != nullptr);
 
-    if(!is_device_name_acceptable(device_path, true))
+    if(!is_device_name_acceptable(device_path, device_prefixes_, true))
     {
         msg_vinfo(MESSAGE_LEVEL_DIAG,
                   "Rejected device (bad name): \"%s\"", device_path);
@@ -258,6 +496,7 @@ void Automounter::Core::handle_new_device(const char *device_path)
 
     msg_info("New device: \"%s\"", device_path);
 
+    Devices::PropertiesCacheScope properties_cache;
     Devices::Volume *vol;
     bool have_probed_dev;
     auto dev = devman_.new_entry(device_path, vol, have_probed_dev);
@@ -285,7 +524,7 @@ void Automounter::Core::handle_new_device(const char *device_path)
         return;
 
       case Devices::Device::PROBED:
-        apply_device_filter(*dev);
+        apply_device_filter(*dev, device_prefixes_);
 
         if(dev->get_state() != Devices::Device::OK)
             return;
@@ -301,16 +540,22 @@ void Automounter::Core::handle_new_device(const char *device_path)
 
     if(have_probed_dev)
     {
-        std::ostringstream os;
-        os << working_directory_ << '/' << dev->get_id();
-
-        if(dev->mk_working_directory(os.str()))
-            announce_new_device(*dev);
+        if(dev->mk_working_directory(mk_numbered_path(working_directory_, dev->get_id())))
+            announce_new_device(*dev, changes_);
+        else
+        {
+            /* device is visible in GetAll, but has not been announced */
+            changes_.invalidate();
+        }
 
-        mount_all_pending_volumes(*dev, mount_options_);
+        mount_all_pending_volumes(*dev);
     }
     else if(vol != nullptr)
-        try_mount_volume(*vol, mount_options_);
+        try_mount_volume(*vol);
+
+    dbus_changes_signal_notify(*this);
+
+    shm_snapshot_update(*this);
 }
 
 void Automounter::Core::handle_removed_device(const char *device_path)
@@ -320,22 +565,51 @@ void Automounter::Core::handle_removed_device(const char *device_path)
     msg_info("Removed device: \"%s\"", device_path);
 
     devman_.remove_entry(device_path,
-        [] (const Devices::Device &device)
+        [this] (const Devices::Device &device)
         {
+            changes_.append(ChangeLog::Kind::DEVICE_REMOVED, device.get_id());
+            dbus_objects_remove_device(device);
+
             if(device.get_working_directory().exists(FailIf::NOT_FOUND))
-                tdbus_moun_ta_emit_device_removed(dbus_get_mounta_iface(),
-                                                device.get_id(),
-                                                device.get_device_uuid().c_str(),
-                                                device.get_working_directory().str().c_str());
+            {
+                if(dbus_is_ready())
+                {
+                    tdbus_moun_ta_emit_device_removed(dbus_get_mounta_iface(),
+                                                      device.get_id(),
+                                                      device.get_device_uuid().c_str(),
+                                                      device.get_working_directory().str().c_str());
+                    tdbus_moun_ta2_emit_device_removed(dbus_get_mounta2_iface(),
+                                                       device.get_id(),
+                                                       device.get_device_uuid().c_str(),
+                                                       device.get_working_directory().str().c_str());
+                }
+
+                event_socket_device_removed(device, changes_.get_generation());
+            }
         },
-        [] (const Devices::Device &device)
+        [this] (const Devices::Device &device)
         {
             if(device.get_working_directory().exists(FailIf::NOT_FOUND))
-                tdbus_moun_ta_emit_device_will_be_removed(dbus_get_mounta_iface(),
-                                                          device.get_id(),
-                                                          device.get_device_uuid().c_str(),
-                                                          device.get_working_directory().str().c_str());
+            {
+                if(dbus_is_ready())
+                {
+                    tdbus_moun_ta_emit_device_will_be_removed(dbus_get_mounta_iface(),
+                                                              device.get_id(),
+                                                              device.get_device_uuid().c_str(),
+                                                              device.get_working_directory().str().c_str());
+                    tdbus_moun_ta2_emit_device_will_be_removed(dbus_get_mounta2_iface(),
+                                                               device.get_id(),
+                                                               device.get_device_uuid().c_str(),
+                                                               device.get_working_directory().str().c_str());
+                }
+
+                event_socket_device_will_be_removed(device, changes_.get_generation());
+            }
         });
+
+    dbus_changes_signal_notify(*this);
+
+    shm_snapshot_update(*this);
 }
 
 void Automounter::Core::handle_new_unmanaged_mountpoint(const char *mountpoint_path)
@@ -346,6 +620,7 @@ void Automounter::Core::handle_new_unmanaged_mountpoint(const char *mountpoint_p
     static const struct timespec small_delay = {0, 500L * 1000L * 1000L};
     nanosleep(&small_delay, nullptr);
 
+    Devices::PropertiesCacheScope properties_cache;
     Devices::Volume *vol;
     auto dev = devman_.new_entry_by_mountpoint(mountpoint_path, vol);
 
@@ -363,7 +638,7 @@ void Automounter::Core::handle_new_unmanaged_mountpoint(const char *mountpoint_p
         return;
 
       case Devices::Device::PROBED:
-        apply_device_filter(*dev);
+        apply_device_filter(*dev, device_prefixes_);
 
         if(dev->get_state() != Devices::Device::OK)
             return;
@@ -372,8 +647,10 @@ void Automounter::Core::handle_new_unmanaged_mountpoint(const char *mountpoint_p
 
       case Devices::Device::OK:
         dev->set_mountpoint_directory(mountpoint_path);
-        announce_new_device(*dev);
-        try_mount_volume(*vol, mount_options_);
+        announce_new_device(*dev, changes_);
+        try_mount_volume(*vol);
+        dbus_changes_signal_notify(*this);
+        shm_snapshot_update(*this);
         break;
     }
 }
@@ -408,12 +685,487 @@ static int remove_mountpoint_the_hard_way(const char *path,
     return 0;
 }
 
+static void announce_ready()
+{
+    tdbus_moun_ta2_emit_initial_scan_complete(dbus_get_mounta2_iface());
+    Automounter::notify_service_manager("READY=1\nSTATUS=Initial scan complete");
+}
+
+void Automounter::Core::announce_current_state() const
+{
+    for(const auto &it : devman_)
+    {
+        const auto &device(*it.second);
+
+        if(device.get_state() != Devices::Device::OK ||
+           !device.get_working_directory().exists(FailIf::NOT_FOUND))
+            continue;
+
+        emit_new_device(device);
+
+        for(const auto &volume_iter : device)
+        {
+            const auto *volume = volume_iter.second.get();
+
+            if(volume != nullptr && volume->get_state() == Devices::Volume::MOUNTED)
+                emit_new_volume(*volume);
+        }
+    }
+
+    /* batched signal covers everything since generation 0 */
+    dbus_changes_signal_notify(*this);
+
+    if(initial_scan_complete_)
+        announce_ready();
+}
+
+void Automounter::Core::set_initial_scan_complete()
+{
+    if(initial_scan_complete_)
+        return;
+
+    initial_scan_done_ = true;
+
+    /* called again when the last mount has finished */
+    if(running_mounts_ > 0 || !mount_queue_.empty())
+        return;
+
+    msg_info("Initial scan complete, %zu devices",
+             devman_.get_number_of_devices());
+
+    initial_scan_complete_ = true;
+    tdbus_moun_ta2_set_initial_scan_complete(dbus_get_mounta2_iface(), TRUE);
+
+    if(dbus_is_ready())
+        announce_ready();
+}
+
+/*!
+ * Whether or not volumes of the device are mounted by someone else.
+ */
+static bool is_just_watching(const Devices::Device &dev)
+{
+    return !dev.get_working_directory().exists(Automounter::FailIf::JUST_WATCHING);
+}
+
+Devices::Volume *Automounter::Core::find_volume(Devices::ID::value_type device_id,
+                                                int volume_index) const
+{
+    const auto *dev = devman_.get_device_by_id(device_id);
+
+    if(dev == nullptr || dev->get_state() != Devices::Device::OK)
+        return nullptr;
+
+    return dev->lookup_volume_by_index(volume_index);
+}
+
+void Automounter::Core::mount_volume(Devices::ID::value_type device_id,
+                                     int volume_index, OperationDoneFn &&done)
+{
+    const gint64 started_us = g_get_monotonic_time();
+    OperationResult result;
+    auto *vol = find_volume(device_id, volume_index);
+
+    if(vol == nullptr)
+    {
+        result.fail(OperationResult::Error::NO_SUCH_OBJECT, "No such volume");
+        done(result);
+        return;
+    }
+
+    if(is_just_watching(*vol->get_device()))
+    {
+        result.fail(OperationResult::Error::NOT_SUPPORTED,
+                    "Volume is not managed by MounTA");
+        done(result);
+        return;
+    }
+
+    switch(vol->get_state())
+    {
+      case Devices::Volume::PENDING:
+        apply_volume_filter(*vol, mount_options_);
+
+        if(vol->get_state() == Devices::Volume::PENDING)
+            break;
+
+        /* fall-through */
+
+      case Devices::Volume::REJECTED:
+      case Devices::Volume::REMOVED:
+        result.fail(OperationResult::Error::NOT_SUPPORTED,
+                    "Volume cannot be mounted");
+        done(result);
+        return;
+
+      case Devices::Volume::UNMOUNTED:
+      case Devices::Volume::UNUSABLE:
+        break;
+
+      case Devices::Volume::MOUNTED:
+        /* nothing to do */
+        done(result);
+        return;
+
+      case Devices::Volume::MOUNTING:
+      case Devices::Volume::UNMOUNTING:
+        result.fail(OperationResult::Error::BUSY, "Volume is busy");
+        done(result);
+        return;
+    }
+
+    std::string command;
+
+    if(!vol->begin_mount(mount_options_, select_driver(*vol, nullptr), command))
+    {
+        msg_error(0, LOG_ERR, "Failed mounting device %s",
+                  vol->get_device_name().c_str());
+        result.fail(OperationResult::Error::FAILED, "Failed creating mountpoint");
+        done(result);
+        return;
+    }
+
+    result.add_stage("prepare", g_get_monotonic_time() - started_us);
+
+    const std::string devname(vol->get_device_name());
+    const std::string mountpoint(vol->get_mountpoint_name());
+
+    if(!start_mount(*vol, command,
+            [this, device_id, volume_index, devname, mountpoint, started_us,
+             result, done]
+            (bool succeeded, int64_t duration_us,
+             const std::string &error_message) mutable
+            {
+                result.add_stage("mount", duration_us);
+                finish_mount_volume(device_id, volume_index, devname,
+                                    mountpoint, succeeded, error_message,
+                                    result);
+                result.add_stage("total", g_get_monotonic_time() - started_us);
+                done(result);
+            }))
+    {
+        vol->finish_mount(false);
+        result.fail(OperationResult::Error::FAILED, "Failed starting mount");
+        done(result);
+    }
+}
+
+void Automounter::Core::finish_mount_volume(Devices::ID::value_type device_id,
+                                            int volume_index,
+                                            const std::string &devname,
+                                            const std::string &mountpoint,
+                                            bool succeeded,
+                                            const std::string &error_message,
+                                            OperationResult &result)
+{
+    auto *vol = find_volume(device_id, volume_index);
+
+    if(vol == nullptr || vol->get_state() != Devices::Volume::MOUNTING ||
+       vol->get_device_name() != devname)
+    {
+        if(succeeded)
+        {
+            /* device has been removed while mounting, clean up behind it */
+            Mountpoint mp(tools_, std::string(mountpoint));
+            mp.probe();
+        }
+
+        result.fail(OperationResult::Error::FAILED,
+                    "Volume removed while mounting");
+        return;
+    }
+
+    vol->finish_mount(succeeded);
+
+    if(!succeeded)
+    {
+        msg_error(0, LOG_ERR, "Failed mounting device %s", devname.c_str());
+        result.fail(OperationResult::Error::FAILED,
+                    error_message.empty()
+                    ? "Failed mounting volume" : error_message.c_str());
+        return;
+    }
+
+    if(vol->get_fs_driver() != nullptr)
+        msg_info("Mounted %s to %s using driver %s (USB port %s)",
+                 devname.c_str(), vol->get_mountpoint_name().c_str(),
+                 vol->get_fs_driver()->name,
+                 vol->get_device()->get_usb_port().c_str());
+    else
+        msg_info("Mounted %s to %s (USB port %s)",
+                 devname.c_str(), vol->get_mountpoint_name().c_str(),
+                 vol->get_device()->get_usb_port().c_str());
+
+    announce_new_volume(*vol, changes_);
+    dbus_changes_signal_notify(*this);
+    shm_snapshot_update(*this);
+}
+
+void Automounter::Core::unmount_volume(Devices::ID::value_type device_id,
+                                       int volume_index, OperationDoneFn &&done)
+{
+    const gint64 started_us = g_get_monotonic_time();
+    OperationResult result;
+    auto *vol = find_volume(device_id, volume_index);
+
+    if(vol == nullptr)
+    {
+        result.fail(OperationResult::Error::NO_SUCH_OBJECT, "No such volume");
+        done(result);
+        return;
+    }
+
+    if(is_just_watching(*vol->get_device()))
+    {
+        result.fail(OperationResult::Error::NOT_SUPPORTED,
+                    "Volume is not managed by MounTA");
+        done(result);
+        return;
+    }
+
+    switch(vol->get_state())
+    {
+      case Devices::Volume::MOUNTED:
+        break;
+
+      case Devices::Volume::PENDING:
+      case Devices::Volume::UNUSABLE:
+      case Devices::Volume::REJECTED:
+      case Devices::Volume::REMOVED:
+      case Devices::Volume::UNMOUNTED:
+        /* nothing to do */
+        done(result);
+        return;
+
+      case Devices::Volume::MOUNTING:
+      case Devices::Volume::UNMOUNTING:
+        result.fail(OperationResult::Error::BUSY, "Volume is busy");
+        done(result);
+        return;
+    }
+
+    std::string command;
+
+    if(!vol->begin_unmount(command))
+    {
+        result.fail(OperationResult::Error::NOT_SUPPORTED,
+                    "Volume is not mounted by MounTA");
+        done(result);
+        return;
+    }
+
+    const std::string devname(vol->get_device_name());
+
+    if(!run_command_async(command,
+            [this, device_id, volume_index, devname, started_us, result, done]
+            (bool succeeded, int64_t duration_us) mutable
+            {
+                result.add_stage("unmount", duration_us);
+                finish_unmount_volume(device_id, volume_index, devname,
+                                      succeeded, result);
+                result.add_stage("total", g_get_monotonic_time() - started_us);
+                done(result);
+            }))
+    {
+        vol->finish_unmount(false);
+        result.fail(OperationResult::Error::FAILED, "Failed running unmount tool");
+        done(result);
+    }
+}
+
+void Automounter::Core::finish_unmount_volume(Devices::ID::value_type device_id,
+                                              int volume_index,
+                                              const std::string &devname,
+                                              bool succeeded,
+                                              OperationResult &result)
+{
+    auto *vol = find_volume(device_id, volume_index);
+
+    if(vol == nullptr || vol->get_state() != Devices::Volume::UNMOUNTING ||
+       vol->get_device_name() != devname)
+    {
+        /* device has been removed while unmounting, so the volume is gone
+         * anyway */
+        return;
+    }
+
+    if(!succeeded)
+    {
+        vol->finish_unmount(false);
+        msg_error(0, LOG_ERR, "Failed unmounting device %s", devname.c_str());
+        result.fail(OperationResult::Error::FAILED, "Failed unmounting volume");
+        return;
+    }
+
+    msg_info("Unmounted %s from %s",
+             devname.c_str(), vol->get_mountpoint_name().c_str());
+
+    announce_unmounted_volume(*vol, changes_);
+    vol->finish_unmount(true);
+    dbus_changes_signal_notify(*this);
+    shm_snapshot_update(*this);
+}
+
+/*!
+ * State of an eject operation while its volumes are being unmounted.
+ */
+struct EjectOperation
+{
+    Automounter::OperationResult result_;
+    const Automounter::OperationDoneFn done_;
+    const std::string usb_port_chain_;
+    const gint64 started_us_;
+    gint64 unmount_started_us_;
+    size_t pending_unmounts_;
+
+    explicit EjectOperation(Automounter::OperationDoneFn &&done,
+                            const std::string &usb_port_chain,
+                            gint64 started_us):
+        done_(std::move(done)),
+        usb_port_chain_(usb_port_chain),
+        started_us_(started_us),
+        unmount_started_us_(g_get_monotonic_time()),
+        pending_unmounts_(0)
+    {}
+
+    void finish()
+    {
+        result_.add_stage("total", g_get_monotonic_time() - started_us_);
+        done_(result_);
+    }
+};
+
+/*!
+ * Switch off the hub port the ejected device is plugged into.
+ *
+ * The \c remove attribute of the USB device would only disconnect it
+ * logically, leaving the device powered and ready for being enumerated
+ * again. Writing to the port's \c disable attribute requires root, so it is
+ * done by the configurable power-off tool, usually \c tee run by \c sudo.
+ */
+static void eject_power_off(std::shared_ptr<EjectOperation> op,
+                            const Automounter::ExternalTools &tools)
+{
+    op->result_.add_stage("unmount",
+                          g_get_monotonic_time() - op->unmount_started_us_);
+
+    /* the path ends up in a shell command, but it only contains characters
+     * of a valid port chain */
+    const std::string path(Devices::mk_usb_port_disable_path(op->usb_port_chain_));
+
+    if(op->result_.error_ != Automounter::OperationResult::Error::NONE ||
+       path.empty())
+    {
+        op->finish();
+        return;
+    }
+
+    std::string command("echo 1 | ");
+    command.append(tools.power_off_.executable_).push_back(' ');
+
+    if(!tools.power_off_.options_.empty())
+        command.append(tools.power_off_.options_).push_back(' ');
+
+    command.append(path).append(" >/dev/null");
+
+    if(!Automounter::run_command_async(command,
+            [op] (bool succeeded, int64_t duration_us)
+            {
+                op->result_.add_stage("power_off", duration_us);
+                op->result_.powered_off_ = succeeded;
+                op->finish();
+            }))
+        op->finish();
+}
+
+void Automounter::Core::eject_device(Devices::ID::value_type device_id,
+                                     OperationDoneFn &&done)
+{
+    const gint64 started_us = g_get_monotonic_time();
+    const auto *dev = devman_.get_device_by_id(device_id);
+
+    if(dev == nullptr || dev->get_state() != Devices::Device::OK)
+    {
+        OperationResult result;
+        result.fail(OperationResult::Error::NO_SUCH_OBJECT, "No such device");
+        done(result);
+        return;
+    }
+
+    if(is_just_watching(*dev))
+    {
+        OperationResult result;
+        result.fail(OperationResult::Error::NOT_SUPPORTED,
+                    "Device is not managed by MounTA");
+        done(result);
+        return;
+    }
+
+    for(const auto &volume_iter : *dev)
+    {
+        const auto *volume = volume_iter.second.get();
+
+        if(volume != nullptr &&
+           (volume->get_state() == Devices::Volume::MOUNTING ||
+            volume->get_state() == Devices::Volume::UNMOUNTING))
+        {
+            OperationResult result;
+            result.fail(OperationResult::Error::BUSY, "Device is busy");
+            done(result);
+            return;
+        }
+    }
+
+    auto op(std::make_shared<EjectOperation>(std::move(done),
+                                             dev->get_usb_port_chain(),
+                                             started_us));
+
+    for(const auto &volume_iter : *dev)
+    {
+        auto *volume = volume_iter.second.get();
+        std::string command;
+
+        if(volume == nullptr ||
+           volume->get_state() != Devices::Volume::MOUNTED ||
+           !volume->begin_unmount(command))
+            continue;
+
+        const int volume_index = volume->get_index();
+        const std::string devname(volume->get_device_name());
+
+        if(run_command_async(command,
+                [this, op, device_id, volume_index, devname]
+                (bool succeeded, int64_t duration_us)
+                {
+                    finish_unmount_volume(device_id, volume_index, devname,
+                                          succeeded, op->result_);
+
+                    if(--op->pending_unmounts_ == 0)
+                        eject_power_off(op, tools_);
+                }))
+            ++op->pending_unmounts_;
+        else
+        {
+            volume->finish_unmount(false);
+            op->result_.fail(OperationResult::Error::FAILED,
+                             "Failed running unmount tool");
+        }
+    }
+
+    if(op->pending_unmounts_ == 0)
+        eject_power_off(op, tools_);
+}
+
 void Automounter::Core::shutdown()
 {
     /* Attempt to clean up the nice and polite way. */
+    mount_queue_.clear();
+
     for(auto it = devman_.begin(); it != devman_.end(); ++it)
         devman_.remove_entry(it, nullptr);
 
+    changes_.invalidate();
+
     /* Remove residual mountpoints. There shouldn't be any, but we want to be
      * sure to leave the system in the most sane state possible. */
     os_foreach_in_path(working_directory_.c_str(),
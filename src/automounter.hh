@@ -23,52 +23,72 @@
 #define AUTOMOUNTER_HH
 
 #include <string>
-#include <map>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <cstdint>
 
 #include "device_manager.hh"
+#include "fsmount_options.hh"
+#include "change_log.hh"
 
 namespace Automounter
 {
 
 class ExternalTools;
 
-class FSMountOptions
+/*!
+ * Outcome of a mount, unmount, or eject operation requested by a client.
+ */
+struct OperationResult
 {
-  private:
-    const std::map<const std::string, const char *const> options_;
+    enum class Error
+    {
+        NONE,
+        NO_SUCH_OBJECT, /*!< No such device or volume. */
+        BUSY,           /*!< Another operation is in progress. */
+        NOT_SUPPORTED,  /*!< Operation not possible for the object. */
+        FAILED,         /*!< External tool has failed. */
+    };
 
-  public:
-    FSMountOptions(const FSMountOptions &) = delete;
-    FSMountOptions &operator=(const FSMountOptions &) = delete;
+    Error error_;
+    std::string message_;
 
     /*!
-     * Ctor for #FSMountOptions.
-     *
-     * \param options
-     *     A map that stores a pointer to a plain C string of extra mount
-     *     options per file system. To express that a file system is supported,
-     *     but no extra options are required, the file system should be
-     *     explicitly mapped to \c nullptr.
-     */
-    explicit FSMountOptions(std::map<const std::string, const char *const> &&options):
-        options_(options)
-    {}
+     * Name and run time in microseconds of each stage, in order.
+     */
+    std::vector<std::pair<std::string, int64_t>> stages_;
 
     /*!
-     * Get mount options specific to given file system.
-     *
-     * \param fstype
-     *     Name of the file system as it is called by the Linux kernel and as
-     *     reported by the \c blkid tool.
-     *
-     * \returns
-     *     A string that is safe to add to the \c mount command, guaranteed to
-     *     be non-NULL. In case there are no specific options, this function
-     *     returns the empty string.
+     * Whether or not the USB port has been switched off by an eject.
      */
-    const char *get_options(const std::string &fstype) const;
+    bool powered_off_;
+
+    explicit OperationResult():
+        error_(Error::NONE),
+        powered_off_(false)
+    {}
+
+    void add_stage(const char *name, int64_t duration_us)
+    {
+        stages_.emplace_back(name, duration_us);
+    }
+
+    void fail(Error error, const char *message)
+    {
+        if(error_ != Error::NONE)
+            return;
+
+        error_ = error;
+        message_ = message;
+    }
 };
 
+/*!
+ * Function called when an operation requested by a client is finished.
+ */
+using OperationDoneFn = std::function<void(const OperationResult &)>;
+
 class Core
 {
   private:
@@ -77,6 +97,47 @@ class Core
     Devices::AllDevices devman_;
     const ExternalTools &tools_;
 
+    /*!
+     * Changes of the set of devices and volumes visible on D-Bus.
+     */
+    ChangeLog changes_;
+
+    /*!
+     * Whether or not the startup scan and its mounts have completed.
+     */
+    bool initial_scan_complete_;
+
+    /*!
+     * Whether or not the startup scan has completed, but its mounts may not.
+     */
+    bool initial_scan_done_;
+
+    /*!
+     * Volumes to be mounted automatically, by device ID and volume index.
+     */
+    std::deque<std::pair<Devices::ID::value_type, int>> mount_queue_;
+
+    /*!
+     * Number of mount tools currently running for volumes taken from
+     * #Automounter::Core::mount_queue_.
+     */
+    unsigned int running_mounts_;
+
+    /*!
+     * Upper limit for #Automounter::Core::running_mounts_.
+     */
+    const unsigned int max_parallel_mounts_;
+
+    /*!
+     * Mount using the kernel mount API instead of the mount tool.
+     */
+    const bool use_native_mount_;
+
+    /*!
+     * Names of devices in \c /dev/disk/by-id/ must start with one of these.
+     */
+    std::vector<std::string> device_prefixes_;
+
   public:
     Core(const Core &) = delete;
     Core &operator=(const Core &) = delete;
@@ -84,19 +145,138 @@ class Core
 
     explicit Core(const char *working_directory, const ExternalTools &tools,
                   const FSMountOptions &mount_options,
-                  const std::string& symlink_directory):
+                  const std::string& symlink_directory,
+                  unsigned int max_parallel_mounts, bool use_native_mount):
         working_directory_(working_directory),
         mount_options_(mount_options),
         devman_(tools, symlink_directory),
-        tools_(tools)
+        tools_(tools),
+        initial_scan_complete_(false),
+        initial_scan_done_(false),
+        running_mounts_(0),
+        max_parallel_mounts_(max_parallel_mounts > 0 ? max_parallel_mounts : 1),
+        use_native_mount_(use_native_mount),
+        device_prefixes_{"usb-", "ata-"}
     {}
 
+    /*!
+     * Register existing label symlinks, remove stale ones.
+     *
+     * To be called once before the first device is handled.
+     */
+    bool seed_label_symlinks() { return devman_.seed_label_symlinks(); }
+
+    /*!
+     * Change accepted device name prefixes.
+     *
+     * Devices which have been accepted or rejected before are left alone,
+     * the prefixes apply to devices plugged in from now on.
+     */
+    void set_device_prefixes(std::vector<std::string> &&prefixes)
+    {
+        device_prefixes_ = std::move(prefixes);
+    }
+
+    /*!
+     * Move label symlinks to another directory.
+     *
+     * See #Devices::AllDevices::set_symlink_directory().
+     */
+    bool set_symlink_directory(const std::string &symlink_directory)
+    {
+        return devman_.set_symlink_directory(symlink_directory);
+    }
+
     void handle_new_device(const char *device_path);
     void handle_removed_device(const char *device_path);
     void handle_new_unmanaged_mountpoint(const char *mountpoint_path);
     void handle_removed_unmanaged_mountpoint(const char *mountpoint_path);
     void shutdown();
 
+    /*!
+     * Emit D-Bus signals for all devices and mounted volumes.
+     *
+     * Devices are probed and mounted while the D-Bus name is still being
+     * acquired. Nothing is announced on D-Bus during that time; instead, the
+     * resulting state is announced by this function once the bus is ready.
+     */
+    void announce_current_state() const;
+
+    /*!
+     * To be called when the startup scan has been completed.
+     *
+     * Sets the \c InitialScanComplete D-Bus property and emits the signal of
+     * the same name as soon as all volumes found by the scan have been
+     * mounted. The service manager is notified that we are ready as soon as
+     * the scan is complete and the D-Bus name has been acquired, whichever
+     * happens last.
+     */
+    void set_initial_scan_complete();
+
+    bool is_initial_scan_complete() const { return initial_scan_complete_; }
+
+    /*!
+     * Change generation of the exported state.
+     *
+     * Answers derived from the devices and volumes may be cached as long as
+     * this value remains the same.
+     */
+    uint64_t get_generation() const { return changes_.get_generation(); }
+
+    /*!
+     * Mount volume without blocking the main loop.
+     *
+     * Volumes may be mounted again after they have been unmounted by
+     * #Automounter::Core::unmount_volume() or after a failed attempt. The
+     * callback is called exactly once, either right away in case of errors
+     * or when the mount tool has finished.
+     *
+     * \param device_id
+     *     ID of the device containing the volume.
+     *
+     * \param volume_index
+     *     Index of the volume on its device, -1 for whole-disk file systems.
+     *
+     * \param done
+     *     Called with the result and the run time of the stages
+     *     \c "prepare" (mountpoint creation), \c "mount", and \c "total".
+     */
+    void mount_volume(Devices::ID::value_type device_id, int volume_index,
+                      OperationDoneFn &&done);
+
+    /*!
+     * Unmount volume without blocking the main loop.
+     *
+     * The volume stays known, but is not visible on D-Bus anymore. Stages
+     * are \c "unmount" and \c "total".
+     */
+    void unmount_volume(Devices::ID::value_type device_id, int volume_index,
+                        OperationDoneFn &&done);
+
+    /*!
+     * Unmount all volumes of a device, then switch off its USB port.
+     *
+     * The volumes are unmounted concurrently. The USB port is switched off
+     * only if all volumes have been unmounted, and if the port is known.
+     * Stages are \c "unmount" (all volumes), \c "power_off", and \c "total".
+     * Removal of the device is reported as usual once the kernel has removed
+     * it.
+     */
+    void eject_device(Devices::ID::value_type device_id, OperationDoneFn &&done);
+
+    const ChangeLog &get_changes() const { return changes_; }
+
+    /*!
+     * Find device by its ID.
+     *
+     * \returns
+     *     The device, or \c nullptr if there is no such device.
+     */
+    const Devices::Device *find_device(Devices::ID::value_type id) const
+    {
+        return devman_.get_device_by_id(id);
+    }
+
     class const_iterator
     {
       private:
@@ -126,6 +306,30 @@ class Core
 
     const_iterator begin() const { return const_iterator(devman_.begin()); }
     const_iterator end() const   { return const_iterator(devman_.end()); }
+
+  private:
+    void try_mount_volume(Devices::Volume &vol);
+    void mount_all_pending_volumes(Devices::Device &dev);
+    void start_queued_mounts();
+    const FSDriver *select_driver(const Devices::Volume &vol,
+                                  const FSDriver *previous) const;
+    bool start_mount(const Devices::Volume &vol, const std::string &command,
+                     std::function<void(bool, int64_t, const std::string &)> &&done);
+    bool retry_mount_with_next_driver(Devices::ID::value_type device_id,
+                                      int volume_index, const std::string &devname,
+                                      const FSDriver &failed_driver, int64_t failed_us,
+                                      const std::function<void(bool, int64_t, const std::string &)> &done);
+
+    Devices::Volume *find_volume(Devices::ID::value_type device_id,
+                                 int volume_index) const;
+    void finish_mount_volume(Devices::ID::value_type device_id,
+                             int volume_index, const std::string &devname,
+                             const std::string &mountpoint, bool succeeded,
+                             const std::string &error_message,
+                             OperationResult &result);
+    void finish_unmount_volume(Devices::ID::value_type device_id,
+                               int volume_index, const std::string &devname,
+                               bool succeeded, OperationResult &result);
 };
 
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+
+#include "change_log.hh"
+
+constexpr size_t Automounter::ChangeLog::MAX_CHANGES;
+
+void Automounter::ChangeLog::append(Kind kind, uint16_t device_id,
+                                    unsigned int volume_index)
+{
+    if(changes_.size() >= MAX_CHANGES)
+    {
+        truncated_generation_ = changes_.front().generation_;
+        changes_.pop_front();
+    }
+
+    changes_.push_back(Change{++generation_, kind, device_id, volume_index});
+}
+
+void Automounter::ChangeLog::invalidate()
+{
+    changes_.clear();
+    truncated_generation_ = ++generation_;
+}
+
+bool Automounter::ChangeLog::find_changes_since(
+        uint64_t generation, std::deque<Change>::const_iterator &first) const
+{
+    if(generation < truncated_generation_ || generation > generation_)
+        return false;
+
+    first = std::upper_bound(changes_.begin(), changes_.end(), generation,
+                             [] (uint64_t g, const Change &c)
+                             {
+                                 return g < c.generation_;
+                             });
+
+    return true;
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef CHANGE_LOG_HH
+#define CHANGE_LOG_HH
+
+#include <deque>
+#include <cstdint>
+#include <climits>
+
+namespace Automounter
+{
+
+/*!
+ * Bounded record of changes to the devices and volumes visible on D-Bus.
+ *
+ * Each change is tagged with a generation number, which is incremented for
+ * each recorded change. Clients remember the generation of the state they
+ * have seen last and may ask for the changes made since then. If the log has
+ * been truncated in the meantime, they must fetch the whole state again.
+ */
+class ChangeLog
+{
+  public:
+    /*!
+     * Kind of change. The values are part of the D-Bus API.
+     */
+    enum class Kind: uint8_t
+    {
+        DEVICE_ADDED = 1,
+        DEVICE_REMOVED = 2,
+        VOLUME_ADDED = 3,
+        VOLUME_REMOVED = 4,
+    };
+
+    struct Change
+    {
+        uint64_t generation_;
+        Kind kind_;
+        uint16_t device_id_;
+
+        /*! Index of the volume, \c UINT_MAX for changes of whole devices. */
+        unsigned int volume_index_;
+    };
+
+    static constexpr size_t MAX_CHANGES = 256;
+
+  private:
+    std::deque<Change> changes_;
+    uint64_t generation_;
+
+    /*! Changes up to this generation are not available anymore. */
+    uint64_t truncated_generation_;
+
+  public:
+    ChangeLog(const ChangeLog &) = delete;
+    ChangeLog(ChangeLog &&) = default;
+    ChangeLog &operator=(const ChangeLog &) = delete;
+    ChangeLog &operator=(ChangeLog &&) = default;
+
+    explicit ChangeLog():
+        generation_(0),
+        truncated_generation_(0)
+    {}
+
+    /*!
+     * Record change, increment generation.
+     */
+    void append(Kind kind, uint16_t device_id,
+                unsigned int volume_index = UINT_MAX);
+
+    /*!
+     * Increment generation for a change without a record of its own.
+     *
+     * Clients asking for changes across this generation are told to resync.
+     */
+    void invalidate();
+
+    uint64_t get_generation() const { return generation_; }
+
+    /*!
+     * Find changes made after given generation.
+     *
+     * \param generation
+     *     Generation of the state known by the client.
+     *
+     * \param[out] first
+     *     First change made after \p generation. Only valid if this function
+     *     returns true.
+     *
+     * \returns
+     *     True if all changes since \p generation are in the log, false if
+     *     the client must fetch the whole state.
+     */
+    bool find_changes_since(uint64_t generation,
+                            std::deque<Change>::const_iterator &first) const;
+
+    std::deque<Change>::const_iterator end() const { return changes_.end(); }
+};
+
+}
+
+#endif /* !CHANGE_LOG_HH */
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+#include <vector>
+#include <climits>
+
+#include "dbus_changes.hh"
+#include "dbus_properties.hh"
+#include "dbus_iface_deep.h"
+#include "automounter.hh"
+
+static const Devices::Volume *find_mounted_volume(const Devices::Device &device,
+                                                  unsigned int index)
+{
+    for(const auto &volume_iter : device)
+    {
+        const auto *volume = volume_iter.second.get();
+
+        if(volume != nullptr &&
+           volume->get_state() == Devices::Volume::MOUNTED &&
+           (volume->get_index() >= 0 ? unsigned(volume->get_index()) : UINT_MAX) == index)
+            return volume;
+    }
+
+    return nullptr;
+}
+
+bool dbus_mk_changes_since(const Automounter::Core &am, uint64_t generation,
+                           GVariant *&changes, GVariant *&devices,
+                           GVariant *&volumes)
+{
+    GVariantBuilder changes_builder;
+    GVariantBuilder devices_builder;
+    GVariantBuilder volumes_builder;
+    g_variant_builder_init(&changes_builder, G_VARIANT_TYPE("a(tyqu)"));
+    g_variant_builder_init(&devices_builder, G_VARIANT_TYPE("a(qssssa{sv})"));
+    g_variant_builder_init(&volumes_builder, G_VARIANT_TYPE("a(ussqsa{sv})"));
+
+    const auto &log(am.get_changes());
+    std::deque<Automounter::ChangeLog::Change>::const_iterator it;
+    const bool have_changes = log.find_changes_since(generation, it);
+
+    /* devices and volumes added since the given generation, details are sent
+     * along for those which still exist */
+    std::vector<Devices::ID::value_type> added_devices;
+    std::vector<std::pair<Devices::ID::value_type, unsigned int>> added_volumes;
+
+    if(have_changes)
+    {
+        for(/* nothing */; it != log.end(); ++it)
+        {
+            g_variant_builder_add(&changes_builder, "(tyqu)",
+                                  it->generation_, guchar(it->kind_),
+                                  it->device_id_, it->volume_index_);
+
+            const auto kind = it->kind_;
+
+            if(kind == Automounter::ChangeLog::Kind::DEVICE_ADDED &&
+               std::find(added_devices.begin(), added_devices.end(),
+                         it->device_id_) == added_devices.end())
+                added_devices.push_back(it->device_id_);
+            else if(kind == Automounter::ChangeLog::Kind::VOLUME_ADDED)
+            {
+                const auto v(std::make_pair(it->device_id_, it->volume_index_));
+
+                if(std::find(added_volumes.begin(), added_volumes.end(), v) == added_volumes.end())
+                    added_volumes.push_back(v);
+            }
+        }
+    }
+
+    for(const auto id : added_devices)
+    {
+        const auto *device = am.find_device(id);
+
+        if(device != nullptr && device->get_state() == Devices::Device::OK)
+            dbus_add_device_details_tuple(devices_builder, *device);
+    }
+
+    for(const auto &v : added_volumes)
+    {
+        const auto *device = am.find_device(v.first);
+        const auto *volume = device != nullptr ? find_mounted_volume(*device, v.second) : nullptr;
+
+        if(volume != nullptr)
+            dbus_add_volume_details_tuple(volumes_builder, *volume);
+    }
+
+    changes = g_variant_builder_end(&changes_builder);
+    devices = g_variant_builder_end(&devices_builder);
+    volumes = g_variant_builder_end(&volumes_builder);
+
+    return have_changes;
+}
+
+struct ChangesSignalData
+{
+    bool is_enabled_;
+    unsigned int window_ms_;
+    guint source_id_;
+    const Automounter::Core *automounter_;
+
+    /*! Generation sent with the most recent \c Changes signal. */
+    uint64_t generation_;
+};
+
+static ChangesSignalData changes_signal_data;
+
+static gboolean emit_changes(gpointer user_data)
+{
+    auto &data(*static_cast<ChangesSignalData *>(user_data));
+    data.source_id_ = 0;
+
+    /* called again once the bus name has been acquired */
+    if(!dbus_is_ready())
+        return G_SOURCE_REMOVE;
+
+    const auto &am(*data.automounter_);
+    const uint64_t previous_generation = data.generation_;
+
+    if(am.get_generation() == previous_generation)
+        return G_SOURCE_REMOVE;
+
+    data.generation_ = am.get_generation();
+
+    GVariant *changes;
+    GVariant *devices;
+    GVariant *volumes;
+    const bool resync_required =
+        !dbus_mk_changes_since(am, previous_generation, changes, devices, volumes);
+
+    tdbus_moun_ta2_emit_changes(dbus_get_mounta2_iface(),
+                                data.generation_, resync_required,
+                                changes, devices, volumes);
+
+    return G_SOURCE_REMOVE;
+}
+
+void dbus_changes_signal_enable(unsigned int window_ms)
+{
+    changes_signal_data.is_enabled_ = true;
+    changes_signal_data.window_ms_ = window_ms;
+}
+
+void dbus_changes_signal_notify(const Automounter::Core &am)
+{
+    auto &data(changes_signal_data);
+
+    if(!data.is_enabled_ || data.source_id_ != 0 ||
+       am.get_generation() == data.generation_)
+        return;
+
+    data.automounter_ = &am;
+    data.source_id_ = data.window_ms_ > 0
+        ? g_timeout_add(data.window_ms_, emit_changes, &data)
+        : g_idle_add(emit_changes, &data);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef DBUS_CHANGES_HH
+#define DBUS_CHANGES_HH
+
+#include <glib.h>
+#include <cstdint>
+
+namespace Automounter { class Core; }
+
+/*!
+ * Build arrays of changes made since given generation.
+ *
+ * \param am
+ *     The automounter whose change log is to be used.
+ *
+ * \param generation
+ *     Generation of the state known by the client.
+ *
+ * \param[out] changes
+ *     Floating reference to array of \c (tyqu) tuples, one per change
+ *     (generation, kind, device ID, volume index).
+ *
+ * \param[out] devices, volumes
+ *     Floating references to arrays in the same format as sent by
+ *     \c de.tahifi.MounTA2.GetAll,
+ *     containing the devices and volumes added since \p generation which
+ *     still exist.
+ *
+ * \returns
+ *     True on success, false if the change log does not reach back to
+ *     \p generation. In the latter case, all arrays are empty and the
+ *     client must call GetAll.
+ */
+bool dbus_mk_changes_since(const Automounter::Core &am, uint64_t generation,
+                           GVariant *&changes, GVariant *&devices,
+                           GVariant *&volumes);
+
+/*!
+ * Enable the \c de.tahifi.MounTA2.Changes signal.
+ *
+ * The signal aggregates all changes made while handling one burst of events
+ * and carries the same data as a reply to GetChangesSince, for the
+ * generation of the previous \c Changes signal. Per-item signals are emitted
+ * regardless of this setting.
+ *
+ * \param window_ms
+ *     Time to wait for further changes after the first one, in milliseconds.
+ *     If 0, the signal is emitted as soon as the main loop becomes idle.
+ */
+void dbus_changes_signal_enable(unsigned int window_ms);
+
+/*!
+ * Schedule emission of the \c Changes signal, if enabled.
+ *
+ * To be called after handling an event. Nothing is emitted if the generation
+ * has not changed by the time the signal is due.
+ */
+void dbus_changes_signal_notify(const Automounter::Core &am);
+
+#endif /* !DBUS_CHANGES_HH */
@@ -23,57 +23,106 @@
 #include <config.h>
 #endif /* HAVE_CONFIG_H */
 
+#include <climits>
+
 #include "dbus_handlers.h"
 #include "automounter.hh"
+#include "dbus_properties.hh"
+#include "dbus_changes.hh"
+#include "dbus_wait.h"
 #include "messages.h"
 
-gboolean dbusmethod_get_all(tdbusMounTA *object,
-                            GDBusMethodInvocation *invocation,
-                            void *user_data)
+/*!
+ * Reply to GetAll, kept until the state of the automounter changes.
+ */
+class CachedGetAllReply
 {
-    static const char iface_name[] = "de.tahifi.MounTA";
+  private:
+    GVariant *reply_;
+    uint64_t generation_;
 
-    msg_info("%s method invocation from '%s': %s",
-             iface_name, g_dbus_method_invocation_get_sender(invocation),
-             g_dbus_method_invocation_get_method_name(invocation));
+  public:
+    CachedGetAllReply(const CachedGetAllReply &) = delete;
+    CachedGetAllReply &operator=(const CachedGetAllReply &) = delete;
+
+    explicit CachedGetAllReply():
+        reply_(nullptr),
+        generation_(0)
+    {}
+
+    ~CachedGetAllReply() { clear(); }
 
+    GVariant *get(uint64_t generation) const
+    {
+        return reply_ != nullptr && generation_ == generation ? reply_ : nullptr;
+    }
+
+    GVariant *set(GVariant *reply, uint64_t generation)
+    {
+        clear();
+        reply_ = g_variant_ref_sink(reply);
+        generation_ = generation;
+        return reply_;
+    }
+
+    void clear()
+    {
+        if(reply_ != nullptr)
+        {
+            g_variant_unref(reply_);
+            reply_ = nullptr;
+        }
+    }
+};
+
+/*!
+ * How to build a reply to GetAll for one version of the interface.
+ */
+struct GetAllFormat
+{
+    const char *const devices_type_;
+    const char *const volumes_type_;
+    const char *const reply_format_;
+    void (*const add_device_)(GVariantBuilder &, const Devices::Device &);
+    void (*const add_volume_)(GVariantBuilder &, const Devices::Volume &);
+};
+
+static const GetAllFormat get_all_format_v1
+{
+    "a(qssss)", "a(ussqs)", "(@a(qssss)@a(ussqs))",
+    dbus_add_device_tuple, dbus_add_volume_tuple,
+};
+
+static const GetAllFormat get_all_format_v2
+{
+    "a(qssssa{sv})", "a(ussqsa{sv})", "(@a(qssssa{sv})@a(ussqsa{sv}))",
+    dbus_add_device_details_tuple, dbus_add_volume_details_tuple,
+};
+
+static CachedGetAllReply cached_get_all_reply_v1;
+static CachedGetAllReply cached_get_all_reply_v2;
+
+static GVariant *mk_get_all_reply(const Automounter::Core &am,
+                                  const GetAllFormat &format)
+{
     GVariantBuilder devices_builder;
     GVariantBuilder volumes_builder;
-    g_variant_builder_init(&devices_builder, G_VARIANT_TYPE("a(qssss)"));
-    g_variant_builder_init(&volumes_builder, G_VARIANT_TYPE("a(ussqs)"));
-
-    auto am = static_cast<const Automounter::Core *>(user_data);
-    msg_log_assert(am != nullptr);
+    g_variant_builder_init(&devices_builder, G_VARIANT_TYPE(format.devices_type_));
+    g_variant_builder_init(&volumes_builder, G_VARIANT_TYPE(format.volumes_type_));
 
-    for(const auto &device : *am)
+    for(const auto &device : am)
     {
         if(device.get_state() != Devices::Device::OK)
             continue;
 
-        /* note: this duplicates #announce_new_device() */
-        g_variant_builder_add(&devices_builder,
-                              "(qssss)",
-                              device.get_id(),
-                              device.get_display_name().c_str(),
-                              device.get_device_uuid().c_str(),
-                              device.get_working_directory().str().c_str(),
-                              device.get_usb_port().c_str());
+        format.add_device_(devices_builder, device);
 
         for(const auto &volume_iter : device)
         {
             const auto &volume = *volume_iter.second;
 
-            if(volume.get_state() != Devices::Volume::MOUNTED)
-                continue;
-
-            /* note: this duplicates #announce_new_volume() */
-            g_variant_builder_add(&volumes_builder,
-                                  "(ussqs)",
-                                  volume.get_index() >= 0 ? volume.get_index() : UINT_MAX,
-                                  volume.get_label().c_str(),
-                                  volume.get_mountpoint_name().c_str(),
-                                  volume.get_device()->get_id(),
-                                  volume.get_volume_uuid().c_str());
+            if(volume.get_state() == Devices::Volume::MOUNTED)
+                format.add_volume_(volumes_builder, volume);
         }
     }
 
@@ -81,20 +130,248 @@ gboolean dbusmethod_get_all(tdbusMounTA *object,
     GVariant *const volumes = g_variant_builder_end(&volumes_builder);
 
     if(devices != nullptr && volumes != nullptr)
-        tdbus_moun_ta_complete_get_all(object, invocation, devices, volumes);
-    else
+        return g_variant_new(format.reply_format_, devices, volumes);
+
+    if(devices != nullptr)
+        g_variant_unref(devices);
+
+    if(volumes != nullptr)
+        g_variant_unref(volumes);
+
+    return nullptr;
+}
+
+static void return_get_all_reply(GDBusMethodInvocation *invocation,
+                                 const Automounter::Core &am,
+                                 CachedGetAllReply &cache,
+                                 const GetAllFormat &format)
+{
+    GVariant *reply = cache.get(am.get_generation());
+
+    if(reply == nullptr)
     {
-        if(devices != nullptr)
-            g_variant_unref(devices);
+        reply = mk_get_all_reply(am, format);
 
-        if(volumes != nullptr)
-            g_variant_unref(volumes);
+        if(reply != nullptr)
+            reply = cache.set(reply, am.get_generation());
+        else
+            cache.clear();
+    }
 
+    /* same as tdbus_moun_ta_complete_get_all(), but without packing the
+     * arrays into a new tuple on each call; the reply is not floating, so
+     * GDBus takes its own reference */
+    if(reply != nullptr)
+        g_dbus_method_invocation_return_value(invocation, reply);
+    else
         g_dbus_method_invocation_return_error(invocation,
                                               G_DBUS_ERROR, G_DBUS_ERROR_NO_MEMORY,
                                               "Failed building answer");
+}
+
+static void log_invocation(GDBusMethodInvocation *invocation)
+{
+    msg_info("%s method invocation from '%s': %s",
+             g_dbus_method_invocation_get_interface_name(invocation),
+             g_dbus_method_invocation_get_sender(invocation),
+             g_dbus_method_invocation_get_method_name(invocation));
+}
+
+gboolean dbusmethod_get_all(tdbusMounTA *object,
+                            GDBusMethodInvocation *invocation,
+                            void *user_data)
+{
+    log_invocation(invocation);
+
+    auto am = static_cast<const Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    return_get_all_reply(invocation, *am, cached_get_all_reply_v1,
+                         get_all_format_v1);
+
+    return TRUE;
+}
+
+gboolean dbusmethod_v2_get_all(tdbusMounTA2 *object,
+                               GDBusMethodInvocation *invocation,
+                               void *user_data)
+{
+    log_invocation(invocation);
+
+    auto am = static_cast<const Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    return_get_all_reply(invocation, *am, cached_get_all_reply_v2,
+                         get_all_format_v2);
+
+    return TRUE;
+}
+
+gboolean dbusmethod_get_changes_since(tdbusMounTA2 *object,
+                                      GDBusMethodInvocation *invocation,
+                                      guint64 generation, void *user_data)
+{
+    log_invocation(invocation);
+
+    auto am = static_cast<const Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    GVariant *changes;
+    GVariant *devices;
+    GVariant *volumes;
+    const bool resync_required =
+        !dbus_mk_changes_since(*am, generation, changes, devices, volumes);
+
+    tdbus_moun_ta2_complete_get_changes_since(object, invocation,
+                                              am->get_generation(), resync_required,
+                                              changes, devices, volumes);
+
+    return TRUE;
+}
+
+gboolean dbusmethod_wait_for_volume(tdbusMounTA2 *object,
+                                    GDBusMethodInvocation *invocation,
+                                    const gchar *uuid, guint timeout_ms,
+                                    void *user_data)
+{
+    log_invocation(invocation);
+
+    auto am = static_cast<const Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    dbus_wait_for_volume(*am, invocation, uuid, timeout_ms);
+
+    return TRUE;
+}
+
+/*!
+ * Map volume index from D-Bus to #Devices::Volume index.
+ *
+ * As in the \c NewVolume signal, \c UINT_MAX stands for volumes without
+ * partition number.
+ */
+static int to_volume_index(guint volume_index)
+{
+    if(volume_index == UINT_MAX)
+        return -1;
+
+    return volume_index <= INT_MAX ? int(volume_index) : INT_MIN;
+}
+
+static GVariant *mk_stages(const Automounter::OperationResult &result)
+{
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{st}"));
+
+    for(const auto &stage : result.stages_)
+        g_variant_builder_add(&builder, "{st}",
+                              stage.first.c_str(), guint64(stage.second));
+
+    return g_variant_builder_end(&builder);
+}
+
+/*!
+ * Fail invocation of \c Mount, \c Unmount, or \c Eject if the operation
+ * has failed.
+ */
+static bool return_operation_error(GDBusMethodInvocation *invocation,
+                                   const Automounter::OperationResult &result)
+{
+    int code;
+
+    switch(result.error_)
+    {
+      case Automounter::OperationResult::Error::NONE:
+        return false;
+
+      case Automounter::OperationResult::Error::NO_SUCH_OBJECT:
+        code = G_DBUS_ERROR_INVALID_ARGS;
+        break;
+
+      case Automounter::OperationResult::Error::NOT_SUPPORTED:
+        code = G_DBUS_ERROR_NOT_SUPPORTED;
+        break;
+
+      case Automounter::OperationResult::Error::BUSY:
+      case Automounter::OperationResult::Error::FAILED:
+      default:
+        code = G_DBUS_ERROR_FAILED;
+        break;
     }
 
+    g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, code,
+                                          "%s", result.message_.c_str());
+    return true;
+}
+
+gboolean dbusmethod_mount(tdbusMounTA2 *object,
+                          GDBusMethodInvocation *invocation,
+                          guint16 device_id, guint volume_index,
+                          void *user_data)
+{
+    log_invocation(invocation);
+
+    auto am = static_cast<Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    am->mount_volume(device_id, to_volume_index(volume_index),
+        [invocation] (const Automounter::OperationResult &result)
+        {
+            if(!return_operation_error(invocation, result))
+                g_dbus_method_invocation_return_value(invocation,
+                        g_variant_new("(@a{st})", mk_stages(result)));
+        });
+
     return TRUE;
 }
 
+gboolean dbusmethod_unmount(tdbusMounTA2 *object,
+                            GDBusMethodInvocation *invocation,
+                            guint16 device_id, guint volume_index,
+                            void *user_data)
+{
+    log_invocation(invocation);
+
+    auto am = static_cast<Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    am->unmount_volume(device_id, to_volume_index(volume_index),
+        [invocation] (const Automounter::OperationResult &result)
+        {
+            if(!return_operation_error(invocation, result))
+                g_dbus_method_invocation_return_value(invocation,
+                        g_variant_new("(@a{st})", mk_stages(result)));
+        });
+
+    return TRUE;
+}
+
+gboolean dbusmethod_eject(tdbusMounTA2 *object,
+                          GDBusMethodInvocation *invocation,
+                          guint16 device_id, void *user_data)
+{
+    log_invocation(invocation);
+
+    auto am = static_cast<Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    am->eject_device(device_id,
+        [invocation] (const Automounter::OperationResult &result)
+        {
+            if(!return_operation_error(invocation, result))
+                g_dbus_method_invocation_return_value(invocation,
+                        g_variant_new("(b@a{st})",
+                                      result.powered_off_ ? TRUE : FALSE,
+                                      mk_stages(result)));
+        });
+
+    return TRUE;
+}
+
+void dbus_announce_current_state(void *user_data)
+{
+    auto am = static_cast<const Automounter::Core *>(user_data);
+    msg_log_assert(am != nullptr);
+
+    am->announce_current_state();
+}
@@ -28,6 +28,7 @@
 #endif /* __cplusplus */
 #pragma GCC diagnostic ignored "-Wcast-qual"
 #include "de_tahifi_mounta.h"
+#include "de_tahifi_mounta2.h"
 #pragma GCC diagnostic pop
 
 #ifdef __cplusplus
@@ -37,6 +38,35 @@ extern "C" {
 gboolean dbusmethod_get_all(tdbusMounTA *object,
                             GDBusMethodInvocation *invocation,
                             void *user_data);
+gboolean dbusmethod_v2_get_all(tdbusMounTA2 *object,
+                               GDBusMethodInvocation *invocation,
+                               void *user_data);
+gboolean dbusmethod_get_changes_since(tdbusMounTA2 *object,
+                                      GDBusMethodInvocation *invocation,
+                                      guint64 generation, void *user_data);
+gboolean dbusmethod_wait_for_volume(tdbusMounTA2 *object,
+                                    GDBusMethodInvocation *invocation,
+                                    const gchar *uuid, guint timeout_ms,
+                                    void *user_data);
+gboolean dbusmethod_mount(tdbusMounTA2 *object,
+                          GDBusMethodInvocation *invocation,
+                          guint16 device_id, guint volume_index,
+                          void *user_data);
+gboolean dbusmethod_unmount(tdbusMounTA2 *object,
+                            GDBusMethodInvocation *invocation,
+                            guint16 device_id, guint volume_index,
+                            void *user_data);
+gboolean dbusmethod_eject(tdbusMounTA2 *object,
+                          GDBusMethodInvocation *invocation,
+                          guint16 device_id, void *user_data);
+
+/*!
+ * Announce all devices and volumes known so far.
+ *
+ * Called once the bus name has been acquired. Anything found before that
+ * time has not been announced on D-Bus.
+ */
+void dbus_announce_current_state(void *user_data);
 
 #ifdef __cplusplus
 }
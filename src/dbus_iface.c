@@ -28,16 +28,22 @@
 #include "dbus_iface.h"
 #include "dbus_iface_deep.h"
 #include "dbus_handlers.h"
+#include "dbus_objects.h"
+#include "dbus_wait.h"
 #include "de_tahifi_mounta.h"
+#include "de_tahifi_mounta2.h"
 #include "messages.h"
 
 struct dbus_data
 {
     guint owner_id;
     int acquired;
+    bool failed;
 
     bool connect_to_session_bus;
+    GMainLoop *loop;
     tdbusMounTA *mounta_iface;
+    tdbusMounTA2 *mounta2_iface;
     void *mounta_iface_user_data;
 };
 
@@ -61,16 +67,15 @@ static void bus_acquired(GDBusConnection *connection,
     msg_info("D-Bus \"%s\" acquired (%s bus)",
              name, data->connect_to_session_bus ? "session" : "system");
 
-    data->mounta_iface = tdbus_moun_ta_skeleton_new();
-
-    g_signal_connect(data->mounta_iface, "handle-get-all",
-                     G_CALLBACK(dbusmethod_get_all),
-                     data->mounta_iface_user_data);
-
     GError *error = NULL;
     g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(data->mounta_iface),
                                      connection, "/de/tahifi/MounTA", &error);
     (void)handle_dbus_error(&error);
+    g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(data->mounta2_iface),
+                                     connection, "/de/tahifi/MounTA", &error);
+    (void)handle_dbus_error(&error);
+
+    dbus_objects_setup(connection);
 }
 
 static void name_acquired(GDBusConnection *connection,
@@ -79,7 +84,15 @@ static void name_acquired(GDBusConnection *connection,
     struct dbus_data *data = user_data;
 
     msg_info("D-Bus name \"%s\" acquired", name);
+
+    if(data->acquired != 0)
+        return;
+
     data->acquired = 1;
+
+    /* devices may have been found and mounted while we were waiting for the
+     * bus, but nobody has heard about them yet */
+    dbus_announce_current_state(data->mounta_iface_user_data);
 }
 
 static void name_lost(GDBusConnection *connection,
@@ -88,6 +101,14 @@ static void name_lost(GDBusConnection *connection,
     struct dbus_data *data = user_data;
 
     msg_info("D-Bus name \"%s\" lost", name);
+
+    if(data->acquired == 0)
+    {
+        msg_error(0, LOG_EMERG, "Failed acquiring D-Bus name");
+        data->failed = true;
+        g_main_loop_quit(data->loop);
+    }
+
     data->acquired = -1;
 }
 
@@ -104,8 +125,36 @@ int dbus_setup(GMainLoop *loop, bool connect_to_session_bus,
     memset(&dbus_data, 0, sizeof(dbus_data));
 
     dbus_data.connect_to_session_bus = connect_to_session_bus;
+    dbus_data.loop = loop;
     dbus_data.mounta_iface_user_data = automounter_for_dbus_handlers;
 
+    /* created right away so that signals can be emitted at any time; they
+     * just go nowhere until the interface has been exported */
+    dbus_data.mounta_iface = tdbus_moun_ta_skeleton_new();
+    dbus_data.mounta2_iface = tdbus_moun_ta2_skeleton_new();
+
+    g_signal_connect(dbus_data.mounta_iface, "handle-get-all",
+                     G_CALLBACK(dbusmethod_get_all),
+                     dbus_data.mounta_iface_user_data);
+    g_signal_connect(dbus_data.mounta2_iface, "handle-get-all",
+                     G_CALLBACK(dbusmethod_v2_get_all),
+                     dbus_data.mounta_iface_user_data);
+    g_signal_connect(dbus_data.mounta2_iface, "handle-get-changes-since",
+                     G_CALLBACK(dbusmethod_get_changes_since),
+                     dbus_data.mounta_iface_user_data);
+    g_signal_connect(dbus_data.mounta2_iface, "handle-wait-for-volume",
+                     G_CALLBACK(dbusmethod_wait_for_volume),
+                     dbus_data.mounta_iface_user_data);
+    g_signal_connect(dbus_data.mounta2_iface, "handle-mount",
+                     G_CALLBACK(dbusmethod_mount),
+                     dbus_data.mounta_iface_user_data);
+    g_signal_connect(dbus_data.mounta2_iface, "handle-unmount",
+                     G_CALLBACK(dbusmethod_unmount),
+                     dbus_data.mounta_iface_user_data);
+    g_signal_connect(dbus_data.mounta2_iface, "handle-eject",
+                     G_CALLBACK(dbusmethod_eject),
+                     dbus_data.mounta_iface_user_data);
+
     GBusType bus_type =
         connect_to_session_bus ? G_BUS_TYPE_SESSION : G_BUS_TYPE_SYSTEM;
 
@@ -116,21 +165,18 @@ int dbus_setup(GMainLoop *loop, bool connect_to_session_bus,
                        bus_acquired, name_acquired, name_lost, &dbus_data,
                        destroy_notification);
 
-    while(dbus_data.owner_id != 0 && dbus_data.acquired == 0)
-    {
-        /* do whatever has to be done behind the scenes until one of the
-         * guaranteed callbacks gets called */
-        g_main_context_iteration(NULL, TRUE);
-    }
-
-    if(dbus_data.owner_id > 0 && dbus_data.acquired < 0)
+    if(dbus_data.owner_id == 0)
     {
-        msg_error(0, LOG_EMERG, "Failed acquiring D-Bus name");
+        msg_error(0, LOG_EMERG, "Failed requesting D-Bus name");
+        g_object_unref(dbus_data.mounta_iface);
+        g_object_unref(dbus_data.mounta2_iface);
+        dbus_data.mounta_iface = NULL;
+        dbus_data.mounta2_iface = NULL;
         return -1;
     }
 
-    msg_log_assert(dbus_data.mounta_iface != NULL);
-
+    /* name is acquired asynchronously from the main loop, so that devices
+     * can be probed and mounted in the meantime */
     g_main_loop_ref(loop);
 
     return 0;
@@ -141,13 +187,31 @@ void dbus_shutdown(GMainLoop *loop)
     if(loop == NULL)
         return;
 
+    dbus_wait_shutdown();
+    dbus_objects_shutdown();
     g_bus_unown_name(dbus_data.owner_id);
     g_main_loop_unref(loop);
 
     g_object_unref(dbus_data.mounta_iface);
+    g_object_unref(dbus_data.mounta2_iface);
+}
+
+bool dbus_is_ready(void)
+{
+    return dbus_data.acquired > 0;
+}
+
+bool dbus_has_failed(void)
+{
+    return dbus_data.failed;
 }
 
 tdbusMounTA *dbus_get_mounta_iface(void)
 {
     return dbus_data.mounta_iface;
 }
+
+tdbusMounTA2 *dbus_get_mounta2_iface(void)
+{
+    return dbus_data.mounta2_iface;
+}
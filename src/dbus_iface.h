@@ -43,6 +43,7 @@ extern "C" {
 int dbus_setup(GMainLoop *loop, bool connect_to_session_bus,
                void *automounter_for_dbus_handlers);
 void dbus_shutdown(GMainLoop *loop);
+bool dbus_has_failed(void);
 
 #ifdef __cplusplus
 }
@@ -30,13 +30,16 @@
 #endif /* __cplusplus */
 #pragma GCC diagnostic ignored "-Wcast-qual"
 #include "de_tahifi_mounta.h"
+#include "de_tahifi_mounta2.h"
 #pragma GCC diagnostic pop
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+bool dbus_is_ready(void);
 tdbusMounTA *dbus_get_mounta_iface(void);
+tdbusMounTA2 *dbus_get_mounta2_iface(void);
 
 #ifdef __cplusplus
 }
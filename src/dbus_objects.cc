@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <map>
+#include <iterator>
+#include <string>
+
+#include "dbus_objects.h"
+#include "dbus_properties.hh"
+#include "devices.hh"
+#include "messages.h"
+
+static const char introspection_xml[] =
+    "<node>"
+    "  <interface name='org.freedesktop.DBus.ObjectManager'>"
+    "    <method name='GetManagedObjects'>"
+    "      <arg name='objects' type='a{oa{sa{sv}}}' direction='out'/>"
+    "    </method>"
+    "    <signal name='InterfacesAdded'>"
+    "      <arg name='object' type='o'/>"
+    "      <arg name='interfaces' type='a{sa{sv}}'/>"
+    "    </signal>"
+    "    <signal name='InterfacesRemoved'>"
+    "      <arg name='object' type='o'/>"
+    "      <arg name='interfaces' type='as'/>"
+    "    </signal>"
+    "  </interface>"
+    "  <interface name='de.tahifi.MounTA.Device'>"
+    "    <property name='id' type='q' access='read'/>"
+    "    <property name='name' type='s' access='read'/>"
+    "    <property name='uuid' type='s' access='read'/>"
+    "    <property name='working_directory' type='s' access='read'/>"
+    "    <property name='usb_port' type='s' access='read'/>"
+    "    <property name='vendor' type='s' access='read'/>"
+    "    <property name='model' type='s' access='read'/>"
+    "    <property name='serial' type='s' access='read'/>"
+    "    <property name='size' type='t' access='read'/>"
+    "    <property name='usb_port_chain' type='s' access='read'/>"
+    "    <property name='usb_bus' type='q' access='read'/>"
+    "    <property name='usb_depth' type='y' access='read'/>"
+    "    <property name='usb_speed_kbps' type='u' access='read'/>"
+    "  </interface>"
+    "  <interface name='de.tahifi.MounTA.Volume'>"
+    "    <property name='index' type='u' access='read'/>"
+    "    <property name='label' type='s' access='read'/>"
+    "    <property name='mountpoint' type='s' access='read'/>"
+    "    <property name='device_id' type='q' access='read'/>"
+    "    <property name='uuid' type='s' access='read'/>"
+    "    <property name='fstype' type='s' access='read'/>"
+    "    <property name='fs_driver' type='s' access='read'/>"
+    "    <property name='size' type='t' access='read'/>"
+    "  </interface>"
+    "</node>";
+
+static const char manager_path[] = "/de/tahifi/MounTA";
+static const char manager_iface_name[] = "org.freedesktop.DBus.ObjectManager";
+static const char device_iface_name[] = "de.tahifi.MounTA.Device";
+static const char volume_iface_name[] = "de.tahifi.MounTA.Volume";
+
+struct ExportedObject
+{
+    guint registration_id_;
+    const char *iface_name_;
+
+    /*! Sunk reference to \c a{sv} dictionary of all properties. */
+    GVariant *properties_;
+};
+
+struct ObjectsData
+{
+    GDBusConnection *connection_;
+    GDBusNodeInfo *node_info_;
+    guint manager_registration_id_;
+
+    /*! Ordered by path, volumes follow their device. */
+    std::map<std::string, ExportedObject> objects_;
+};
+
+static ObjectsData objects_data;
+
+static GVariant *mk_interfaces_and_properties(const ExportedObject &obj)
+{
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sa{sv}}"));
+    g_variant_builder_add(&builder, "{s@a{sv}}", obj.iface_name_, obj.properties_);
+    return g_variant_builder_end(&builder);
+}
+
+static void manager_method_call(GDBusConnection *connection,
+                                const gchar *sender, const gchar *object_path,
+                                const gchar *interface_name,
+                                const gchar *method_name, GVariant *parameters,
+                                GDBusMethodInvocation *invocation,
+                                gpointer user_data)
+{
+    msg_info("%s method invocation from '%s': %s",
+             interface_name, sender, method_name);
+
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{oa{sa{sv}}}"));
+
+    for(const auto &obj : objects_data.objects_)
+        g_variant_builder_add(&builder, "{o@a{sa{sv}}}", obj.first.c_str(),
+                              mk_interfaces_and_properties(obj.second));
+
+    g_dbus_method_invocation_return_value(invocation,
+                                          g_variant_new("(@a{oa{sa{sv}}})",
+                                                        g_variant_builder_end(&builder)));
+}
+
+static GVariant *object_get_property(GDBusConnection *connection,
+                                     const gchar *sender,
+                                     const gchar *object_path,
+                                     const gchar *interface_name,
+                                     const gchar *property_name,
+                                     GError **error, gpointer user_data)
+{
+    const auto &obj = *static_cast<const ExportedObject *>(user_data);
+    GVariant *value = g_variant_lookup_value(obj.properties_, property_name, nullptr);
+
+    if(value == nullptr)
+        g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+                    "Property %s is not available", property_name);
+
+    return value;
+}
+
+static const GDBusInterfaceVTable manager_vtable = { manager_method_call, nullptr, nullptr, { 0 } };
+static const GDBusInterfaceVTable object_vtable = { nullptr, object_get_property, nullptr, { 0 } };
+
+void dbus_objects_setup(GDBusConnection *connection)
+{
+    GError *error = nullptr;
+
+    objects_data.node_info_ = g_dbus_node_info_new_for_xml(introspection_xml, &error);
+
+    if(objects_data.node_info_ == nullptr)
+    {
+        MSG_BUG("Failed parsing object introspection data: %s", error->message);
+        g_error_free(error);
+        return;
+    }
+
+    objects_data.manager_registration_id_ =
+        g_dbus_connection_register_object(
+            connection, manager_path,
+            g_dbus_node_info_lookup_interface(objects_data.node_info_,
+                                              manager_iface_name),
+            &manager_vtable, nullptr, nullptr, &error);
+
+    if(objects_data.manager_registration_id_ == 0)
+    {
+        msg_error(0, LOG_ERR, "Failed exporting object manager: %s",
+                  error->message);
+        g_error_free(error);
+        return;
+    }
+
+    objects_data.connection_ = connection;
+}
+
+static void unexport(std::map<std::string, ExportedObject>::iterator it)
+{
+    g_dbus_connection_unregister_object(objects_data.connection_,
+                                        it->second.registration_id_);
+
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("as"));
+    g_variant_builder_add(&builder, "s", it->second.iface_name_);
+
+    g_dbus_connection_emit_signal(objects_data.connection_, nullptr,
+                                  manager_path, manager_iface_name,
+                                  "InterfacesRemoved",
+                                  g_variant_new("(o@as)", it->first.c_str(),
+                                                g_variant_builder_end(&builder)),
+                                  nullptr);
+
+    g_variant_unref(it->second.properties_);
+    objects_data.objects_.erase(it);
+}
+
+void dbus_objects_shutdown(void)
+{
+    if(objects_data.connection_ != nullptr)
+    {
+        while(!objects_data.objects_.empty())
+            unexport(objects_data.objects_.begin());
+
+        g_dbus_connection_unregister_object(objects_data.connection_,
+                                            objects_data.manager_registration_id_);
+        objects_data.manager_registration_id_ = 0;
+        objects_data.connection_ = nullptr;
+    }
+
+    if(objects_data.node_info_ != nullptr)
+    {
+        g_dbus_node_info_unref(objects_data.node_info_);
+        objects_data.node_info_ = nullptr;
+    }
+}
+
+static std::string mk_device_path(const Devices::Device &dev)
+{
+    std::string path(manager_path);
+    path += "/dev/";
+    path += std::to_string(dev.get_id());
+    return path;
+}
+
+static void export_object(std::string &&path, const char *iface_name,
+                          GVariant *properties)
+{
+    properties = g_variant_ref_sink(properties);
+
+    if(objects_data.connection_ == nullptr)
+    {
+        g_variant_unref(properties);
+        return;
+    }
+
+    auto existing(objects_data.objects_.find(path));
+
+    if(existing != objects_data.objects_.end())
+    {
+        MSG_BUG("Object %s exported twice", path.c_str());
+        unexport(existing);
+    }
+
+    auto &obj(objects_data.objects_[path]);
+    obj.iface_name_ = iface_name;
+    obj.properties_ = properties;
+
+    GError *error = nullptr;
+    obj.registration_id_ =
+        g_dbus_connection_register_object(
+            objects_data.connection_, path.c_str(),
+            g_dbus_node_info_lookup_interface(objects_data.node_info_, iface_name),
+            &object_vtable, &obj, nullptr, &error);
+
+    if(obj.registration_id_ == 0)
+    {
+        msg_error(0, LOG_ERR, "Failed exporting %s: %s",
+                  path.c_str(), error->message);
+        g_error_free(error);
+        g_variant_unref(properties);
+        objects_data.objects_.erase(path);
+        return;
+    }
+
+    g_dbus_connection_emit_signal(objects_data.connection_, nullptr,
+                                  manager_path, manager_iface_name,
+                                  "InterfacesAdded",
+                                  g_variant_new("(o@a{sa{sv}})", path.c_str(),
+                                                mk_interfaces_and_properties(obj)),
+                                  nullptr);
+}
+
+void dbus_objects_add_device(const Devices::Device &dev)
+{
+    export_object(mk_device_path(dev), device_iface_name,
+                  dbus_mk_device_object_properties(dev));
+}
+
+static std::string mk_volume_path(const Devices::Volume &vol)
+{
+    std::string path(mk_device_path(*vol.get_device()));
+    path += '/';
+    path += std::to_string(vol.get_index() >= 0 ? vol.get_index() : 0);
+    return path;
+}
+
+void dbus_objects_add_volume(const Devices::Volume &vol)
+{
+    export_object(mk_volume_path(vol), volume_iface_name,
+                  dbus_mk_volume_object_properties(vol));
+}
+
+void dbus_objects_remove_volume(const Devices::Volume &vol)
+{
+    if(objects_data.connection_ == nullptr)
+        return;
+
+    auto it(objects_data.objects_.find(mk_volume_path(vol)));
+
+    if(it != objects_data.objects_.end())
+        unexport(it);
+}
+
+void dbus_objects_remove_device(const Devices::Device &dev)
+{
+    if(objects_data.connection_ == nullptr)
+        return;
+
+    const std::string path(mk_device_path(dev));
+    const std::string volumes_prefix(path + '/');
+
+    /* volumes first, then the device */
+    auto it(objects_data.objects_.lower_bound(volumes_prefix));
+
+    while(it != objects_data.objects_.end() &&
+          it->first.compare(0, volumes_prefix.length(), volumes_prefix) == 0)
+    {
+        auto next(std::next(it));
+        unexport(it);
+        it = next;
+    }
+
+    it = objects_data.objects_.find(path);
+
+    if(it != objects_data.objects_.end())
+        unexport(it);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef DBUS_OBJECTS_H
+#define DBUS_OBJECTS_H
+
+#pragma GCC diagnostic push
+#ifdef __cplusplus
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#endif /* __cplusplus */
+#include <gio/gio.h>
+#pragma GCC diagnostic pop
+
+/*!
+ * \addtogroup dbus
+ */
+/*!@{*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Export \c org.freedesktop.DBus.ObjectManager on \c /de/tahifi/MounTA.
+ *
+ * Devices and volumes are exported as objects below that path, see
+ * #dbus_objects_add_device() and #dbus_objects_add_volume().
+ */
+void dbus_objects_setup(GDBusConnection *connection);
+
+/*!
+ * Unexport all objects and the object manager.
+ */
+void dbus_objects_shutdown(void);
+
+#ifdef __cplusplus
+}
+
+namespace Devices
+{
+    class Device;
+    class Volume;
+}
+
+/*!
+ * Export device as \c /de/tahifi/MounTA/dev/ID.
+ *
+ * The object implements \c de.tahifi.MounTA.Device with read-only properties
+ * as built by #dbus_mk_device_object_properties(), accessible through
+ * \c org.freedesktop.DBus.Properties.
+ */
+void dbus_objects_add_device(const Devices::Device &dev);
+
+/*!
+ * Export volume as \c /de/tahifi/MounTA/dev/ID/INDEX.
+ *
+ * The object implements \c de.tahifi.MounTA.Volume with read-only properties
+ * as built by #dbus_mk_volume_object_properties(). Volumes without partition
+ * number (whole-disk file systems) get index 0.
+ */
+void dbus_objects_add_volume(const Devices::Volume &vol);
+
+/*!
+ * Unexport volume which has been unmounted while its device remains.
+ */
+void dbus_objects_remove_volume(const Devices::Volume &vol);
+
+/*!
+ * Unexport device and all its volumes.
+ */
+void dbus_objects_remove_device(const Devices::Device &dev);
+
+#endif /* __cplusplus */
+
+/*!@}*/
+
+#endif /* !DBUS_OBJECTS_H */
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <climits>
+
+#include "dbus_properties.hh"
+#include "devices.hh"
+#include "fsmount_options.hh"
+
+static void add_string(GVariantBuilder &builder, const char *key,
+                       const std::string &value)
+{
+    if(!value.empty())
+        g_variant_builder_add(&builder, "{sv}", key,
+                              g_variant_new_string(value.c_str()));
+}
+
+static void add_device_properties(GVariantBuilder &builder,
+                                  const Devices::Device &dev)
+{
+    add_string(builder, "vendor", dev.get_vendor());
+    add_string(builder, "model", dev.get_model());
+    add_string(builder, "serial", dev.get_serial());
+
+    if(dev.get_size() > 0)
+        g_variant_builder_add(&builder, "{sv}", "size",
+                              g_variant_new_uint64(dev.get_size()));
+
+    add_string(builder, "usb_port_chain", dev.get_usb_port_chain());
+
+    if(dev.get_usb_bus() > 0)
+        g_variant_builder_add(&builder, "{sv}", "usb_bus",
+                              g_variant_new_uint16(dev.get_usb_bus()));
+
+    if(dev.get_usb_depth() > 0)
+        g_variant_builder_add(&builder, "{sv}", "usb_depth",
+                              g_variant_new_byte(dev.get_usb_depth()));
+
+    if(dev.get_usb_speed_kbps() > 0)
+        g_variant_builder_add(&builder, "{sv}", "usb_speed_kbps",
+                              g_variant_new_uint32(dev.get_usb_speed_kbps()));
+}
+
+static void add_volume_properties(GVariantBuilder &builder,
+                                  const Devices::Volume &vol)
+{
+    add_string(builder, "fstype", vol.get_fstype());
+
+    if(vol.get_fs_driver() != nullptr)
+        add_string(builder, "fs_driver", vol.get_fs_driver()->name);
+
+    if(vol.get_size() > 0)
+        g_variant_builder_add(&builder, "{sv}", "size",
+                              g_variant_new_uint64(vol.get_size()));
+}
+
+GVariant *dbus_mk_device_properties(const Devices::Device &dev)
+{
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    add_device_properties(builder, dev);
+    return g_variant_builder_end(&builder);
+}
+
+GVariant *dbus_mk_volume_properties(const Devices::Volume &vol)
+{
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+    add_volume_properties(builder, vol);
+    return g_variant_builder_end(&builder);
+}
+
+void dbus_add_device_tuple(GVariantBuilder &builder, const Devices::Device &dev)
+{
+    /* note: this duplicates #emit_new_device() */
+    g_variant_builder_add(&builder,
+                          "(qssss)",
+                          dev.get_id(),
+                          dev.get_display_name(),
+                          dev.get_device_uuid().c_str(),
+                          dev.get_working_directory().str().c_str(),
+                          dev.get_usb_port().c_str());
+}
+
+void dbus_add_volume_tuple(GVariantBuilder &builder, const Devices::Volume &vol)
+{
+    /* note: this duplicates #emit_new_volume() */
+    g_variant_builder_add(&builder,
+                          "(ussqs)",
+                          vol.get_index() >= 0 ? vol.get_index() : UINT_MAX,
+                          vol.get_label().c_str(),
+                          vol.get_mountpoint_name().c_str(),
+                          vol.get_device()->get_id(),
+                          vol.get_volume_uuid().c_str());
+}
+
+void dbus_add_device_details_tuple(GVariantBuilder &builder,
+                                   const Devices::Device &dev)
+{
+    g_variant_builder_add(&builder,
+                          "(qssss@a{sv})",
+                          dev.get_id(),
+                          dev.get_display_name(),
+                          dev.get_device_uuid().c_str(),
+                          dev.get_working_directory().str().c_str(),
+                          dev.get_usb_port().c_str(),
+                          dbus_mk_device_properties(dev));
+}
+
+void dbus_add_volume_details_tuple(GVariantBuilder &builder,
+                                   const Devices::Volume &vol)
+{
+    g_variant_builder_add(&builder,
+                          "(ussqs@a{sv})",
+                          vol.get_index() >= 0 ? vol.get_index() : UINT_MAX,
+                          vol.get_label().c_str(),
+                          vol.get_mountpoint_name().c_str(),
+                          vol.get_device()->get_id(),
+                          vol.get_volume_uuid().c_str(),
+                          dbus_mk_volume_properties(vol));
+}
+
+GVariant *dbus_mk_volume_details_tuple(const Devices::Volume &vol)
+{
+    return g_variant_new("(ussqs@a{sv})",
+                         vol.get_index() >= 0 ? vol.get_index() : UINT_MAX,
+                         vol.get_label().c_str(),
+                         vol.get_mountpoint_name().c_str(),
+                         vol.get_device()->get_id(),
+                         vol.get_volume_uuid().c_str(),
+                         dbus_mk_volume_properties(vol));
+}
+
+GVariant *dbus_mk_device_object_properties(const Devices::Device &dev)
+{
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+
+    g_variant_builder_add(&builder, "{sv}", "id",
+                          g_variant_new_uint16(dev.get_id()));
+    g_variant_builder_add(&builder, "{sv}", "name",
+                          g_variant_new_string(dev.get_display_name()));
+    add_string(builder, "uuid", dev.get_device_uuid());
+    add_string(builder, "working_directory", dev.get_working_directory().str());
+    add_string(builder, "usb_port", dev.get_usb_port());
+    add_device_properties(builder, dev);
+
+    return g_variant_builder_end(&builder);
+}
+
+GVariant *dbus_mk_volume_object_properties(const Devices::Volume &vol)
+{
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{sv}"));
+
+    g_variant_builder_add(&builder, "{sv}", "index",
+                          g_variant_new_uint32(vol.get_index() >= 0
+                                               ? vol.get_index()
+                                               : UINT_MAX));
+    add_string(builder, "label", vol.get_label());
+    add_string(builder, "mountpoint", vol.get_mountpoint_name());
+    g_variant_builder_add(&builder, "{sv}", "device_id",
+                          g_variant_new_uint16(vol.get_device()->get_id()));
+    add_string(builder, "uuid", vol.get_volume_uuid());
+    add_volume_properties(builder, vol);
+
+    return g_variant_builder_end(&builder);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef DBUS_PROPERTIES_HH
+#define DBUS_PROPERTIES_HH
+
+#include <glib.h>
+
+namespace Devices
+{
+    class Device;
+    class Volume;
+}
+
+/*!
+ * Build \c a{sv} dictionary of extended device information for D-Bus.
+ *
+ * Keys are \c vendor, \c model, \c serial (strings), \c size (\c t, bytes),
+ * \c usb_port_chain (string such as "1-1.5"), \c usb_bus (\c q),
+ * \c usb_depth (\c y), and \c usb_speed_kbps (\c u). Keys with unknown
+ * values are omitted.
+ *
+ * \returns
+ *     Floating reference to the dictionary.
+ */
+GVariant *dbus_mk_device_properties(const Devices::Device &dev);
+
+/*!
+ * Build \c a{sv} dictionary of extended volume information for D-Bus.
+ *
+ * Keys are \c fstype (string) and \c size (\c t, bytes). Keys with unknown
+ * values are omitted.
+ *
+ * \returns
+ *     Floating reference to the dictionary.
+ */
+GVariant *dbus_mk_volume_properties(const Devices::Volume &vol);
+
+/*!
+ * Add device to array of \c (qssss) as sent by \c de.tahifi.MounTA.GetAll.
+ */
+void dbus_add_device_tuple(GVariantBuilder &builder, const Devices::Device &dev);
+
+/*!
+ * Add volume to array of \c (ussqs) as sent by \c de.tahifi.MounTA.GetAll.
+ */
+void dbus_add_volume_tuple(GVariantBuilder &builder, const Devices::Volume &vol);
+
+/*!
+ * Add device to array of \c (qssssa{sv}) as sent by
+ * \c de.tahifi.MounTA2.GetAll.
+ */
+void dbus_add_device_details_tuple(GVariantBuilder &builder,
+                                   const Devices::Device &dev);
+
+/*!
+ * Add volume to array of \c (ussqsa{sv}) as sent by
+ * \c de.tahifi.MounTA2.GetAll.
+ */
+void dbus_add_volume_details_tuple(GVariantBuilder &builder,
+                                   const Devices::Volume &vol);
+
+/*!
+ * Volume as a single \c (ussqsa{sv}) tuple, same as in
+ * #dbus_add_volume_details_tuple().
+ */
+GVariant *dbus_mk_volume_details_tuple(const Devices::Volume &vol);
+
+/*!
+ * Build \c a{sv} dictionary of all properties of a device object.
+ *
+ * In addition to the keys described for #dbus_mk_device_properties(), there
+ * are \c id (\c q), \c name, \c uuid, \c working_directory, and
+ * \c usb_port (strings).
+ *
+ * \returns
+ *     Floating reference to the dictionary.
+ */
+GVariant *dbus_mk_device_object_properties(const Devices::Device &dev);
+
+/*!
+ * Build \c a{sv} dictionary of all properties of a volume object.
+ *
+ * In addition to the keys described for #dbus_mk_volume_properties(), there
+ * are \c index (\c u), \c label, \c mountpoint, \c uuid (strings), and
+ * \c device_id (\c q).
+ *
+ * \returns
+ *     Floating reference to the dictionary.
+ */
+GVariant *dbus_mk_volume_object_properties(const Devices::Volume &vol);
+
+#endif /* !DBUS_PROPERTIES_HH */
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string>
+
+#include "dbus_wait.h"
+#include "dbus_properties.hh"
+#include "wait_index.hh"
+#include "automounter.hh"
+#include "messages.h"
+
+/*!
+ * Upper limit of pending invocations, protects against broken clients.
+ */
+static constexpr size_t max_waiters = 64;
+
+/*!
+ * Upper limit of timeout in milliseconds.
+ */
+static constexpr unsigned int max_timeout_ms = 3600U * 1000U;
+
+struct VolumeWaiter
+{
+    GDBusMethodInvocation *const invocation_;
+    const std::string uuid_;
+    guint timeout_id_;
+
+    explicit VolumeWaiter(GDBusMethodInvocation *invocation, const char *uuid):
+        invocation_(invocation),
+        uuid_(uuid),
+        timeout_id_(0)
+    {}
+};
+
+static Automounter::WaitIndex<VolumeWaiter *> volume_waiters;
+
+static const Devices::Volume *find_mounted_volume(const Automounter::Core &am,
+                                                  const char *uuid)
+{
+    for(const auto &device : am)
+    {
+        if(device.get_state() != Devices::Device::OK)
+            continue;
+
+        for(const auto &volume_iter : device)
+        {
+            const auto *volume = volume_iter.second.get();
+
+            if(volume != nullptr &&
+               volume->get_state() == Devices::Volume::MOUNTED &&
+               volume->get_volume_uuid() == uuid)
+                return volume;
+        }
+    }
+
+    return nullptr;
+}
+
+static gboolean waiter_timed_out(gpointer user_data)
+{
+    auto *waiter = static_cast<VolumeWaiter *>(user_data);
+
+    volume_waiters.remove(waiter->uuid_, waiter);
+    g_dbus_method_invocation_return_error(waiter->invocation_,
+                                          G_DBUS_ERROR, G_DBUS_ERROR_TIMED_OUT,
+                                          "Volume %s not mounted in time",
+                                          waiter->uuid_.c_str());
+    delete waiter;
+
+    return G_SOURCE_REMOVE;
+}
+
+void dbus_wait_for_volume(const Automounter::Core &am,
+                          GDBusMethodInvocation *invocation,
+                          const char *uuid, unsigned int timeout_ms)
+{
+    if(uuid == nullptr || uuid[0] == '\0' || timeout_ms > max_timeout_ms)
+    {
+        g_dbus_method_invocation_return_error(invocation,
+                                              G_DBUS_ERROR, G_DBUS_ERROR_INVALID_ARGS,
+                                              "Need UUID and timeout up to %u ms",
+                                              max_timeout_ms);
+        return;
+    }
+
+    const auto *volume = find_mounted_volume(am, uuid);
+
+    if(volume != nullptr)
+    {
+        g_dbus_method_invocation_return_value(invocation,
+                                              dbus_mk_volume_details_tuple(*volume));
+        return;
+    }
+
+    if(timeout_ms == 0)
+    {
+        g_dbus_method_invocation_return_error(invocation,
+                                              G_DBUS_ERROR, G_DBUS_ERROR_TIMED_OUT,
+                                              "Volume %s not mounted", uuid);
+        return;
+    }
+
+    if(volume_waiters.size() >= max_waiters)
+    {
+        g_dbus_method_invocation_return_error(invocation,
+                                              G_DBUS_ERROR, G_DBUS_ERROR_LIMITS_EXCEEDED,
+                                              "Too many clients waiting for volumes");
+        return;
+    }
+
+    auto *waiter = new VolumeWaiter(invocation, uuid);
+    waiter->timeout_id_ = g_timeout_add(timeout_ms, waiter_timed_out, waiter);
+    volume_waiters.add(waiter->uuid_, waiter);
+}
+
+void dbus_wait_volume_mounted(const Devices::Volume &vol)
+{
+    if(volume_waiters.size() == 0 || vol.get_volume_uuid().empty())
+        return;
+
+    for(auto *waiter : volume_waiters.take(vol.get_volume_uuid()))
+    {
+        g_source_remove(waiter->timeout_id_);
+        g_dbus_method_invocation_return_value(waiter->invocation_,
+                                              dbus_mk_volume_details_tuple(vol));
+        delete waiter;
+    }
+}
+
+void dbus_wait_shutdown(void)
+{
+    for(auto *waiter : volume_waiters.take_all())
+    {
+        g_source_remove(waiter->timeout_id_);
+        g_dbus_method_invocation_return_error(waiter->invocation_,
+                                              G_DBUS_ERROR, G_DBUS_ERROR_FAILED,
+                                              "Shutting down");
+        delete waiter;
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef DBUS_WAIT_H
+#define DBUS_WAIT_H
+
+#pragma GCC diagnostic push
+#ifdef __cplusplus
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#endif /* __cplusplus */
+#include <gio/gio.h>
+#pragma GCC diagnostic pop
+
+/*!
+ * \addtogroup dbus
+ */
+/*!@{*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Fail all pending \c WaitForVolume invocations.
+ */
+void dbus_wait_shutdown(void);
+
+#ifdef __cplusplus
+}
+
+namespace Automounter { class Core; }
+namespace Devices { class Volume; }
+
+/*!
+ * Answer \c de.tahifi.MounTA2.WaitForVolume now or as soon as the volume has
+ * been mounted.
+ *
+ * If a volume with the given UUID is mounted already, the invocation is
+ * completed right away. Otherwise, it is held in an index keyed by UUID until
+ * #dbus_wait_volume_mounted() is called for a matching volume, or until the
+ * timeout expires.
+ */
+void dbus_wait_for_volume(const Automounter::Core &am,
+                          GDBusMethodInvocation *invocation,
+                          const char *uuid, unsigned int timeout_ms);
+
+/*!
+ * Complete all invocations waiting for this volume.
+ *
+ * To be called when the volume has been mounted and announced.
+ */
+void dbus_wait_volume_mounted(const Devices::Volume &vol);
+
+#endif /* __cplusplus */
+
+/*!@}*/
+
+#endif /* !DBUS_WAIT_H */
@@ -91,7 +91,15 @@ static bool is_link_to_partition(const char *devlink_hyphen)
     return true;
 }
 
-const std::string mk_root_devlink_name(const char *devlink)
+/*!
+ * Length of name of the root device link for given partition device link.
+ *
+ * \returns
+ *     The number of characters of \p devlink which make up the name of the
+ *     device link of the containing device, or 0 if \p devlink does not
+ *     refer to a partition.
+ */
+static size_t get_root_devlink_name_length(const char *devlink)
 {
     msg_log_assert(devlink != nullptr);
     msg_log_assert(devlink[0] != '\0');
@@ -99,12 +107,17 @@ const std::string mk_root_devlink_name(const char *devlink)
     const char *hyphen = strrchr(devlink, '-');
 
     if(is_link_to_partition(hyphen))
-        return std::string(devlink, 0, hyphen - devlink);
+        return hyphen - devlink;
 
     msg_error(EINVAL, LOG_ERR,
               "Malformed device link name \"%s\"", devlink);
 
-    return "";
+    return 0;
+}
+
+static std::string mk_root_devlink_name(const char *devlink)
+{
+    return std::string(devlink, get_root_devlink_name_length(devlink));
 }
 
 static inline Devices::AllDevices::DevContainerType::iterator
@@ -120,8 +133,19 @@ get_device_iter_by_devlink(Devices::AllDevices::DevContainerType &devices,
 
 std::shared_ptr<Devices::Device> Devices::AllDevices::find_root_device(const char *devlink)
 {
-    const std::string temp(mk_root_devlink_name(devlink));
-    const auto &dev = get_device_iter_by_devlink(devices_, temp.c_str());
+    const size_t length = get_root_devlink_name_length(devlink);
+
+    if(length == 0)
+        return nullptr;
+
+    const auto &dev =
+        std::find_if(devices_.begin(), devices_.end(),
+            [devlink, length] (const DevContainerType::value_type &it)
+            {
+                const auto &name(it.second->get_devlink_name());
+                return name.length() == length && name.compare(0, length, devlink, length) == 0;
+            });
+
     return (dev != devices_.end()) ? dev->second : nullptr;
 }
 
@@ -154,7 +178,8 @@ Devices::AllDevices::new_entry(const char *devlink, Devices::Volume *&volume,
 
         if(have_volume_info)
         {
-            auto device_and_volume = add_or_get_volume(device, devlink, data.devname_, volinfo);
+            auto device_and_volume =
+                add_or_get_volume(device, devlink, data.devname_, std::move(volinfo));
 
             msg_log_assert(device_and_volume.first == device ||
                            (device == nullptr && device_and_volume.first != nullptr));
@@ -168,7 +193,7 @@ Devices::AllDevices::new_entry(const char *devlink, Devices::Volume *&volume,
     else if(device != nullptr && data.volume_number_ == 0)
     {
         if(!have_probed_containing_device)
-            have_probed_containing_device = device->probe();
+            have_probed_containing_device = device->probe(shared_->strings_);
 
         volume = device->lookup_volume_by_devname(data.devname_);
     }
@@ -181,7 +206,7 @@ Devices::AllDevices::new_entry_by_mountpoint(const char *mountpoint_path,
                                              Devices::Volume *&volume)
 {
     {
-        Automounter::Mountpoint mp(tools_, mountpoint_path);
+        Automounter::Mountpoint mp(shared_->tools_, mountpoint_path);
         if(!mp.probe(false))
         {
             msg_error(EINVAL, LOG_ERR, "Not a mountpoint: %s", mountpoint_path);
@@ -260,9 +285,10 @@ bool Devices::AllDevices::remove_entry(Devices::AllDevices::DevContainerType::co
     return true;
 }
 
+template <typename AllocFn>
 static std::shared_ptr<Devices::Device>
 mk_device(Devices::AllDevices::DevContainerType &all_devices,
-          const std::function<std::shared_ptr<Devices::Device>(const Devices::ID &device_id)> &alloc_device)
+          const AllocFn &alloc_device)
 {
     std::shared_ptr<Devices::Device> device;
 
@@ -325,7 +351,8 @@ Devices::AllDevices::add_or_get_device(const char *devlink,
         [this, &devlink, &have_probed_containing_device]
         (const ID &device_id)
         {
-            auto d = std::make_shared<Device>(device_id, devlink, true);
+            auto d = std::make_shared<Device>(device_id, devlink, true,
+                                              shared_->strings_);
             have_probed_containing_device = d->get_state() == Device::State::PROBED;
             return d;
         });
@@ -335,7 +362,7 @@ std::pair<std::shared_ptr<Devices::Device>, Devices::Volume *>
 Devices::AllDevices::add_or_get_volume(std::shared_ptr<Devices::Device> device,
                                        const char *devlink,
                                        const std::string &devname,
-                                       const VolumeInfo &volinfo)
+                                       VolumeInfo &&volinfo)
 {
 
     if(device == nullptr)
@@ -345,7 +372,7 @@ Devices::AllDevices::add_or_get_volume(std::shared_ptr<Devices::Device> device,
             {
                 return std::make_shared<Device>(device_id,
                                                 mk_root_devlink_name(devlink),
-                                                false);
+                                                false, shared_->strings_);
             });
     }
 
@@ -361,12 +388,12 @@ Devices::AllDevices::add_or_get_volume(std::shared_ptr<Devices::Device> device,
         return std::make_pair(device, existing_volume);
     }
 
-    const auto &label(!volinfo.label.empty() ? volinfo.label : volinfo.fstype);
-
     auto volume = std::unique_ptr<Volume>(
                         new Volume(device, volinfo.idx,
-                                   label, volinfo.volume_uuid, volinfo.fstype,
-                                   devname, tools_, symlink_directory_));
+                                   std::move(volinfo.label),
+                                   std::move(volinfo.volume_uuid),
+                                   volinfo.fstype, devname,
+                                   volinfo.size_bytes, *shared_));
 
     existing_volume = volume.get();
 
@@ -380,3 +407,29 @@ Devices::AllDevices::add_or_get_volume(std::shared_ptr<Devices::Device> device,
 
     return std::make_pair(device, existing_volume);
 }
+
+bool Devices::AllDevices::set_symlink_directory(const std::string &symlink_directory)
+{
+    auto &symlinks(shared_->label_symlinks_);
+
+    if(symlink_directory == symlinks.get_directory())
+        return true;
+
+    for(const auto &dev : devices_)
+        for(const auto &vol : *dev.second)
+            if(vol.second != nullptr)
+                vol.second->remove_symlink();
+
+    msg_info("Symlink directory changed from \"%s\" to \"%s\"",
+             symlinks.get_directory().c_str(), symlink_directory.c_str());
+
+    symlinks.reset(symlink_directory);
+    const bool retval = symlinks.seed();
+
+    for(const auto &dev : devices_)
+        for(const auto &vol : *dev.second)
+            if(vol.second != nullptr)
+                vol.second->restore_symlink();
+
+    return retval;
+}
@@ -51,8 +51,7 @@ class AllDevices
 
   private:
     DevContainerType devices_;
-    const Automounter::ExternalTools &tools_;
-    const std::string symlink_directory_;
+    std::unique_ptr<SharedData> shared_;
     std::unordered_map<std::string, std::string> volume_device_for_mountpoint_;
 
   public:
@@ -61,8 +60,7 @@ class AllDevices
     AllDevices(AllDevices &&) = default;
 
     explicit AllDevices(const Automounter::ExternalTools &tools, const std::string& symlink_directory):
-        tools_(tools),
-        symlink_directory_(symlink_directory)
+        shared_(std::make_unique<SharedData>(tools, symlink_directory))
     {}
 
     ~AllDevices();
@@ -93,6 +91,28 @@ class AllDevices
     decltype(devices_)::const_iterator end() const   { return devices_.end(); };
     size_t get_number_of_devices() const             { return devices_.size(); }
 
+    const Device *get_device_by_id(ID::value_type id) const
+    {
+        const auto it(devices_.find(id));
+        return it != devices_.end() ? it->second.get() : nullptr;
+    }
+
+    const SharedData &get_shared_data() const        { return *shared_; }
+
+    bool seed_label_symlinks() { return shared_->label_symlinks_.seed(); }
+
+    /*!
+     * Move label symlinks of all mounted volumes to another directory.
+     *
+     * Symlinks are removed from the old directory, and new ones are created
+     * in \p symlink_directory. An empty name disables symlinks.
+     *
+     * \returns
+     *     False if the new directory cannot be opened, in which case no
+     *     symlinks are created.
+     */
+    bool set_symlink_directory(const std::string &symlink_directory);
+
   private:
     std::shared_ptr<Device> add_or_get_device(const char *devlink,
                                               const std::string &devname,
@@ -106,7 +126,7 @@ class AllDevices
     std::pair<std::shared_ptr<Devices::Device>, Devices::Volume *>
     add_or_get_volume(std::shared_ptr<Device> device,
                       const char *devlink, const std::string &devname,
-                      const VolumeInfo &volinfo);
+                      VolumeInfo &&volinfo);
 };
 
 }
@@ -26,7 +26,6 @@
 
 #include <algorithm>
 #include <cstring>
-#include <sstream>
 #include <dirent.h>
 #include "os.hh"
 
@@ -77,6 +76,12 @@ Devices::Device::lookup_volume_by_devname(const std::string &devname) const
     return (vol != volumes_.end()) ? vol->second.get() : nullptr;
 }
 
+Devices::Volume *Devices::Device::lookup_volume_by_index(int idx) const
+{
+    const auto &vol = volumes_.find(idx);
+    return (vol != volumes_.end()) ? vol->second.get() : nullptr;
+}
+
 bool Devices::Device::add_volume(std::unique_ptr<Devices::Volume> &&volume)
 {
     auto idx = volume->get_index();
@@ -122,21 +127,21 @@ void Devices::Device::set_mountpoint_directory(std::string &&path)
     mountpoint_container_path_.set_externally_managed();
 }
 
-bool Devices::Device::probe()
+bool Devices::Device::probe(StringPool &strings)
 {
-    return state_ == SYNTHETIC ? do_probe() : false;
+    return state_ == SYNTHETIC ? do_probe(strings) : false;
 }
 
-bool Devices::Device::do_probe()
+bool Devices::Device::do_probe(StringPool &strings)
 {
     msg_log_assert(state_ == SYNTHETIC);
 
     DeviceInfo devinfo;
 
     const char *name = strrchr(devlink_name_.c_str(), '/');
-    device_name_ = (name != nullptr) ? (name + 1) : devlink_name_.c_str();
+    device_name_offset_ = (name != nullptr) ? (name + 1 - devlink_name_.c_str()) : 0;
 
-    if(device_name_.empty() ||
+    if(get_display_name()[0] == '\0' ||
        !get_device_information(devlink_name_, devinfo))
     {
         state_ = BROKEN;
@@ -150,8 +155,16 @@ bool Devices::Device::do_probe()
         break;
 
       case DeviceType::USB:
-        usb_port_ = std::move(devinfo.usb_port_sysfs_name);
+        usb_port_ = &strings.intern(std::move(devinfo.usb_port_sysfs_name));
         uuid_ = std::move(devinfo.device_uuid);
+        vendor_ = &strings.intern(std::move(devinfo.vendor));
+        model_ = &strings.intern(std::move(devinfo.model));
+        serial_ = std::move(devinfo.serial);
+        size_ = devinfo.size_bytes;
+        usb_port_chain_ = &strings.intern(std::move(devinfo.usb_port_chain));
+        usb_speed_kbps_ = devinfo.usb_speed_kbps;
+        usb_bus_ = devinfo.usb_bus;
+        usb_depth_ = devinfo.usb_depth;
         state_ = PROBED;
         return true;
     }
@@ -164,10 +177,8 @@ bool Devices::Volume::mk_mountpoint_directory()
     if(containing_device_ == nullptr)
         return false;
 
-    std::ostringstream os;
-    os << containing_device_->get_working_directory().str() << '/' << index_;
-
-    mountpoint_.set(std::move(os.str()));
+    mountpoint_.set(Automounter::mk_numbered_path(containing_device_->get_working_directory().str(),
+                                                  index_));
 
     return mountpoint_.create();
 }
@@ -183,33 +194,112 @@ bool Devices::Volume::set_unmanaged_mountpoint_directory()
 
 bool Devices::Volume::mount(const Automounter::FSMountOptions &mount_options)
 {
-    if(!mountpoint_.mount(devname_, mount_options.get_options(fstype_)))
+    if(!mountpoint_.mount(devname_, mount_options.get_options(*fstype_)))
         return false;
 
-    if(!symlink_directory_.empty())
+    create_symlink();
+
+    return true;
+}
+
+void Devices::Volume::create_symlink()
+{
+    if(shared_.label_symlinks_.is_enabled())
+        shared_.label_symlinks_.create(get_label(), mountpoint_.str(), symlink_);
+}
+
+/*!
+ * Mount tool options for given driver, including the file system type.
+ */
+static std::string mk_driver_options(const Automounter::FSMountOptions &mount_options,
+                                     const Automounter::FSDriver &driver)
+{
+    std::string options("-t ");
+    options.append(driver.name).push_back(' ');
+    options.append(mount_options.get_driver_options(driver));
+    return options;
+}
+
+bool Devices::Volume::begin_mount(const Automounter::FSMountOptions &mount_options,
+                                  const Automounter::FSDriver *driver,
+                                  std::string &command)
+{
+    msg_log_assert(state_ == PENDING || state_ == UNMOUNTED || state_ == UNUSABLE);
+
+    command.clear();
+    fs_driver_ = driver;
+
+    if(mk_mountpoint_directory())
+        command = mountpoint_.mk_mount_command(devname_,
+                                               driver != nullptr
+                                               ? mk_driver_options(mount_options, *driver)
+                                               : mount_options.get_options(*fstype_));
+
+    if(command.empty())
     {
-        std::string linkabspath = symlink_directory_ + "/" + label_;
-        auto file_exists = [] (const std::string &s) -> bool
-        {
-            OS::SuppressErrorsGuard g;
-            struct stat buffer;
-            return os_stat(s.c_str(), &buffer) == 0;
-        };
-
-        for(unsigned int i = 2; file_exists(linkabspath); ++i)
-            linkabspath = linkabspath + "-" + std::to_string(i);
-
-        msg_info("Creating symlink %s to %s", linkabspath.c_str(), mountpoint_.str().c_str());
-        //TODO: Create os_symlink for testing.
-        if(symlink(mountpoint_.str().c_str(), linkabspath.c_str()) != 0)
-            msg_error(errno, LOG_ERR, "Failed to create symbolic link.");
-        else
-            symlink_ = linkabspath;
+        set_eol_state_and_cleanup(UNUSABLE, true);
+        return false;
     }
 
+    state_ = MOUNTING;
     return true;
 }
 
+bool Devices::Volume::retry_mount(const Automounter::FSMountOptions &mount_options,
+                                  const Automounter::FSDriver &driver,
+                                  std::string &command)
+{
+    msg_log_assert(state_ == MOUNTING);
+
+    fs_driver_ = &driver;
+    command = mountpoint_.mk_mount_command(devname_,
+                                           mk_driver_options(mount_options, driver));
+
+    return !command.empty();
+}
+
+void Devices::Volume::finish_mount(bool succeeded)
+{
+    msg_log_assert(state_ == MOUNTING);
+
+    if(succeeded)
+    {
+        mountpoint_.set_mounted(true);
+        create_symlink();
+        state_ = MOUNTED;
+    }
+    else
+        set_eol_state_and_cleanup(UNUSABLE, true);
+}
+
+bool Devices::Volume::begin_unmount(std::string &command)
+{
+    msg_log_assert(state_ == MOUNTED);
+
+    if(!mountpoint_.is_mounted())
+    {
+        command.clear();
+        return false;
+    }
+
+    command = mountpoint_.mk_unmount_command();
+    state_ = UNMOUNTING;
+    return true;
+}
+
+void Devices::Volume::finish_unmount(bool succeeded)
+{
+    msg_log_assert(state_ == UNMOUNTING);
+
+    if(succeeded)
+    {
+        mountpoint_.set_mounted(false);
+        set_eol_state_and_cleanup(UNMOUNTED, true);
+    }
+    else
+        state_ = MOUNTED;
+}
+
 void Devices::Volume::set_mounted()
 {
     msg_log_assert(state_ == PENDING);
@@ -235,18 +325,29 @@ void Devices::Volume::set_eol_state_and_cleanup(State state,
 {
     state_ = state;
     mountpoint_.cleanup();
+    remove_symlink();
+}
 
-    if (!symlink_.empty())
+void Devices::Volume::remove_symlink()
+{
+    if(!symlink_.empty())
     {
-      msg_info("Deleting symlink %s", symlink_.c_str());
-      if (os_file_delete(symlink_.c_str())==0)
-          symlink_.clear();
-      else
-          msg_error(errno, LOG_ERR, "Failed to delete symbolic link.");
+        shared_.label_symlinks_.remove(symlink_);
+        symlink_.clear();
     }
 }
 
+void Devices::Volume::restore_symlink()
+{
+    if(state_ == MOUNTED && symlink_.empty())
+        create_symlink();
+}
+
 Devices::Volume::~Volume()
 {
+    /* the mount tool may have succeeded already, so try to unmount */
+    if(state_ == MOUNTING)
+        mountpoint_.set_mounted(true);
+
     set_eol_state_and_cleanup(UNUSABLE, true);
 }
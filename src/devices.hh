@@ -22,14 +22,17 @@
 #ifndef DEVICES_HH
 #define DEVICES_HH
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <map>
+#include <unordered_set>
 
 #include "autodir.hh"
+#include "label_symlinks.hh"
 #include "messages.h"
 
-namespace Automounter { class FSMountOptions; }
+namespace Automounter { class FSMountOptions; struct FSDriver; class ExternalTools; }
 
 namespace Devices
 {
@@ -62,6 +65,78 @@ class ID
     }
 };
 
+/*!
+ * Pool of immutable strings referenced by many objects.
+ *
+ * This is meant for values with low cardinality such as file system types and
+ * USB port names, which are repeated across many devices and volumes. Strings
+ * are never removed from the pool.
+ */
+class StringPool
+{
+  private:
+    std::unordered_set<std::string> strings_;
+
+  public:
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    explicit StringPool() {}
+
+    /*!
+     * Return reference to pooled copy of given string.
+     *
+     * The reference remains valid for the lifetime of the pool.
+     */
+    const std::string &intern(const std::string &str)
+    {
+        return *strings_.insert(str).first;
+    }
+
+    const std::string &intern(std::string &&str)
+    {
+        return *strings_.insert(std::move(str)).first;
+    }
+
+    static const std::string &empty_string()
+    {
+        static const std::string empty;
+        return empty;
+    }
+
+    size_t size() const { return strings_.size(); }
+};
+
+/*!
+ * Configuration and data shared by all devices and volumes.
+ *
+ * There is one object of this type per #Devices::AllDevices instance, and all
+ * #Devices::Device and #Devices::Volume objects refer to it instead of storing
+ * their own copies.
+ */
+class SharedData
+{
+  public:
+    const Automounter::ExternalTools &tools_;
+
+    /*!
+     * Label symlinks to mountpoints of volumes. Disabled if the directory
+     * name is empty.
+     */
+    LabelSymlinks label_symlinks_;
+
+    StringPool strings_;
+
+    SharedData(const SharedData &) = delete;
+    SharedData &operator=(const SharedData &) = delete;
+
+    explicit SharedData(const Automounter::ExternalTools &tools,
+                        const std::string &symlink_directory):
+        tools_(tools),
+        label_symlinks_(symlink_directory)
+    {}
+};
+
 class Volume;
 
 /*!
@@ -70,7 +145,7 @@ class Volume;
 class Device
 {
   public:
-    enum State
+    enum State: uint8_t
     {
         /*!
          * Device was created because a volume for it was found.
@@ -115,17 +190,13 @@ class Device
     const ID id_;
 
     /*!
-     * Original name of the symlink pointing to the block device.
-     */
-    std::string devlink_name_;
-
-    /*!
-     * Human-readable name of the device as extracted from the device.
+     * Offset of human-readable name of the device in
+     * #Devices::Device::devlink_name_.
      *
-     * Basically, this string contains the name of the symlink from
-     * Devices::Device::devlink_name_, without the full path to it. It is
-     * filled when the device is probed, i.e., it will not be available for
-     * synthesized objects.
+     * The name of the device is the name of the symlink from
+     * Devices::Device::devlink_name_, without the full path to it, so we only
+     * store its position. The offset is set when the device is probed, i.e.,
+     * the name will not be available (empty) for synthesized objects.
      *
      * Note that this is not the name of the block device as maintained by the
      * kernel, but a string that is queried from the device itself. This could
@@ -134,17 +205,7 @@ class Device
      * This string may require some post-processing before being useful for
      * displaying purposes.
      */
-    std::string device_name_;
-
-    /*!
-     * Where the mountpoints for this device will be created.
-     */
-    Automounter::Directory mountpoint_container_path_;
-
-    /*!
-     * All volumes on this device, indexed by volume index (partition number).
-     */
-    std::map<int, std::unique_ptr<Volume>> volumes_;
+    unsigned short device_name_offset_;
 
     /*!
      * Whether or not this structure was created because a volume was found.
@@ -177,43 +238,120 @@ class Device
     State state_;
 
     /*!
-     * Name of the USB port in sysfs.
+     * Original name of the symlink pointing to the block device.
+     */
+    std::string devlink_name_;
+
+    /*!
+     * Name of the USB port in sysfs, stored in #Devices::SharedData::strings_.
      */
-    std::string usb_port_;
+    const std::string *usb_port_;
+
+    /*!
+     * Where the mountpoints for this device will be created.
+     */
+    Automounter::Directory mountpoint_container_path_;
+
+    /*!
+     * All volumes on this device, indexed by volume index (partition number).
+     */
+    std::map<int, std::unique_ptr<Volume>> volumes_;
 
     /*!
      * UUID of the whole block device.
      */
     std::string uuid_;
 
+    /*!
+     * Vendor name as reported by udev, stored in
+     * #Devices::SharedData::strings_.
+     */
+    const std::string *vendor_;
+
+    /*!
+     * Model name as reported by udev, stored in
+     * #Devices::SharedData::strings_.
+     */
+    const std::string *model_;
+
+    /*!
+     * Serial number as reported by udev.
+     */
+    std::string serial_;
+
+    /*!
+     * Size of the whole block device in bytes, 0 if unknown.
+     */
+    uint64_t size_;
+
+    /*!
+     * USB hub and port chain such as "1-1.5", stored in
+     * #Devices::SharedData::strings_.
+     */
+    const std::string *usb_port_chain_;
+
+    /*!
+     * Negotiated USB speed in kbit/s, 0 if unknown.
+     */
+    uint32_t usb_speed_kbps_;
+
+    /*!
+     * USB bus number, 0 if unknown.
+     */
+    uint16_t usb_bus_;
+
+    /*!
+     * Number of ports in #Devices::Device::usb_port_chain_, 0 if unknown.
+     */
+    uint8_t usb_depth_;
+
   public:
     Device(const Device &) = delete;
     Device &operator=(const Device &) = delete;
 
-    explicit Device(ID device_id, const std::string &devlink, bool is_real):
+    explicit Device(ID device_id, const std::string &devlink, bool is_real,
+                    StringPool &strings):
         id_(device_id),
+        device_name_offset_(devlink.length()),
+        state_(SYNTHETIC),
         devlink_name_(devlink),
-        state_(SYNTHETIC)
+        usb_port_(&StringPool::empty_string()),
+        vendor_(&StringPool::empty_string()),
+        model_(&StringPool::empty_string()),
+        size_(0),
+        usb_port_chain_(&StringPool::empty_string()),
+        usb_speed_kbps_(0),
+        usb_bus_(0),
+        usb_depth_(0)
     {
         if(is_real)
-            do_probe();
+            do_probe(strings);
     }
 
     ~Device();
 
     ID::value_type get_id() const { return id_.value_; }
     const std::string &get_devlink_name() const { return devlink_name_; }
-    const std::string &get_display_name() const { return device_name_; }
-    const std::string &get_usb_port() const { return usb_port_; }
+    const char *get_display_name() const { return devlink_name_.c_str() + device_name_offset_; }
+    const std::string &get_usb_port() const { return *usb_port_; }
     const std::string &get_device_uuid() const { return uuid_; }
+    const std::string &get_vendor() const { return *vendor_; }
+    const std::string &get_model() const { return *model_; }
+    const std::string &get_serial() const { return serial_; }
+    uint64_t get_size() const { return size_; }
+    const std::string &get_usb_port_chain() const { return *usb_port_chain_; }
+    uint32_t get_usb_speed_kbps() const { return usb_speed_kbps_; }
+    uint16_t get_usb_bus() const { return usb_bus_; }
+    uint8_t get_usb_depth() const { return usb_depth_; }
 
     State get_state() const { return state_; }
 
     void accept() { state_ = OK; }
     void reject() { state_ = REJECTED; }
-    bool probe();
+    bool probe(StringPool &strings);
 
     Volume *lookup_volume_by_devname(const std::string &devname) const;
+    Volume *lookup_volume_by_index(int idx) const;
     bool add_volume(std::unique_ptr<Devices::Volume> &&volume);
     void drop_volumes();
 
@@ -226,7 +364,7 @@ class Device
     decltype(volumes_)::const_iterator end() const   { return volumes_.end(); };
 
   private:
-    bool do_probe();
+    bool do_probe(StringPool &strings);
     void cleanup_fs(bool not_expecting_failure);
 };
 
@@ -238,13 +376,16 @@ class Device
 class Volume
 {
   public:
-    enum State
+    enum State: uint8_t
     {
-        PENDING,  /*!< No attempt has yet been made to mount the volume. */
-        MOUNTED,  /*!< Volume is currently mounted. */
-        UNUSABLE, /*!< Attempted to mount the volume, but failed. */
-        REJECTED, /*! <Volume is rejected by system policies. */
-        REMOVED,  /*!< Volume is not mounted anymore (shutting down). */
+        PENDING,    /*!< No attempt has yet been made to mount the volume. */
+        MOUNTED,    /*!< Volume is currently mounted. */
+        UNUSABLE,   /*!< Attempted to mount the volume, but failed. */
+        REJECTED,   /*! <Volume is rejected by system policies. */
+        REMOVED,    /*!< Volume is not mounted anymore (shutting down). */
+        MOUNTING,   /*!< Mount tool is running in the background. */
+        UNMOUNTING, /*!< Unmount tool is running in the background. */
+        UNMOUNTED,  /*!< Volume has been unmounted on request. */
     };
 
   private:
@@ -253,6 +394,16 @@ class Volume
      */
     std::shared_ptr<Device> containing_device_;
 
+    /*!
+     * Configuration shared with all other volumes.
+     */
+    SharedData &shared_;
+
+    /*!
+     * Volume file system type, stored in #Devices::SharedData::strings_.
+     */
+    const std::string *fstype_;
+
     /*!
      * Number of the volume on its containing device.
      *
@@ -274,17 +425,12 @@ class Volume
     /*!
      * Volume label as stored on the volume.
      *
-     * This is either a human-readable name read from the volume itself, or the
-     * file system type. The label will be empty for volumes in state
-     * #Devices::Volume::PENDING or #Devices::Volume::UNUSABLE.
+     * This is a human-readable name read from the volume itself. In case the
+     * volume has no name, this string is empty and the file system type is
+     * used as label (see #Devices::Volume::get_label()).
      */
     std::string label_;
 
-    /*!
-     * Volume file system type.
-     */
-    std::string fstype_;
-
     /*!
      * Name of the block device.
      */
@@ -295,18 +441,25 @@ class Volume
      */
     const std::string uuid_;
 
+    /*!
+     * Size of the volume in bytes, 0 if unknown.
+     */
+    const uint64_t size_;
+
     /*!
      * Full path to this volume's mountpoint.
      */
     Automounter::Mountpoint mountpoint_;
 
     /*!
-     * Directory for label symlinks to mountpoints of volumes. Ignored if empty.
+     * Driver used for the current or last mount attempt, \c nullptr if the
+     * mount tool has chosen.
      */
-    const std::string symlink_directory_;
+    const Automounter::FSDriver *fs_driver_;
 
     /*!
-     * Symbolic link to mountpoint that should be removed on cleaning.
+     * Name of symbolic link to mountpoint in label symlink directory that
+     * should be removed on cleaning.
      */
     std::string symlink_;
 
@@ -315,29 +468,32 @@ class Volume
     Volume &operator=(const Volume &) = delete;
 
     explicit Volume(std::shared_ptr<Device> containing_device,
-                    int idx, const std::string &label, const std::string &uuid,
+                    int idx, std::string &&label, std::string &&uuid,
                     const std::string &fstype, const std::string &devname,
-                    const Automounter::ExternalTools &tools,
-                    const std::string& symlink_directory):
+                    uint64_t size, SharedData &shared):
         containing_device_(containing_device),
+        shared_(shared),
+        fstype_(&shared.strings_.intern(fstype)),
         index_(idx),
         state_(PENDING),
-        label_(label),
-        fstype_(fstype),
+        label_(std::move(label)),
         devname_(devname),
-        uuid_(uuid),
-        mountpoint_(tools),
-        symlink_directory_(symlink_directory)
+        uuid_(std::move(uuid)),
+        size_(size),
+        mountpoint_(shared.tools_),
+        fs_driver_(nullptr)
     {}
     ~Volume();
 
     std::shared_ptr<const Device> get_device() const { return containing_device_; }
     int get_index() const { return index_; }
     State get_state() const { return state_; }
-    const std::string &get_label() const { return label_; }
-    const std::string &get_fstype() const { return fstype_; }
+    const std::string &get_label() const { return label_.empty() ? *fstype_ : label_; }
+    const std::string &get_fstype() const { return *fstype_; }
     const std::string &get_device_name() const { return devname_; }
     const std::string &get_volume_uuid() const { return uuid_; }
+    uint64_t get_size() const { return size_; }
+    const Automounter::FSDriver *get_fs_driver() const { return fs_driver_; }
 
     void reject() { state_ = REJECTED; }
 
@@ -351,7 +507,83 @@ class Volume
     void set_removed();
     void set_unusable();
 
+    /*!
+     * Prepare for running the mount tool in the background.
+     *
+     * Volumes in states #Devices::Volume::PENDING,
+     * #Devices::Volume::UNMOUNTED, and #Devices::Volume::UNUSABLE may be
+     * mounted. The mountpoint directory is created and the volume enters
+     * state #Devices::Volume::MOUNTING.
+     *
+     * \param mount_options
+     *     Mount options for the volume's file system type.
+     *
+     * \param[out] command
+     *     Command line to be run, to be followed by a call of
+     *     #Devices::Volume::finish_mount().
+     *
+     * \returns
+     *     True on success, false if the mountpoint could not be prepared. In
+     *     the latter case, the volume is in state #Devices::Volume::UNUSABLE.
+     */
+    bool begin_mount(const Automounter::FSMountOptions &mount_options,
+                     std::string &command)
+    {
+        return begin_mount(mount_options, nullptr, command);
+    }
+
+    /*!
+     * Prepare for mounting using a specific file system driver.
+     *
+     * Like #Devices::Volume::begin_mount(), but with \p driver taking the
+     * place of the file system's default options. The driver is recorded
+     * and may be retrieved by #Devices::Volume::get_fs_driver().
+     */
+    bool begin_mount(const Automounter::FSMountOptions &mount_options,
+                     const Automounter::FSDriver *driver, std::string &command);
+
+    /*!
+     * Try another file system driver after a failed mount attempt.
+     *
+     * The volume must be in state #Devices::Volume::MOUNTING and stays in
+     * that state, the mountpoint directory is reused.
+     */
+    bool retry_mount(const Automounter::FSMountOptions &mount_options,
+                     const Automounter::FSDriver &driver, std::string &command);
+
+    /*!
+     * Enter state #Devices::Volume::MOUNTED or #Devices::Volume::UNUSABLE.
+     */
+    void finish_mount(bool succeeded);
+
+    /*!
+     * Prepare for running the unmount tool in the background.
+     *
+     * The volume must be in state #Devices::Volume::MOUNTED. It enters state
+     * #Devices::Volume::UNMOUNTING.
+     */
+    bool begin_unmount(std::string &command);
+
+    /*!
+     * Enter state #Devices::Volume::UNMOUNTED or go back to
+     * #Devices::Volume::MOUNTED if unmounting has failed.
+     *
+     * The mountpoint directory and label symlink are removed on success.
+     */
+    void finish_unmount(bool succeeded);
+
+    /*!
+     * Remove label symlink, if any.
+     */
+    void remove_symlink();
+
+    /*!
+     * Create label symlink for a mounted volume which has none.
+     */
+    void restore_symlink();
+
   private:
+    void create_symlink();
     void set_eol_state_and_cleanup(State state, bool not_expecting_failure);
 };
 
@@ -25,13 +25,25 @@
 
 #include <algorithm>
 #include <cstring>
+#include <memory>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
 
 #include "devices_os.hh"
+#include "devices_os_parsers.hh"
+#include "udev_properties.hh"
+#include "usb_topology.hh"
+#include "usb_by_path.hh"
 #include "devices_util.h"
 #include "external_tools.hh"
 #include "messages.h"
 
 static const Automounter::ExternalTools *devices_os_tools;
+static const Devices::UsbByPath *devices_os_by_path;
 
 class Tempfile
 {
@@ -86,373 +98,261 @@ class Tempfile
 
 constexpr char Tempfile::NAME_TEMPLATE[];
 
-void Devices::init(const Automounter::ExternalTools &tools)
+void Devices::init(const Automounter::ExternalTools &tools,
+                   const UsbByPath *by_path)
 {
     devices_os_tools = &tools;
+    devices_os_by_path = by_path;
 }
 
-/*
- * Example input:
- * /devices/platform/bcm2708_usb/usb1/1-1/1-1.5/1-1.5:1.0/host6/target6:0:0/6:0:0:0/block/sda
- *
- * This function attempts to find the part before the "/host6/" part and
- * returns a full, absolute path to that location. We assume that the sysfs is
- * always mounted to "/sys".
+/*!
+ * Properties of block devices fetched during the current hotplug event.
  */
-static bool parse_usb_device_id(const char *const output, size_t length,
-                                Devices::DeviceInfo &info)
+struct CachedProperties
 {
-    if(length == 0 || output[0] != '/')
-        return false;
-
-    const char *from(output + 1);
-
-    while(true)
-    {
-        auto to(std::find_if(from, output + length,
-                             [] (const char ch) { return ch == '/'; }));
-
-        if(to >= output + length)
-            return false;
-
-        static const char key[] = "host";
+    std::string devnode_;
+    Devices::UdevProperties properties_;
 
-        if(std::distance(from, to) >= ssize_t(sizeof(key)) &&
-           std::equal(from, from + sizeof(key) - 1, key) &&
-           from[sizeof(key) - 1] >= '0' && from[sizeof(key) - 1] <= '9')
-        {
-            break;
-        }
-
-        from = to + 1;
-    }
-
-    static const char sysfs_mountpoint[] = "/sys";
-
-    info.type = Devices::DeviceType::USB;
-    info.usb_port_sysfs_name = sysfs_mountpoint;
-    info.usb_port_sysfs_name.append(output, std::distance(output, from) - 1);
-
-    return true;
-}
+    explicit CachedProperties(const std::string &devnode):
+        devnode_(devnode)
+    {}
+};
 
-static size_t skip_key(const char *const str, size_t length, size_t offset)
-{
-    while(offset < length && str[offset] != '=')
-        ++offset;
+static bool is_properties_cache_enabled;
+static std::vector<CachedProperties> properties_cache;
 
-    return offset;
-}
-
-static size_t skip_value(const char *const str, size_t length, size_t offset)
+Devices::PropertiesCacheScope::PropertiesCacheScope()
 {
-    while(offset < length && str[offset] != '\n')
-        ++offset;
-
-    return offset;
+    MSG_BUG_IF(is_properties_cache_enabled, "Nested udev properties cache scope");
+    is_properties_cache_enabled = true;
 }
 
-static size_t skip_line(const char *const str, size_t length, size_t offset)
+Devices::PropertiesCacheScope::~PropertiesCacheScope()
 {
-    offset = skip_value(str, length, offset);
-
-    if(offset < length)
-        ++offset;
-
-    return offset;
-}
-
-static std::string copy_assigned_value(const char *const str, size_t length,
-                                       size_t beginning_of_value)
-{
-    const auto beyond_value = skip_value(str, length, beginning_of_value);
-
-    return beyond_value > beginning_of_value
-        ? std::string(str + beginning_of_value + 1, beyond_value - beginning_of_value - 1)
-        : std::string();
+    is_properties_cache_enabled = false;
+    properties_cache.clear();
 }
 
 /*!
- * UUID types, from worst to best.
+ * Run udevadm for given block device and parse its output.
+ *
+ * \param devnode
+ *     Name of the block device, not a symlink.
+ *
+ * \param refresh
+ *     Run udevadm even if there are cached properties for the device.
+ *
+ * \returns
+ *     Properties of the device, or \c nullptr on error. The pointer remains
+ *     valid until the next call of this function or the end of the current
+ *     #Devices::PropertiesCacheScope, whichever comes first.
  */
-enum class UUIDType
+static const Devices::UdevProperties *
+fetch_udev_properties(const std::string &devnode, bool refresh)
 {
-    NONE,
-    PARTITION_TABLE,
-    PARTITION_ENTRY,
-    FILE_SYSTEM,
-};
+    auto cached(std::find_if(properties_cache.begin(), properties_cache.end(),
+                             [&devnode] (const CachedProperties &c)
+                             {
+                                 return c.devnode_ == devnode;
+                             }));
 
-enum class ParseUUIDResult
-{
-    BAD_INPUT,
-    SKIPPED_OTHER_KEY,
-    SKIPPED_EMPTY,
-    SKIPPED_WORSE_UUID,
-    SUCCESS,
-};
-
-static ParseUUIDResult
-try_parse_part_table_uuid_or_fs_uuid(const char *const assignment, size_t length,
-                                     std::string &uuid, UUIDType &uuid_type_in_info)
-{
-    const size_t beyond_key = skip_key(assignment, length, 0);
+    if(cached != properties_cache.end() && !refresh)
+        return &cached->properties_;
 
-    if(beyond_key >= length)
-        return ParseUUIDResult::BAD_INPUT;
+    Tempfile tempfile;
+    bool retval = false;
+    Devices::UdevProperties properties;
 
-    if(strncmp(assignment, "ID_PART_TABLE_UUID", beyond_key) == 0)
+    if(tempfile.created() &&
+       os_system_formatted(msg_is_verbose(MESSAGE_LEVEL_DEBUG),
+                           "%s info --query all \"%s\" >\"%s\"",
+                           devices_os_tools->udevadm_.executable_.c_str(),
+                           devnode.c_str(), tempfile.name()) >= 0)
     {
-        /* partition table */
-        switch(uuid_type_in_info)
+        struct os_mapped_file_data output;
+
+        if(os_map_file_to_memory(&output, tempfile.name()) == 0)
         {
-          case UUIDType::NONE:
-            break;
+            properties.parse(static_cast<const char *>(output.ptr), output.length);
+            retval = true;
+        }
 
-          case UUIDType::PARTITION_TABLE:
-            MSG_BUG("Duplicate partition table UUID");
-            return ParseUUIDResult::SKIPPED_WORSE_UUID;
+        os_unmap_file(&output);
+    }
 
-          case UUIDType::PARTITION_ENTRY:
-          case UUIDType::FILE_SYSTEM:
-            return ParseUUIDResult::SKIPPED_WORSE_UUID;
-        }
+    if(!retval)
+    {
+        if(cached != properties_cache.end())
+            properties_cache.erase(cached);
 
-        uuid = copy_assigned_value(assignment, length, beyond_key);
-        if(uuid.empty())
-            return ParseUUIDResult::SKIPPED_EMPTY;
+        return nullptr;
+    }
 
-        uuid_type_in_info = UUIDType::PARTITION_TABLE;
-        return ParseUUIDResult::SUCCESS;
+    if(!is_properties_cache_enabled)
+    {
+        static Devices::UdevProperties uncached_properties;
+        uncached_properties = std::move(properties);
+        return &uncached_properties;
     }
 
-    if(strncmp(assignment, "ID_PART_ENTRY_UUID", beyond_key) == 0)
+    if(cached == properties_cache.end())
     {
-        /* partition table entry */
-        switch(uuid_type_in_info)
-        {
-          case UUIDType::NONE:
-          case UUIDType::PARTITION_TABLE:
-            break;
+        properties_cache.emplace_back(devnode);
+        cached = std::prev(properties_cache.end());
+    }
 
-          case UUIDType::PARTITION_ENTRY:
-            MSG_BUG("Duplicate partition entry UUID");
-            return ParseUUIDResult::SKIPPED_WORSE_UUID;
+    cached->properties_ = std::move(properties);
 
-          case UUIDType::FILE_SYSTEM:
-            return ParseUUIDResult::SKIPPED_WORSE_UUID;
-        }
+    return &cached->properties_;
+}
 
-        uuid = copy_assigned_value(assignment, length, beyond_key);
-        if(uuid.empty())
-            return ParseUUIDResult::SKIPPED_EMPTY;
+/*!
+ * Read short sysfs attribute.
+ *
+ * \returns
+ *     Number of bytes read, 0 on error.
+ */
+static size_t read_sysfs_attribute(const std::string &path, char *buffer, size_t size)
+{
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
 
-        uuid_type_in_info = UUIDType::PARTITION_ENTRY;
-        return ParseUUIDResult::SUCCESS;
-    }
+    if(fd < 0)
+        return 0;
 
-    if(strncmp(assignment, "ID_FS_UUID", beyond_key) == 0)
-    {
-        /* file system */
-        switch(uuid_type_in_info)
-        {
-          case UUIDType::NONE:
-          case UUIDType::PARTITION_TABLE:
-          case UUIDType::PARTITION_ENTRY:
-            break;
-
-          case UUIDType::FILE_SYSTEM:
-            MSG_BUG("Duplicate file system UUID");
-            return ParseUUIDResult::SKIPPED_WORSE_UUID;
-        }
+    ssize_t len;
 
-        uuid = copy_assigned_value(assignment, length, beyond_key);
-        if(uuid.empty())
-            return ParseUUIDResult::SKIPPED_EMPTY;
+    do
+        len = read(fd, buffer, size);
+    while(len < 0 && errno == EINTR);
 
-        uuid_type_in_info = UUIDType::FILE_SYSTEM;
-        return ParseUUIDResult::SUCCESS;
-    }
+    os_file_close(fd);
 
-    return ParseUUIDResult::SKIPPED_OTHER_KEY;
+    return len > 0 ? size_t(len) : 0;
 }
 
-static bool parse_device_info(const char *const output, size_t length,
-                              const std::string &devlink, Devices::DeviceInfo &devinfo)
+static uint64_t read_block_device_size(const Devices::UdevProperties &properties)
 {
-    size_t offset = 0;
-    UUIDType uuid_type = UUIDType::NONE;
+    const auto devpath(properties.get(Devices::UdevProperties::Key::DEVPATH));
 
-    while(offset < length)
-    {
-        const size_t start_of_line = offset;
-        offset = skip_line(output, length, offset);
-        const size_t line_length = offset - start_of_line;
+    if(devpath.empty())
+        return 0;
 
-        if(line_length < 4 ||
-           output[start_of_line + 1] != ':' || output[start_of_line + 2] != ' ')
-        {
-            if(line_length >= 2)
-                msg_error(0, LOG_NOTICE,
-                          "Skipping unexpected udevadm output for device %s",
-                          devlink.c_str());
-            continue;
-        }
+    static const char sysfs_mountpoint[] = "/sys";
+    static const char attribute[] = "/size";
 
-        if(output[start_of_line] == 'P')
-        {
-            if(!parse_usb_device_id(&output[start_of_line + 3], line_length - 3, devinfo))
-                return false;
-        }
-        else if(output[start_of_line] == 'E')
-            try_parse_part_table_uuid_or_fs_uuid(&output[start_of_line + 3],
-                                                 line_length - 3,
-                                                 devinfo.device_uuid, uuid_type);
-    }
+    std::string path;
+    path.reserve(sizeof(sysfs_mountpoint) + devpath.length() + sizeof(attribute));
+    path.append(sysfs_mountpoint);
+    path.append(devpath.data(), devpath.length());
+    path.append(attribute);
 
-    switch(uuid_type)
-    {
-      case UUIDType::NONE:
-        msg_error(0, LOG_WARNING, "Device %s has no UUID", devlink.c_str());
-        devinfo.device_uuid = "DO-NOT-STORE:";
-        std::transform(
-            devlink.begin(), devlink.end(), std::back_inserter(devinfo.device_uuid),
-            [] (const char &ch) { return ch == '/' ? '_' : ch; });
-        break;
-
-      case UUIDType::PARTITION_TABLE:
-      case UUIDType::PARTITION_ENTRY:
-      case UUIDType::FILE_SYSTEM:
-        break;
-    }
+    char buffer[32];
+    const size_t length = read_sysfs_attribute(path, buffer, sizeof(buffer));
+    uint64_t size_bytes;
 
-    return
-        !devinfo.device_uuid.empty() &&
-        devinfo.type != Devices::DeviceType::UNKNOWN;
+    return length > 0 && Devices::parse_sysfs_size(buffer, length, size_bytes)
+        ? size_bytes
+        : 0;
 }
 
-bool Devices::get_device_information(const std::string &devlink, DeviceInfo &devinfo)
+static uint32_t read_usb_speed(const std::string &usb_port)
 {
-    Tempfile tempfile;
+    /* the port refers to the USB interface, but the speed is an attribute of
+     * the USB device one level above */
+    const auto slash = usb_port.rfind('/');
 
-    if(!tempfile.created())
-        return false;
-
-    if(os_system_formatted(msg_is_verbose(MESSAGE_LEVEL_DEBUG),
-                           "%s info --query all \"%s\" >\"%s\"",
-                           devices_os_tools->udevadm_.executable_.c_str(),
-                           devlink.c_str(), tempfile.name()) < 0)
-        return false;
+    if(slash == std::string::npos || slash == 0)
+        return 0;
 
-    struct os_mapped_file_data output;
-    const bool retval =
-        (os_map_file_to_memory(&output, tempfile.name()) == 0)
-        ? parse_device_info(static_cast<const char *>(output.ptr),
-                            output.length, devlink, devinfo)
-        : false;
+    std::string path(usb_port, 0, slash);
+    path.append("/speed");
 
-    os_unmap_file(&output);
+    char buffer[16];
+    const size_t length = read_sysfs_attribute(path, buffer, sizeof(buffer));
+    uint32_t speed_kbps;
 
-    return retval;
+    return length > 0 && Devices::parse_usb_speed(buffer, length, speed_kbps)
+        ? speed_kbps
+        : 0;
 }
 
-static bool parse_volume_info(const char *const output, size_t length,
-                              const std::string &devname, Devices::VolumeInfo &volinfo)
+static Devices::UsbTopology usb_topology;
+
+/*!
+ * Determine USB port from sysfs topology of the block device.
+ *
+ * Ports already seen before are found by their \c /dev/disk/by-path
+ * location, if available, without touching sysfs.
+ *
+ * \returns
+ *     True if the port has been found, false if it needs to be determined from
+ *     udev properties.
+ */
+static bool resolve_usb_port(const std::string &devnode, Devices::DeviceInfo &devinfo)
 {
-    size_t offset = 0;
-    UUIDType uuid_type = UUIDType::NONE;
+    Devices::UsbPort port;
+    const auto *by_path = devices_os_by_path != nullptr
+        ? devices_os_by_path->find(devnode)
+        : nullptr;
 
-    while(offset < length)
+    if(by_path == nullptr ||
+       !usb_topology.find_cached(by_path->controller_, by_path->port_path_, port))
     {
-        const size_t start_of_line = offset;
-        offset = skip_line(output, length, offset);
-        const size_t line_length = offset - start_of_line;
+        struct stat buffer;
 
-        if(line_length < 4 ||
-           output[start_of_line + 1] != ':' || output[start_of_line + 2] != ' ')
-        {
-            if(line_length >= 2)
-                msg_error(0, LOG_NOTICE,
-                          "Skipping unexpected udevadm output for volume %s",
-                          devname.c_str());
-            continue;
-        }
+        if(stat(devnode.c_str(), &buffer) < 0 || !S_ISBLK(buffer.st_mode))
+            return false;
 
-        if(output[start_of_line] != 'E')
-            continue;
+        if(!usb_topology.resolve(major(buffer.st_rdev), minor(buffer.st_rdev), port))
+            return false;
+    }
 
-        const char *assignment = &output[start_of_line + 3];
-        const size_t assignment_length = line_length - 3;
+    devinfo.type = Devices::DeviceType::USB;
+    devinfo.usb_port_sysfs_name = std::move(port.interface_path_);
+    devinfo.usb_port_chain = std::move(port.chain_);
+    devinfo.usb_bus = port.bus_;
+    devinfo.usb_depth = port.depth_;
 
-        switch(try_parse_part_table_uuid_or_fs_uuid(assignment, assignment_length,
-                                                    volinfo.volume_uuid, uuid_type))
-        {
-          case ParseUUIDResult::SKIPPED_OTHER_KEY:
-            break;
-
-          case ParseUUIDResult::BAD_INPUT:
-          case ParseUUIDResult::SKIPPED_EMPTY:
-          case ParseUUIDResult::SKIPPED_WORSE_UUID:
-          case ParseUUIDResult::SUCCESS:
-            continue;
-        }
+    return true;
+}
 
-        const size_t beyond_key = skip_key(assignment, assignment_length, 0);
+bool Devices::get_device_information(const std::string &devlink, DeviceInfo &devinfo)
+{
+    std::unique_ptr<char, decltype(std::free) *>
+        devnode_mem(os_resolve_symlink(devlink.c_str()), std::free);
 
-        if(strncmp(assignment, "ID_FS_LABEL", beyond_key) == 0)
-            volinfo.label = copy_assigned_value(assignment, assignment_length, beyond_key);
-        else if(strncmp(assignment, "ID_FS_TYPE", beyond_key) == 0)
-            volinfo.fstype = copy_assigned_value(assignment, assignment_length, beyond_key);
-    }
+    const std::string devnode(devnode_mem != nullptr ? devnode_mem.get() : devlink);
 
-    switch(uuid_type)
-    {
-      case UUIDType::PARTITION_TABLE:
-        if(volinfo.idx <= 0)
-            break;
-
-        /* fall-through */
-
-      case UUIDType::NONE:
-        msg_error(0, LOG_WARNING, "Volume %s has no UUID", devname.c_str());
-        volinfo.volume_uuid = "DO-NOT-STORE:";
-        std::transform(
-            devname.begin(), devname.end(), std::back_inserter(volinfo.volume_uuid),
-            [] (const char &ch) { return ch == '/' ? '_' : ch; });
-        break;
-
-      case UUIDType::PARTITION_ENTRY:
-      case UUIDType::FILE_SYSTEM:
-        break;
-    }
+    resolve_usb_port(devnode, devinfo);
 
-    return
-        !volinfo.volume_uuid.empty() &&
-        !volinfo.fstype.empty();
+    const auto *properties = fetch_udev_properties(devnode, false);
+
+    if(properties == nullptr ||
+       !Devices::parse_device_info(*properties, devlink, devinfo))
+        return false;
+
+    devinfo.size_bytes = read_block_device_size(*properties);
+    devinfo.usb_speed_kbps = read_usb_speed(devinfo.usb_port_sysfs_name);
+
+    return true;
 }
 
 static bool try_get_volume_information(const std::string &devname, int idx,
-                                       Devices::VolumeInfo &info,
-                                       const Tempfile &tempfile)
+                                       Devices::VolumeInfo &info, bool refresh)
 {
-    if(os_system_formatted(msg_is_verbose(MESSAGE_LEVEL_DEBUG),
-                           "%s info --query all \"%s\" >\"%s\"",
-                           devices_os_tools->udevadm_.executable_.c_str(),
-                           devname.c_str(), tempfile.name()) < 0)
+    const auto *properties = fetch_udev_properties(devname, refresh);
+
+    if(properties == nullptr)
         return false;
 
     info.idx = (idx > 0) ? idx : -1;
 
-    struct os_mapped_file_data output;
-    const bool retval =
-        (os_map_file_to_memory(&output, tempfile.name()) == 0)
-        ? parse_volume_info(static_cast<const char *>(output.ptr),
-                            output.length, devname, info)
-        : false;
+    if(!Devices::parse_volume_info(*properties, devname, info))
+        return false;
 
-    os_unmap_file(&output);
+    info.size_bytes = read_block_device_size(*properties);
 
-    return retval;
+    return true;
 }
 
 bool Devices::get_volume_information(const std::string &devname, VolumeInfo &info)
@@ -464,16 +364,11 @@ bool Devices::get_volume_information(const std::string &devname, VolumeInfo &inf
     if(idx < 0)
         return false;
 
-    Tempfile tempfile;
-
-    if(!tempfile.created())
-        return false;
-
     static const int maximum_retries = 3;
 
     for(int i = 0; i < maximum_retries; ++i)
     {
-        if(try_get_volume_information(devname, idx, info, tempfile))
+        if(try_get_volume_information(devname, idx, info, i > 0))
             return true;
 
         if(i + 1 < maximum_retries)
@@ -508,88 +403,15 @@ static bool get_device_and_volume_devnames(const char *path, std::string &dev_de
             tempfile.name()) < 0)
         return false;
 
+    bool retval = false;
+
     struct os_mapped_file_data output;
     if(os_map_file_to_memory(&output, tempfile.name()) == 0)
-        dev_device.assign(static_cast<const char *>(output.ptr), output.length);
+        retval = Devices::parse_findmnt_source(static_cast<const char *>(output.ptr),
+                                               output.length, dev_device, vol_device);
     os_unmap_file(&output);
 
-    while(!dev_device.empty() && dev_device.back() == '\n')
-        dev_device.pop_back();
-
-    if(dev_device.empty())
-        return false;
-
-    vol_device = dev_device;
-
-    while(!dev_device.empty() && dev_device.back() >= '0' && dev_device.back() <= '9')
-        dev_device.pop_back();
-
-    return !dev_device.empty();
-}
-
-static bool skip_token(const char *line, size_t len, size_t &offset, size_t *end_of_token)
-{
-    while(offset < len && line[offset] != ' ' && line[offset] != '\n')
-        ++offset;
-
-    if(end_of_token != nullptr)
-        *end_of_token = offset;
-
-    if(offset >= len)
-        return true;
-
-    if(line[offset] == '\n')
-    {
-        ++offset;
-        return true;
-    }
-
-    return false;
-}
-
-static std::string parse_device_link_from_line(const char *line, size_t len, size_t &offset)
-{
-    while(offset < len)
-    {
-        while(offset < len && line[offset] == ' ')
-            ++offset;
-
-        static const std::string prefix = "/dev/disk/by-id/";
-        const auto remainder = len - offset;
-        if(remainder < prefix.length())
-            break;
-
-        const auto start_of_token = offset;
-        size_t i;
-        for(i = 0; prefix[i] == line[offset]; ++i, ++offset)
-            ;
-
-        if(i != prefix.length())
-        {
-            /* not found, skip token and return if at EOL or EOF*/
-            if(skip_token(line, len, offset, nullptr))
-                break;
-
-            continue;
-        }
-
-        /* found */
-        size_t end_of_token;
-        if(!skip_token(line, len, offset, &end_of_token))
-        {
-            /* skip until EOL or EOF */
-            do
-            {
-                while(offset < len && line[offset] == ' ')
-                    ++offset;
-            }
-            while(!skip_token(line, len, offset, nullptr));
-        }
-
-        return std::string(line + start_of_token, line + end_of_token);
-    }
-
-    return "";
+    return retval;
 }
 
 static bool get_device_links(const std::string &dev_device, const std::string &vol_device,
@@ -610,10 +432,9 @@ static bool get_device_links(const std::string &dev_device, const std::string &v
     if(os_map_file_to_memory(&output, tempfile.name()) == 0)
     {
         size_t offset = 0;
-        result.first = parse_device_link_from_line(static_cast<const char *>(output.ptr),
-                                                   output.length, offset);
-        result.second = parse_device_link_from_line(static_cast<const char *>(output.ptr),
-                                                    output.length, offset);
+        const auto *const ptr = static_cast<const char *>(output.ptr);
+        result.first = Devices::parse_device_link_from_line(ptr, output.length, offset);
+        result.second = Devices::parse_device_link_from_line(ptr, output.length, offset);
     }
     os_unmap_file(&output);
 
@@ -24,12 +24,15 @@
 
 #include <string>
 #include <utility>
+#include <cstdint>
 
 namespace Automounter { class ExternalTools; }
 
 namespace Devices
 {
 
+class UsbByPath;
+
 enum class DeviceType
 {
     UNKNOWN,
@@ -41,18 +44,36 @@ struct DeviceInfo
     DeviceType type;
     std::string device_uuid;
     std::string usb_port_sysfs_name;
+    std::string usb_port_chain;
+    std::string vendor;
+    std::string model;
+    std::string serial;
+    uint64_t size_bytes;
+    uint32_t usb_speed_kbps;
+    uint16_t usb_bus;
+    uint8_t usb_depth;
 
     DeviceInfo(const DeviceInfo &) = delete;
     DeviceInfo(DeviceInfo &&) = default;
     DeviceInfo &operator=(const DeviceInfo &) = default;
     DeviceInfo &operator=(DeviceInfo &&) = default;
 
-    DeviceInfo(): type(DeviceType::UNKNOWN) {}
+    DeviceInfo():
+        type(DeviceType::UNKNOWN),
+        size_bytes(0),
+        usb_speed_kbps(0),
+        usb_bus(0),
+        usb_depth(0)
+    {}
 
     explicit DeviceInfo(std::string &&uuid, std::string &&name):
         type(DeviceType::USB),
         device_uuid(std::move(uuid)),
-        usb_port_sysfs_name(std::move(name))
+        usb_port_sysfs_name(std::move(name)),
+        size_bytes(0),
+        usb_speed_kbps(0),
+        usb_bus(0),
+        usb_depth(0)
     {}
 };
 
@@ -62,27 +83,56 @@ struct VolumeInfo
     std::string volume_uuid;
     std::string label;
     std::string fstype;
+    uint64_t size_bytes;
 
     VolumeInfo(const VolumeInfo &) = delete;
     VolumeInfo(VolumeInfo &&) = default;
     VolumeInfo &operator=(const VolumeInfo &) = default;
     VolumeInfo &operator=(VolumeInfo &&) = default;
 
-    explicit VolumeInfo(): idx(-1) {}
+    explicit VolumeInfo(): idx(-1), size_bytes(0) {}
 
     explicit VolumeInfo(int vol_idx, std::string &&uuid,
                         std::string &&vol_label, std::string &&vol_fstype):
         idx(vol_idx),
         volume_uuid(std::move(uuid)),
         label(std::move(vol_label)),
-        fstype(std::move(vol_fstype))
+        fstype(std::move(vol_fstype)),
+        size_bytes(0)
     {}
 };
 
 /*!
  * Pass tool configuration.
+ *
+ * \param tools
+ *     External tools used for probing devices.
+ *
+ * \param by_path
+ *     Optional map of block devices to USB locations, maintained by the
+ *     caller from \c /dev/disk/by-path. If it knows a block device, its USB
+ *     port is taken from cached sysfs topology without any system calls.
  */
-void init(const Automounter::ExternalTools &tools);
+void init(const Automounter::ExternalTools &tools,
+          const UsbByPath *by_path = nullptr);
+
+/*!
+ * Cache udev properties for the duration of a hotplug event.
+ *
+ * While an object of this class exists, udevadm is run only once per block
+ * device, so that device and volume information for whole-disk volumes are
+ * taken from the same output. The cache is cleared when the object is
+ * destroyed.
+ */
+class PropertiesCacheScope
+{
+  public:
+    PropertiesCacheScope(const PropertiesCacheScope &) = delete;
+    PropertiesCacheScope &operator=(const PropertiesCacheScope &) = delete;
+
+    explicit PropertiesCacheScope();
+    ~PropertiesCacheScope();
+};
 
 /*!
  * Get device information if possible.
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+
+#include "devices_os_parsers.hh"
+#include "udev_properties.hh"
+#include "usb_topology.hh"
+#include "messages.h"
+
+bool Devices::parse_usb_device_id(const char *const output, size_t length,
+                                  DeviceInfo &info)
+{
+    if(length == 0 || output[0] != '/')
+        return false;
+
+    const char *from(output + 1);
+
+    while(true)
+    {
+        auto to(std::find_if(from, output + length,
+                             [] (const char ch) { return ch == '/'; }));
+
+        if(to >= output + length)
+            return false;
+
+        static const char key[] = "host";
+
+        if(std::distance(from, to) >= ssize_t(sizeof(key)) &&
+           std::equal(from, from + sizeof(key) - 1, key) &&
+           from[sizeof(key) - 1] >= '0' && from[sizeof(key) - 1] <= '9')
+        {
+            break;
+        }
+
+        from = to + 1;
+    }
+
+    static const char sysfs_mountpoint[] = "/sys";
+
+    info.type = Devices::DeviceType::USB;
+    info.usb_port_sysfs_name = sysfs_mountpoint;
+    info.usb_port_sysfs_name.append(output, std::distance(output, from) - 1);
+
+    return true;
+}
+
+static std::string mk_do_not_store_uuid(const std::string &name)
+{
+    static const char prefix[] = "DO-NOT-STORE:";
+
+    std::string result;
+    result.reserve(sizeof(prefix) - 1 + name.length());
+    result.append(prefix, sizeof(prefix) - 1);
+    result.append(name);
+    std::replace(result.begin() + sizeof(prefix) - 1, result.end(), '/', '_');
+
+    return result;
+}
+
+static inline void assign_value(std::string &dest,
+                                const Devices::UdevProperties::Value &value)
+{
+    dest.assign(value.data(), value.length());
+}
+
+bool Devices::parse_device_info(const UdevProperties &properties,
+                                const std::string &devlink, DeviceInfo &devinfo)
+{
+    if(properties.get_number_of_unexpected_lines() > 0)
+        msg_error(0, LOG_NOTICE,
+                  "Skipping unexpected udevadm output for device %s",
+                  devlink.c_str());
+
+    if(devinfo.type == DeviceType::UNKNOWN)
+    {
+        const auto devpath(properties.get(Devices::UdevProperties::Key::DEVPATH));
+
+        if(!parse_usb_device_id(devpath.data(), devpath.length(), devinfo))
+            return false;
+
+        UsbPort port;
+
+        if(parse_usb_topology(devinfo.usb_port_sysfs_name.c_str(),
+                              devinfo.usb_port_sysfs_name.length(), port))
+        {
+            devinfo.usb_port_chain = std::move(port.chain_);
+            devinfo.usb_bus = port.bus_;
+            devinfo.usb_depth = port.depth_;
+        }
+    }
+
+    assign_value(devinfo.device_uuid, properties.get_best_uuid(true));
+    assign_value(devinfo.vendor, properties.get(Devices::UdevProperties::Key::VENDOR));
+    assign_value(devinfo.model, properties.get(Devices::UdevProperties::Key::MODEL));
+    assign_value(devinfo.serial,
+                 properties.get(Devices::UdevProperties::Key::SERIAL_SHORT));
+
+    if(devinfo.device_uuid.empty())
+    {
+        msg_error(0, LOG_WARNING, "Device %s has no UUID", devlink.c_str());
+        devinfo.device_uuid = mk_do_not_store_uuid(devlink);
+    }
+
+    return devinfo.type != Devices::DeviceType::UNKNOWN;
+}
+
+bool Devices::parse_volume_info(const UdevProperties &properties,
+                                const std::string &devname, VolumeInfo &volinfo)
+{
+    if(properties.get_number_of_unexpected_lines() > 0)
+        msg_error(0, LOG_NOTICE,
+                  "Skipping unexpected udevadm output for volume %s",
+                  devname.c_str());
+
+    const auto fstype(properties.get(Devices::UdevProperties::Key::FS_TYPE));
+
+    if(fstype.empty())
+        return false;
+
+    assign_value(volinfo.volume_uuid, properties.get_best_uuid(volinfo.idx <= 0));
+
+    if(volinfo.volume_uuid.empty())
+    {
+        msg_error(0, LOG_WARNING, "Volume %s has no UUID", devname.c_str());
+        volinfo.volume_uuid = mk_do_not_store_uuid(devname);
+    }
+
+    assign_value(volinfo.label,
+                 properties.get(Devices::UdevProperties::Key::FS_LABEL));
+    assign_value(volinfo.fstype, fstype);
+
+    return true;
+}
+
+bool Devices::parse_sysfs_size(const char *output, size_t length,
+                               uint64_t &size_bytes)
+{
+    uint64_t sectors = 0;
+    size_t i = 0;
+
+    for(/* nothing */; i < length && output[i] >= '0' && output[i] <= '9'; ++i)
+        sectors = sectors * 10 + (output[i] - '0');
+
+    if(i == 0 || (i < length && output[i] != '\n'))
+        return false;
+
+    /* the kernel always counts in 512 byte units here */
+    size_bytes = sectors * 512;
+
+    return true;
+}
+
+bool Devices::parse_usb_speed(const char *output, size_t length,
+                              uint32_t &speed_kbps)
+{
+    uint32_t mbps = 0;
+    uint32_t fraction_kbps = 0;
+    size_t i = 0;
+
+    for(/* nothing */; i < length && output[i] >= '0' && output[i] <= '9'; ++i)
+        mbps = mbps * 10 + (output[i] - '0');
+
+    if(i == 0)
+        return false;
+
+    if(i < length && output[i] == '.')
+    {
+        uint32_t scale = 100;
+
+        for(++i; i < length && output[i] >= '0' && output[i] <= '9'; ++i)
+        {
+            fraction_kbps += (output[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    if(i < length && output[i] != '\n')
+        return false;
+
+    if(mbps == 0 && fraction_kbps == 0)
+        return false;
+
+    speed_kbps = mbps * 1000 + fraction_kbps;
+
+    return true;
+}
+
+bool Devices::parse_findmnt_source(const char *output, size_t length,
+                                   std::string &dev_device, std::string &vol_device)
+{
+    while(length > 0 && output[length - 1] == '\n')
+        --length;
+
+    if(length == 0)
+        return false;
+
+    size_t dev_length = length;
+
+    while(dev_length > 0 && output[dev_length - 1] >= '0' && output[dev_length - 1] <= '9')
+        --dev_length;
+
+    if(dev_length == 0)
+        return false;
+
+    vol_device.assign(output, length);
+    dev_device.assign(output, dev_length);
+
+    return true;
+}
+
+static bool skip_token(const char *line, size_t len, size_t &offset, size_t *end_of_token)
+{
+    while(offset < len && line[offset] != ' ' && line[offset] != '\n')
+        ++offset;
+
+    if(end_of_token != nullptr)
+        *end_of_token = offset;
+
+    if(offset >= len)
+        return true;
+
+    if(line[offset] == '\n')
+    {
+        ++offset;
+        return true;
+    }
+
+    return false;
+}
+
+std::string Devices::parse_device_link_from_line(const char *line, size_t len,
+                                                 size_t &offset)
+{
+    while(offset < len)
+    {
+        while(offset < len && line[offset] == ' ')
+            ++offset;
+
+        static const std::string prefix = "/dev/disk/by-id/";
+        const auto remainder = len - offset;
+        if(remainder < prefix.length())
+            break;
+
+        const auto start_of_token = offset;
+        size_t i;
+        for(i = 0; prefix[i] == line[offset]; ++i, ++offset)
+            ;
+
+        if(i != prefix.length())
+        {
+            /* not found, skip token and return if at EOL or EOF*/
+            if(skip_token(line, len, offset, nullptr))
+                break;
+
+            continue;
+        }
+
+        /* found */
+        size_t end_of_token;
+        if(!skip_token(line, len, offset, &end_of_token))
+        {
+            /* skip until EOL or EOF */
+            do
+            {
+                while(offset < len && line[offset] == ' ')
+                    ++offset;
+            }
+            while(!skip_token(line, len, offset, nullptr));
+        }
+
+        return std::string(line + start_of_token, line + end_of_token);
+    }
+
+    return "";
+}
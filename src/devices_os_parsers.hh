@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef DEVICES_OS_PARSERS_HH
+#define DEVICES_OS_PARSERS_HH
+
+#include "devices_os.hh"
+
+/*!
+ * \file
+ * Parsers for the output of external tools.
+ *
+ * These are used by the functions in devices_os.cc after they have run the
+ * tools. They are kept separate so that they can be tested and measured
+ * without running any tools.
+ */
+
+namespace Devices
+{
+
+class UdevProperties;
+
+/*!
+ * Determine USB port from kernel device path.
+ *
+ * Example input:
+ * /devices/platform/bcm2708_usb/usb1/1-1/1-1.5/1-1.5:1.0/host6/target6:0:0/6:0:0:0/block/sda
+ *
+ * This function attempts to find the part before the "/host6/" part and
+ * stores a full, absolute path to that location in \p info. We assume that
+ * the sysfs is always mounted to "/sys".
+ */
+bool parse_usb_device_id(const char *output, size_t length, DeviceInfo &info);
+
+/*!
+ * Fill in device information from udev properties of a whole disk.
+ *
+ * The USB port is taken from the kernel device path only if the device type
+ * in \p devinfo is still #Devices::DeviceType::UNKNOWN, i.e., if it has not
+ * been determined by other means before.
+ */
+bool parse_device_info(const UdevProperties &properties,
+                       const std::string &devlink, DeviceInfo &devinfo);
+
+/*!
+ * Fill in volume information from udev properties of a block device.
+ *
+ * The volume index must have been set in \p volinfo already.
+ */
+bool parse_volume_info(const UdevProperties &properties,
+                       const std::string &devname, VolumeInfo &volinfo);
+
+/*!
+ * Parse size of a block device as read from its \c size attribute in sysfs.
+ *
+ * \param output, length
+ *     Content of the sysfs attribute, a number of 512 byte sectors.
+ *
+ * \param[out] size_bytes
+ *     Size of the block device in bytes.
+ *
+ * \returns
+ *     True on success, false if the content is not a number.
+ */
+bool parse_sysfs_size(const char *output, size_t length, uint64_t &size_bytes);
+
+/*!
+ * Parse negotiated speed of a USB device as read from its \c speed attribute
+ * in sysfs.
+ *
+ * \param output, length
+ *     Content of the sysfs attribute in Mbit/s, such as "480" or "1.5".
+ *
+ * \param[out] speed_kbps
+ *     Speed in kbit/s.
+ *
+ * \returns
+ *     True on success, false if the content is not a positive number.
+ */
+bool parse_usb_speed(const char *output, size_t length, uint32_t &speed_kbps);
+
+/*!
+ * Extract block device names from <tt>findmnt --output SOURCE</tt> output.
+ *
+ * \param output, length
+ *     Output of findmnt.
+ *
+ * \param[out] dev_device
+ *     Name of the whole disk, i.e., the volume name without partition number.
+ *
+ * \param[out] vol_device
+ *     Name of the mounted block device.
+ *
+ * \returns
+ *     True on success, false if the output is unusable. The output parameters
+ *     are not touched in case of failure.
+ */
+bool parse_findmnt_source(const char *output, size_t length,
+                          std::string &dev_device, std::string &vol_device);
+
+/*!
+ * Find next \c /dev/disk/by-id/ link in output of
+ * <tt>udevadm info --query symlink --root</tt>.
+ *
+ * \param line, len
+ *     Output of udevadm.
+ *
+ * \param[in,out] offset
+ *     Where to start searching. Points to the beginning of the next line
+ *     when the function returns.
+ *
+ * \returns
+ *     The link, or an empty string if there is no link in the current line.
+ */
+std::string parse_device_link_from_line(const char *line, size_t len,
+                                        size_t &offset);
+
+}
+
+#endif /* !DEVICES_OS_PARSERS_HH */
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include "event_record.hh"
+
+constexpr size_t Automounter::EventRecord::MAX_STRING_LENGTH;
+
+void Automounter::EventRecord::append(const void *src, size_t length)
+{
+    const auto *p = static_cast<const uint8_t *>(src);
+    buffer_.insert(buffer_.end(), p, p + length);
+
+    /* at most 8 strings of maximum length, so this cannot overflow */
+    const uint16_t total = buffer_.size();
+    std::copy(reinterpret_cast<const uint8_t *>(&total),
+              reinterpret_cast<const uint8_t *>(&total) + sizeof(total),
+              buffer_.begin());
+}
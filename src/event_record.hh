@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef EVENT_RECORD_HH
+#define EVENT_RECORD_HH
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include "mounta_events.h"
+#pragma GCC diagnostic pop
+
+namespace Automounter
+{
+
+/*!
+ * Build a record for the event socket as described in mounta_events.h.
+ *
+ * Fields are appended in the order prescribed for the record type. The
+ * length in the header is kept up to date, so the record may be sent at any
+ * time.
+ */
+class EventRecord
+{
+  public:
+    /*! Strings are truncated to this length so that records always fit. */
+    static constexpr size_t MAX_STRING_LENGTH = 1024;
+
+  private:
+    std::vector<uint8_t> buffer_;
+
+  public:
+    EventRecord(const EventRecord &) = delete;
+    EventRecord(EventRecord &&) = default;
+    EventRecord &operator=(const EventRecord &) = delete;
+    EventRecord &operator=(EventRecord &&) = default;
+
+    explicit EventRecord(uint8_t type, uint16_t device_id, uint64_t generation)
+    {
+        struct mounta_event_header header {};
+        header.type = type;
+        header.version = MOUNTA_EVENT_VERSION;
+        header.device_id = device_id;
+        header.generation = generation;
+
+        buffer_.reserve(256);
+        append(&header, sizeof(header));
+    }
+
+    template <typename T>
+    EventRecord &put_fixed(const T &fixed)
+    {
+        append(&fixed, sizeof(fixed));
+        return *this;
+    }
+
+    EventRecord &put_string(const char *str, size_t length)
+    {
+        const uint16_t len = std::min(length, MAX_STRING_LENGTH);
+        append(&len, sizeof(len));
+        append(str, len);
+        return *this;
+    }
+
+    EventRecord &put_string(const std::string &str)
+    {
+        return put_string(str.c_str(), str.length());
+    }
+
+    const uint8_t *data() const { return buffer_.data(); }
+    size_t size() const { return buffer_.size(); }
+
+  private:
+    void append(const void *src, size_t length);
+};
+
+}
+
+#endif /* !EVENT_RECORD_HH */
@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <glib-unix.h>
+
+#include "event_socket.hh"
+#include "event_record.hh"
+#include "automounter.hh"
+#include "messages.h"
+
+struct EventSocketData
+{
+    static constexpr size_t MAX_CLIENTS = 16;
+
+    struct Client
+    {
+        int fd_;
+        guint source_id_;
+    };
+
+    std::string path_;
+    int fd_;
+    guint source_id_;
+    const Automounter::Core *am_;
+    std::vector<Client> clients_;
+
+    explicit EventSocketData():
+        fd_(-1),
+        source_id_(0),
+        am_(nullptr)
+    {}
+};
+
+static EventSocketData event_socket_data;
+
+static Automounter::EventRecord
+mk_device_record(uint8_t type, const Devices::Device &dev, uint64_t generation)
+{
+    Automounter::EventRecord rec(type, dev.get_id(), generation);
+
+    if(type == MOUNTA_EVENT_DEVICE_ADDED)
+    {
+        struct mounta_event_device fixed {};
+        fixed.usb_bus = dev.get_usb_bus();
+        fixed.usb_depth = dev.get_usb_depth();
+        fixed.usb_speed_kbps = dev.get_usb_speed_kbps();
+        fixed.size_bytes = dev.get_size();
+
+        rec.put_fixed(fixed)
+           .put_string(dev.get_display_name())
+           .put_string(dev.get_device_uuid())
+           .put_string(dev.get_working_directory().str())
+           .put_string(dev.get_usb_port())
+           .put_string(dev.get_usb_port_chain())
+           .put_string(dev.get_vendor())
+           .put_string(dev.get_model())
+           .put_string(dev.get_serial());
+    }
+    else
+        rec.put_string(dev.get_device_uuid())
+           .put_string(dev.get_working_directory().str());
+
+    return rec;
+}
+
+static Automounter::EventRecord
+mk_volume_record(uint8_t type, const Devices::Volume &vol, uint64_t generation)
+{
+    Automounter::EventRecord rec(type,
+                                 vol.get_device()->get_id(), generation);
+
+    struct mounta_event_volume fixed {};
+    fixed.index = vol.get_index() >= 0 ? vol.get_index() : UINT_MAX;
+    fixed.size_bytes = vol.get_size();
+
+    rec.put_fixed(fixed)
+       .put_string(vol.get_label())
+       .put_string(vol.get_mountpoint_name())
+       .put_string(vol.get_volume_uuid())
+       .put_string(vol.get_fstype());
+
+    return rec;
+}
+
+static void drop_client(int fd)
+{
+    auto &clients(event_socket_data.clients_);
+    auto it = std::find_if(clients.begin(), clients.end(),
+                           [fd] (const EventSocketData::Client &c) { return c.fd_ == fd; });
+
+    if(it == clients.end())
+        return;
+
+    g_source_remove(it->source_id_);
+    close(it->fd_);
+    clients.erase(it);
+}
+
+/*!
+ * Send record to a client, never blocking.
+ *
+ * Clients which do not read fast enough are disconnected because we do not
+ * queue records. They reconnect and get a fresh state dump.
+ */
+static bool send_record(int fd, const Automounter::EventRecord &rec)
+{
+    if(send(fd, rec.data(), rec.size(), MSG_NOSIGNAL | MSG_DONTWAIT) ==
+       ssize_t(rec.size()))
+        return true;
+
+    if(errno == EAGAIN || errno == EWOULDBLOCK)
+        msg_error(0, LOG_NOTICE, "Event socket client too slow, disconnecting");
+    else if(errno != EPIPE && errno != ECONNRESET)
+        msg_error(errno, LOG_NOTICE, "Failed sending to event socket client");
+
+    return false;
+}
+
+static void send_to_all(const Automounter::EventRecord &rec)
+{
+    std::vector<int> failed;
+
+    for(const auto &c : event_socket_data.clients_)
+        if(!send_record(c.fd_, rec))
+            failed.push_back(c.fd_);
+
+    for(const int fd : failed)
+        drop_client(fd);
+}
+
+static bool send_dump(int fd, const Automounter::Core &am)
+{
+    const uint64_t generation = am.get_generation();
+
+    for(const auto &device : am)
+    {
+        if(device.get_state() != Devices::Device::OK ||
+           !device.get_working_directory().exists(Automounter::FailIf::NOT_FOUND))
+            continue;
+
+        if(!send_record(fd, mk_device_record(MOUNTA_EVENT_DEVICE_ADDED,
+                                             device, generation)))
+            return false;
+
+        for(const auto &volume_iter : device)
+        {
+            const auto *volume = volume_iter.second.get();
+
+            if(volume != nullptr && volume->get_state() == Devices::Volume::MOUNTED &&
+               !send_record(fd, mk_volume_record(MOUNTA_EVENT_VOLUME_ADDED,
+                                                 *volume, generation)))
+                return false;
+        }
+    }
+
+    return send_record(fd, Automounter::EventRecord(MOUNTA_EVENT_DUMP_COMPLETE,
+                                                    0, generation));
+}
+
+static gboolean handle_client_event(gint fd, GIOCondition condition,
+                                    gpointer user_data)
+{
+    /* clients are not supposed to send anything, so we only detect hangups
+     * and throw away anything else */
+    uint8_t buffer[64];
+    const ssize_t len = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+    if(len > 0 || (len < 0 && (errno == EAGAIN || errno == EINTR)))
+        return G_SOURCE_CONTINUE;
+
+    /* source is removed by returning G_SOURCE_REMOVE */
+    auto &clients(event_socket_data.clients_);
+    auto it = std::find_if(clients.begin(), clients.end(),
+                           [fd] (const EventSocketData::Client &c) { return c.fd_ == fd; });
+
+    if(it != clients.end())
+    {
+        close(it->fd_);
+        clients.erase(it);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean handle_new_client(gint fd, GIOCondition condition,
+                                  gpointer user_data)
+{
+    const int client_fd = accept4(fd, nullptr, nullptr,
+                                  SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if(client_fd < 0)
+    {
+        if(errno != EAGAIN && errno != EINTR && errno != ECONNABORTED)
+            msg_error(errno, LOG_ERR, "Failed accepting event socket client");
+
+        return G_SOURCE_CONTINUE;
+    }
+
+    if(event_socket_data.clients_.size() >= EventSocketData::MAX_CLIENTS)
+    {
+        msg_error(0, LOG_NOTICE, "Too many event socket clients");
+        close(client_fd);
+        return G_SOURCE_CONTINUE;
+    }
+
+    if(!send_dump(client_fd, *event_socket_data.am_))
+    {
+        close(client_fd);
+        return G_SOURCE_CONTINUE;
+    }
+
+    const guint source_id =
+        g_unix_fd_add(client_fd, GIOCondition(G_IO_IN | G_IO_HUP | G_IO_ERR),
+                      handle_client_event, nullptr);
+
+    if(source_id == 0)
+    {
+        close(client_fd);
+        return G_SOURCE_CONTINUE;
+    }
+
+    event_socket_data.clients_.push_back(EventSocketData::Client{client_fd, source_id});
+
+    return G_SOURCE_CONTINUE;
+}
+
+bool event_socket_setup(const char *path, const Automounter::Core &am)
+{
+    auto &data(event_socket_data);
+
+    if(data.fd_ >= 0)
+    {
+        MSG_BUG("Event socket set up twice");
+        return true;
+    }
+
+    struct sockaddr_un addr {};
+    addr.sun_family = AF_UNIX;
+
+    if(strlen(path) >= sizeof(addr.sun_path))
+    {
+        msg_error(0, LOG_ERR, "Event socket path too long: \"%s\"", path);
+        return false;
+    }
+
+    strcpy(addr.sun_path, path);
+
+    const int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if(fd < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed creating event socket");
+        return false;
+    }
+
+    /* remove stale socket left by previous instance */
+    unlink(path);
+
+    if(bind(fd, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr)) < 0 ||
+       listen(fd, 4) < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed listening on event socket \"%s\"", path);
+        close(fd);
+        return false;
+    }
+
+    data.source_id_ = g_unix_fd_add(fd, G_IO_IN, handle_new_client, nullptr);
+
+    if(data.source_id_ == 0)
+    {
+        close(fd);
+        unlink(path);
+        return false;
+    }
+
+    data.path_ = path;
+    data.fd_ = fd;
+    data.am_ = &am;
+
+    msg_info("Listening on event socket \"%s\"", path);
+
+    return true;
+}
+
+void event_socket_shutdown()
+{
+    auto &data(event_socket_data);
+
+    if(data.fd_ < 0)
+        return;
+
+    while(!data.clients_.empty())
+        drop_client(data.clients_.back().fd_);
+
+    g_source_remove(data.source_id_);
+    close(data.fd_);
+    unlink(data.path_.c_str());
+
+    data.fd_ = -1;
+    data.source_id_ = 0;
+    data.am_ = nullptr;
+}
+
+void event_socket_device_added(const Devices::Device &dev, uint64_t generation)
+{
+    if(!event_socket_data.clients_.empty())
+        send_to_all(mk_device_record(MOUNTA_EVENT_DEVICE_ADDED, dev, generation));
+}
+
+void event_socket_volume_added(const Devices::Volume &vol, uint64_t generation)
+{
+    if(!event_socket_data.clients_.empty())
+        send_to_all(mk_volume_record(MOUNTA_EVENT_VOLUME_ADDED, vol, generation));
+}
+
+void event_socket_device_will_be_removed(const Devices::Device &dev,
+                                         uint64_t generation)
+{
+    if(!event_socket_data.clients_.empty())
+        send_to_all(mk_device_record(MOUNTA_EVENT_DEVICE_WILL_BE_REMOVED,
+                                     dev, generation));
+}
+
+void event_socket_device_removed(const Devices::Device &dev, uint64_t generation)
+{
+    if(!event_socket_data.clients_.empty())
+        send_to_all(mk_device_record(MOUNTA_EVENT_DEVICE_REMOVED, dev, generation));
+}
+
+void event_socket_volume_removed(const Devices::Volume &vol, uint64_t generation)
+{
+    if(!event_socket_data.clients_.empty())
+        send_to_all(mk_volume_record(MOUNTA_EVENT_VOLUME_REMOVED, vol, generation));
+}
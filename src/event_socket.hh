@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef EVENT_SOCKET_HH
+#define EVENT_SOCKET_HH
+
+#include <cstdint>
+
+namespace Automounter { class Core; }
+namespace Devices { class Device; class Volume; }
+
+/*!
+ * Listen for event stream clients on a \c SOCK_SEQPACKET Unix socket.
+ *
+ * New clients receive a dump of the current state taken from \p am, see
+ * mounta_events.h for the record format.
+ *
+ * \returns
+ *     True on success, false on error. The daemon may continue to run
+ *     without the event socket.
+ */
+bool event_socket_setup(const char *path, const Automounter::Core &am);
+
+/*!
+ * Stop listening, disconnect all clients, and remove the socket.
+ */
+void event_socket_shutdown();
+
+/*!
+ * \name Send records to all connected clients
+ *
+ * These functions are called where the corresponding D-Bus signals are
+ * emitted. They do nothing if the event socket has not been set up.
+ */
+/*!@{*/
+void event_socket_device_added(const Devices::Device &dev, uint64_t generation);
+void event_socket_volume_added(const Devices::Volume &vol, uint64_t generation);
+void event_socket_device_will_be_removed(const Devices::Device &dev,
+                                         uint64_t generation);
+void event_socket_device_removed(const Devices::Device &dev, uint64_t generation);
+void event_socket_volume_removed(const Devices::Volume &vol, uint64_t generation);
+/*!@}*/
+
+#endif /* !EVENT_SOCKET_HH */
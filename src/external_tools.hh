@@ -33,12 +33,13 @@ class ExternalTools
     class Command
     {
       public:
-        const std::string executable_;
-        const std::string options_;
+        std::string executable_;
+        std::string options_;
 
         Command(const Command &) = delete;
         Command &operator=(const Command &) = delete;
         Command(Command &&) = default;
+        Command &operator=(Command &&) = default;
 
         explicit Command(const char *executable, const char *options):
             executable_(executable),
@@ -46,23 +47,39 @@ class ExternalTools
         {}
     };
 
-    const Command mount_;
-    const Command unmount_;
-    const Command mountpoint_;
-    const Command udevadm_;
-    const Command findmnt_;
+    Command mount_;
+    Command unmount_;
+    Command mountpoint_;
+    Command udevadm_;
+    Command findmnt_;
+
+    /*!
+     * Writes its standard input to the file given as argument, for switching
+     * off USB ports through sysfs.
+     */
+    Command power_off_;
 
     ExternalTools(const ExternalTools &) = delete;
     ExternalTools &operator=(const ExternalTools &) = delete;
+    ExternalTools(ExternalTools &&) = default;
+
+    /*!
+     * Replace all tools, for reloading the configuration.
+     *
+     * Commands composed before are not affected. Users of the object keep
+     * their references and use the new tools from now on.
+     */
+    ExternalTools &operator=(ExternalTools &&) = default;
 
     explicit ExternalTools(Command &&mount, Command &&unmount,
                            Command &&mountpoint, Command &&udevadm,
-                           Command &&findmnt):
+                           Command &&findmnt, Command &&power_off):
         mount_(std::move(mount)),
         unmount_(std::move(unmount)),
         mountpoint_(std::move(mountpoint)),
         udevadm_(std::move(udevadm)),
-        findmnt_(std::move(findmnt))
+        findmnt_(std::move(findmnt)),
+        power_off_(std::move(power_off))
     {}
 };
 
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+#include <cstring>
+#include <sys/mount.h>
+
+#include "fsmount_options.hh"
+
+using Support = Automounter::FSType::Support;
+
+static constexpr unsigned long mount_flags_default =
+    MS_RDONLY | MS_NOEXEC | MS_NOSUID | MS_NODEV;
+
+static constexpr const char mount_options_none[] = "";
+static constexpr const char mount_options_ext234[] = "-o errors=continue";
+static constexpr const char mount_options_fat[] = "-o umask=222,utf8";
+static constexpr const char mount_options_ntfs[] = "-o umask=222,nls=utf8";
+static constexpr const char mount_options_hfs[] = "-o umask=222";
+static constexpr const char mount_options_fuse[] = "-o umask=222";
+
+/*!
+ * All file systems we know about.
+ *
+ * File systems not listed here are mounted without extra options. The
+ * unsupported entries are types reported by \c blkid for volumes which do
+ * not contain a file system we could mount.
+ */
+/*
+ * In-kernel drivers are preferred, they are much faster than FUSE drivers.
+ * The options of the legacy drivers are those from the FSType entries.
+ */
+static constexpr Automounter::FSDriver drivers_exfat[] =
+{
+    Automounter::FSDriver("exfat",      mount_options_fat,  "exfat", nullptr),
+    Automounter::FSDriver("exfat-fuse", mount_options_fuse, "fuse",  "/sbin/mount.exfat-fuse"),
+};
+
+static constexpr Automounter::FSDriver drivers_ntfs[] =
+{
+    Automounter::FSDriver("ntfs3",      mount_options_fuse, "ntfs3", nullptr),
+    Automounter::FSDriver("ntfs-3g",    mount_options_fuse, "fuse",  "/sbin/mount.ntfs-3g"),
+    Automounter::FSDriver("ntfs",       mount_options_ntfs, "ntfs",  nullptr),
+};
+
+static constexpr Automounter::FSType fs_types[] =
+{
+    Automounter::FSType("ext2",    mount_options_ext234, mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("ext3",    mount_options_ext234, mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("ext4",    mount_options_ext234, mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("jfs",     mount_options_ext234, mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("xfs",     mount_options_none,   mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("btrfs",   mount_options_none,   mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("msdos",   mount_options_fat,    mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("vfat",    mount_options_fat,    mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("exfat",   mount_options_fat,    mount_flags_default, Support::SUPPORTED, drivers_exfat),
+    Automounter::FSType("ntfs",    mount_options_ntfs,   mount_flags_default, Support::SUPPORTED, drivers_ntfs),
+    Automounter::FSType("hfs",     mount_options_hfs,    mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("hfsplus", mount_options_hfs,    mount_flags_default, Support::SUPPORTED),
+    Automounter::FSType("iso9660", mount_options_none,   mount_flags_default, Support::SUPPORTED),
+
+    Automounter::FSType("swap",              mount_options_none, 0, Support::UNSUPPORTED),
+    Automounter::FSType("crypto_LUKS",       mount_options_none, 0, Support::UNSUPPORTED),
+    Automounter::FSType("LVM2_member",       mount_options_none, 0, Support::UNSUPPORTED),
+    Automounter::FSType("linux_raid_member", mount_options_none, 0, Support::UNSUPPORTED),
+};
+
+static constexpr size_t number_of_fs_types = sizeof(fs_types) / sizeof(fs_types[0]);
+
+static constexpr unsigned int hash_table_bits = 6;
+static constexpr size_t hash_table_size = size_t(1) << hash_table_bits;
+static constexpr uint8_t empty_slot = UINT8_MAX;
+static constexpr uint32_t no_seed = UINT32_MAX;
+
+static_assert(number_of_fs_types < empty_slot, "Too many file system types");
+
+/*!
+ * FNV-1a hash, modified by seed.
+ *
+ * The upper bits are used because the lower bits of an FNV hash do not
+ * depend on the upper bits of the seed.
+ */
+static constexpr uint32_t hash_name(const char *name, size_t length, uint32_t seed)
+{
+    uint32_t h = 2166136261U ^ seed;
+
+    for(size_t i = 0; i < length; ++i)
+    {
+        h ^= uint8_t(name[i]);
+        h *= 16777619U;
+    }
+
+    return h >> (32 - hash_table_bits);
+}
+
+static constexpr size_t const_strlen(const char *s)
+{
+    size_t length = 0;
+
+    while(s[length] != '\0')
+        ++length;
+
+    return length;
+}
+
+struct HashTable
+{
+    uint32_t seed;
+    uint8_t slots[hash_table_size];
+};
+
+/*!
+ * Find a seed for which all file system names hash to distinct slots.
+ */
+static constexpr HashTable mk_hash_table()
+{
+    HashTable table {};
+
+    for(uint32_t seed = 0; seed < 1000; ++seed)
+    {
+        table.seed = seed;
+
+        for(auto &slot : table.slots)
+            slot = empty_slot;
+
+        bool have_collision = false;
+
+        for(size_t i = 0; i < number_of_fs_types && !have_collision; ++i)
+        {
+            auto &slot = table.slots[hash_name(fs_types[i].name,
+                                               const_strlen(fs_types[i].name),
+                                               seed)];
+
+            if(slot == empty_slot)
+                slot = uint8_t(i);
+            else
+                have_collision = true;
+        }
+
+        if(!have_collision)
+            return table;
+    }
+
+    table.seed = no_seed;
+    return table;
+}
+
+static constexpr HashTable hash_table = mk_hash_table();
+
+static_assert(hash_table.seed != no_seed,
+              "Failed finding perfect hash for file system table");
+
+const Automounter::FSType *
+Automounter::FSMountOptions::lookup(const std::string &fstype) const
+{
+    const uint8_t slot =
+        hash_table.slots[hash_name(fstype.c_str(), fstype.length(), hash_table.seed)];
+
+    if(slot == empty_slot)
+        return nullptr;
+
+    const FSType &fs(fs_types[slot]);
+
+    return fstype == fs.name ? &fs : nullptr;
+}
+
+static const char *find_options(const std::vector<std::pair<std::string, std::string>> &options,
+                                const char *name)
+{
+    for(const auto &opt : options)
+        if(opt.first == name)
+            return opt.second.c_str();
+
+    return nullptr;
+}
+
+const char *Automounter::FSMountOptions::get_options(const std::string &fstype) const
+{
+    const char *const configured = find_options(options_, fstype.c_str());
+
+    if(configured != nullptr)
+        return configured;
+
+    const auto *const fs = lookup(fstype);
+    return fs != nullptr ? fs->options : "";
+}
+
+const char *Automounter::FSMountOptions::get_driver_options(const FSDriver &driver) const
+{
+    const char *const configured = find_options(options_, driver.name);
+    return configured != nullptr ? configured : driver.options;
+}
+
+void Automounter::FSMountOptions::set_policy(std::vector<std::string> &&allowed_filesystems,
+                                             std::vector<std::pair<std::string, std::string>> &&options)
+{
+    allowed_filesystems_ = std::move(allowed_filesystems);
+    options_ = std::move(options);
+}
+
+bool Automounter::FSMountOptions::is_allowed(const std::string &fstype) const
+{
+    return allowed_filesystems_.empty() ||
+           std::find(allowed_filesystems_.begin(), allowed_filesystems_.end(),
+                     fstype) != allowed_filesystems_.end();
+}
+
+unsigned long
+Automounter::FSMountOptions::get_mount_flags(const std::string &fstype) const
+{
+    const auto *const fs = lookup(fstype);
+    return fs != nullptr ? fs->mount_flags : mount_flags_default;
+}
+
+void Automounter::FSMountOptions::add_kernel_filesystems(const char *proc_filesystems,
+                                                         size_t length)
+{
+    const char *line = proc_filesystems;
+    const char *const end = proc_filesystems + length;
+
+    have_driver_information_ = true;
+
+    while(line < end)
+    {
+        const char *eol = static_cast<const char *>(memchr(line, '\n', end - line));
+
+        if(eol == nullptr)
+            eol = end;
+
+        /* lines look like "nodev\tsysfs" or "\text4" */
+        const char *name = eol;
+
+        while(name > line && name[-1] != '\t' && name[-1] != ' ')
+            --name;
+
+        if(name < eol)
+            add_kernel_module(std::string(name, eol - name).c_str());
+
+        line = eol + 1;
+    }
+}
+
+void Automounter::FSMountOptions::add_kernel_module(const char *name)
+{
+    have_driver_information_ = true;
+
+    if(std::find(kernel_filesystems_.begin(), kernel_filesystems_.end(), name) ==
+       kernel_filesystems_.end())
+        kernel_filesystems_.emplace_back(name);
+}
+
+void Automounter::FSMountOptions::add_helper(const char *path)
+{
+    have_driver_information_ = true;
+
+    if(std::find(helpers_.begin(), helpers_.end(), path) == helpers_.end())
+        helpers_.emplace_back(path);
+}
+
+void Automounter::FSMountOptions::for_each_driver(const std::function<void(const FSDriver &)> &fn)
+{
+    for(const auto &fs : fs_types)
+        for(size_t i = 0; i < fs.number_of_drivers; ++i)
+            fn(fs.drivers[i]);
+}
+
+bool Automounter::FSMountOptions::is_driver_available(const FSDriver &driver) const
+{
+    if(std::find(kernel_filesystems_.begin(), kernel_filesystems_.end(),
+                 driver.kernel_fs) == kernel_filesystems_.end())
+        return false;
+
+    return driver.is_kernel_driver() ||
+           std::find(helpers_.begin(), helpers_.end(), driver.helper) != helpers_.end();
+}
+
+const Automounter::FSDriver *
+Automounter::FSMountOptions::select_driver(const FSType &fs, bool kernel_only,
+                                           const FSDriver *previous) const
+{
+    if(!have_driver_information_ || fs.drivers == nullptr)
+        return nullptr;
+
+    const FSDriver *const end = fs.drivers + fs.number_of_drivers;
+    const FSDriver *drv = fs.drivers;
+
+    if(previous != nullptr)
+    {
+        if(previous < fs.drivers || previous >= end)
+            return nullptr;
+
+        drv = previous + 1;
+    }
+
+    for(/* nothing */; drv < end; ++drv)
+    {
+        if(kernel_only && !drv->is_kernel_driver())
+            continue;
+
+        if(is_driver_available(*drv))
+            return drv;
+    }
+
+    return nullptr;
+}
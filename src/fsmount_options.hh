@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef FSMOUNT_OPTIONS_HH
+#define FSMOUNT_OPTIONS_HH
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstdint>
+
+namespace Automounter
+{
+
+/*!
+ * A driver which can mount a file system type.
+ *
+ * Some file systems can be mounted by an in-kernel driver and by a FUSE
+ * implementation, or by an old and a new kernel driver. They differ in speed
+ * and in the options they understand.
+ */
+struct FSDriver
+{
+    /*! File system type as passed to the kernel or to <tt>mount -t</tt>. */
+    const char *const name;
+
+    /*! Options passed to the \c mount tool for this driver, never \c nullptr. */
+    const char *const options;
+
+    /*!
+     * Kernel file system (or module of the same name) required by the
+     * driver, such as \c "fuse" for FUSE drivers.
+     */
+    const char *const kernel_fs;
+
+    /*! Helper program required by FUSE drivers, \c nullptr for others. */
+    const char *const helper;
+
+    constexpr explicit FSDriver(const char *drv_name, const char *drv_options,
+                                const char *drv_kernel_fs, const char *drv_helper):
+        name(drv_name),
+        options(drv_options),
+        kernel_fs(drv_kernel_fs),
+        helper(drv_helper)
+    {}
+
+    bool is_kernel_driver() const { return helper == nullptr; }
+};
+
+/*!
+ * Static information about a file system type.
+ */
+struct FSType
+{
+    enum class Support : uint8_t
+    {
+        SUPPORTED,   /*!< File system is mounted. */
+        UNSUPPORTED, /*!< Known, but cannot or should not be mounted. */
+    };
+
+    /*! Name as reported by \c blkid and used by the Linux kernel. */
+    const char *const name;
+
+    /*! Extra options passed to the \c mount tool, never \c nullptr. */
+    const char *const options;
+
+    /*! Flags as they would be passed to \c mount(2). */
+    const unsigned long mount_flags;
+
+    const Support support;
+
+    /*!
+     * Drivers to be tried in order of preference, \c nullptr if the mount
+     * tool is left to choose.
+     */
+    const FSDriver *const drivers;
+    const size_t number_of_drivers;
+
+    constexpr explicit FSType(const char *fs_name, const char *fs_options,
+                              unsigned long flags, Support sup):
+        name(fs_name),
+        options(fs_options),
+        mount_flags(flags),
+        support(sup),
+        drivers(nullptr),
+        number_of_drivers(0)
+    {}
+
+    template <size_t N>
+    constexpr explicit FSType(const char *fs_name, const char *fs_options,
+                              unsigned long flags, Support sup,
+                              const FSDriver (&fs_drivers)[N]):
+        name(fs_name),
+        options(fs_options),
+        mount_flags(flags),
+        support(sup),
+        drivers(fs_drivers),
+        number_of_drivers(N)
+    {}
+
+    bool is_supported() const { return support == Support::SUPPORTED; }
+};
+
+class FSMountOptions
+{
+  private:
+    /*!
+     * Kernel file systems which are registered or can be loaded as module.
+     */
+    std::vector<std::string> kernel_filesystems_;
+
+    /*!
+     * Installed FUSE helper programs.
+     */
+    std::vector<std::string> helpers_;
+
+    /*!
+     * Whether or not driver availability is known at all.
+     */
+    bool have_driver_information_;
+
+    /*!
+     * File systems which may be mounted, empty for all supported ones.
+     */
+    std::vector<std::string> allowed_filesystems_;
+
+    /*!
+     * Mount tool options replacing those from the table, by file system or
+     * driver name.
+     */
+    std::vector<std::pair<std::string, std::string>> options_;
+
+  public:
+    FSMountOptions(const FSMountOptions &) = delete;
+    FSMountOptions &operator=(const FSMountOptions &) = delete;
+
+    /*!
+     * Ctor for #FSMountOptions.
+     *
+     * The per-file system data are compiled into a static, perfectly hashed
+     * table (see fsmount_options.cc). To add a file system, add an entry to
+     * that table.
+     *
+     * Drivers are not selected until their availability has been reported
+     * through #Automounter::FSMountOptions::add_kernel_filesystems() and
+     * friends. Until then, the \c mount tool picks the driver.
+     */
+    explicit FSMountOptions(): have_driver_information_(false) {}
+
+    /*!
+     * Register kernel file systems listed in \c /proc/filesystems.
+     */
+    void add_kernel_filesystems(const char *proc_filesystems, size_t length);
+
+    /*!
+     * Register kernel file system which can be loaded as module.
+     */
+    void add_kernel_module(const char *name);
+
+    /*!
+     * Register installed FUSE helper program.
+     */
+    void add_helper(const char *path);
+
+    /*!
+     * Call function for each driver in the file system table.
+     *
+     * For finding out which modules and helpers need to be probed.
+     */
+    static void for_each_driver(const std::function<void(const FSDriver &)> &fn);
+
+    bool is_driver_available(const FSDriver &driver) const;
+
+    /*!
+     * Find next available driver for given file system type.
+     *
+     * \param fs
+     *     File system type.
+     *
+     * \param kernel_only
+     *     Skip FUSE drivers, for mounting through the kernel mount API.
+     *
+     * \param previous
+     *     Driver which has been tried before, or \c nullptr for finding the
+     *     most preferred driver.
+     *
+     * \returns
+     *     The driver, or \c nullptr if there is no (other) candidate. For the
+     *     most preferred driver, \c nullptr means that the mount tool should
+     *     use the options in #Automounter::FSType::options and choose a
+     *     driver by itself.
+     */
+    const FSDriver *select_driver(const FSType &fs, bool kernel_only,
+                                  const FSDriver *previous) const;
+
+    /*!
+     * Find information about given file system.
+     *
+     * \param fstype
+     *     Name of the file system as it is called by the Linux kernel and as
+     *     reported by the \c blkid tool.
+     *
+     * \returns
+     *     Pointer to static file system information, or \c nullptr in case
+     *     the file system is unknown.
+     */
+    const FSType *lookup(const std::string &fstype) const;
+
+    /*!
+     * Get mount options specific to given file system.
+     *
+     * \param fstype
+     *     Name of the file system as it is called by the Linux kernel and as
+     *     reported by the \c blkid tool.
+     *
+     * \returns
+     *     A string that is safe to add to the \c mount command, guaranteed to
+     *     be non-NULL. In case there are no specific options or the file
+     *     system is unknown, this function returns the empty string.
+     */
+    const char *get_options(const std::string &fstype) const;
+
+    /*!
+     * Get mount options for given driver.
+     *
+     * Options configured for the driver's name replace those from the
+     * table.
+     */
+    const char *get_driver_options(const FSDriver &driver) const;
+
+    /*!
+     * Replace configurable parts of the mount policy.
+     *
+     * \param allowed_filesystems
+     *     Names of file systems which may be mounted. Unsupported file systems
+     *     are never mounted. If empty, all supported file systems and unknown
+     *     file systems may be mounted.
+     *
+     * \param options
+     *     Mount tool options by file system name or driver name. These take
+     *     precedence over the options in the table.
+     */
+    void set_policy(std::vector<std::string> &&allowed_filesystems,
+                    std::vector<std::pair<std::string, std::string>> &&options);
+
+    /*!
+     * Whether or not given file system may be mounted according to policy.
+     *
+     * Does not check the support flag in the table.
+     */
+    bool is_allowed(const std::string &fstype) const;
+
+    /*!
+     * Get flags for \c mount(2) for given file system.
+     *
+     * \returns
+     *     The flags from the file system table, or the default flags in case
+     *     the file system is unknown.
+     */
+    unsigned long get_mount_flags(const std::string &fstype) const;
+};
+
+}
+
+#endif /* !FSMOUNT_OPTIONS_HH */
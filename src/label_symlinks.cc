@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "label_symlinks.hh"
+#include "messages.h"
+
+Devices::LabelSymlinks::~LabelSymlinks()
+{
+    if(dirfd_ >= 0)
+        close(dirfd_);
+}
+
+static const char temporary_suffix[] = ".tmp";
+static constexpr size_t temporary_suffix_length = sizeof(temporary_suffix) - 1;
+
+/*!
+ * Whether or not the name has been made by #mk_temporary_name().
+ */
+static bool is_temporary_name(const char *name)
+{
+    const size_t length = strlen(name);
+
+    return length > temporary_suffix_length + 1 && name[0] == '.' &&
+           strcmp(name + length - temporary_suffix_length, temporary_suffix) == 0;
+}
+
+static std::string mk_temporary_name(const std::string &name)
+{
+    std::string result;
+    result.reserve(name.length() + 1 + temporary_suffix_length);
+    result.push_back('.');
+    result.append(name);
+    result.append(temporary_suffix);
+    return result;
+}
+
+bool Devices::LabelSymlinks::seed()
+{
+    if(directory_.empty())
+        return true;
+
+    if(dirfd_ >= 0)
+    {
+        MSG_BUG("Symlink directory \"%s\" seeded twice", directory_.c_str());
+        return true;
+    }
+
+    dirfd_ = open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if(dirfd_ < 0)
+    {
+        msg_error(errno, LOG_ERR,
+                  "Failed opening symlink directory \"%s\"", directory_.c_str());
+        return false;
+    }
+
+    const int fd = dup(dirfd_);
+    DIR *dir = fd >= 0 ? fdopendir(fd) : nullptr;
+
+    if(dir == nullptr)
+    {
+        msg_error(errno, LOG_ERR,
+                  "Failed reading symlink directory \"%s\"", directory_.c_str());
+
+        if(fd >= 0)
+            close(fd);
+
+        return true;
+    }
+
+    const struct dirent *entry;
+
+    while((entry = readdir(dir)) != nullptr)
+    {
+        if(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+
+        struct stat buffer;
+
+        if(fstatat(dirfd_, entry->d_name, &buffer, AT_SYMLINK_NOFOLLOW) < 0)
+            continue;
+
+        if(S_ISLNK(buffer.st_mode) &&
+           (is_temporary_name(entry->d_name) ||
+            fstatat(dirfd_, entry->d_name, &buffer, 0) < 0))
+        {
+            msg_info("Deleting stale symlink %s/%s",
+                     directory_.c_str(), entry->d_name);
+
+            if(unlinkat(dirfd_, entry->d_name, 0) == 0)
+                continue;
+
+            msg_error(errno, LOG_ERR, "Failed to delete symbolic link.");
+        }
+
+        names_.emplace(entry->d_name);
+    }
+
+    closedir(dir);
+
+    return true;
+}
+
+void Devices::LabelSymlinks::reset(const std::string &directory)
+{
+    if(dirfd_ >= 0)
+    {
+        close(dirfd_);
+        dirfd_ = -1;
+    }
+
+    names_.clear();
+    suffixes_.clear();
+    directory_ = directory;
+}
+
+static std::string mk_numbered_name(const std::string &label, unsigned int i)
+{
+    std::string name;
+    name.reserve(label.length() + 4);
+    name = label;
+    name.push_back('-');
+    name.append(std::to_string(i));
+    return name;
+}
+
+std::string Devices::LabelSymlinks::reserve_name(const std::string &label)
+{
+    if(names_.insert(label).second)
+        return label;
+
+    auto &suffixes(suffixes_[label]);
+
+    /* smallest released number first; it may have been taken by another
+     * label in the meantime (label "MUSIC-2" vs. second "MUSIC") */
+    while(!suffixes.released_.empty())
+    {
+        std::string name(mk_numbered_name(label, suffixes.released_.top()));
+        suffixes.released_.pop();
+
+        if(names_.insert(name).second)
+            return name;
+    }
+
+    /* numbers are skipped only if their names are taken by other labels or
+     * by symlinks found while seeding, so this loop is short */
+    while(true)
+    {
+        std::string name(mk_numbered_name(label, suffixes.next_++));
+
+        if(names_.insert(name).second)
+            return name;
+    }
+}
+
+void Devices::LabelSymlinks::release_name(const std::string &name)
+{
+    if(names_.erase(name) == 0)
+        return;
+
+    /* remember number for the label, if any */
+    const size_t hyphen = name.rfind('-');
+
+    if(hyphen == std::string::npos || hyphen == 0 || hyphen + 1 >= name.length() ||
+       name[hyphen + 1] < '1' || name[hyphen + 1] > '9')
+        return;
+
+    unsigned long i = 0;
+
+    for(size_t pos = hyphen + 1; pos < name.length(); ++pos)
+    {
+        if(name[pos] < '0' || name[pos] > '9' || i > UINT_MAX / 10)
+            return;
+
+        i = i * 10 + (name[pos] - '0');
+    }
+
+    if(i < 2)
+        return;
+
+    const auto it(suffixes_.find(name.substr(0, hyphen)));
+
+    if(it != suffixes_.end() && i < it->second.next_)
+        it->second.released_.push(i);
+}
+
+bool Devices::LabelSymlinks::create(const std::string &label,
+                                    const std::string &target,
+                                    std::string &name)
+{
+    name.clear();
+
+    if(dirfd_ < 0 || label.empty())
+        return false;
+
+    std::string link_name(reserve_name(label));
+    const std::string temp_name(mk_temporary_name(link_name));
+
+    msg_info("Creating symlink %s/%s to %s",
+             directory_.c_str(), link_name.c_str(), target.c_str());
+
+    unlinkat(dirfd_, temp_name.c_str(), 0);
+
+    if(symlinkat(target.c_str(), dirfd_, temp_name.c_str()) != 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed to create symbolic link.");
+        release_name(link_name);
+        return false;
+    }
+
+    if(renameat(dirfd_, temp_name.c_str(), dirfd_, link_name.c_str()) != 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed to rename symbolic link.");
+        unlinkat(dirfd_, temp_name.c_str(), 0);
+        release_name(link_name);
+        return false;
+    }
+
+    name = std::move(link_name);
+
+    return true;
+}
+
+void Devices::LabelSymlinks::remove(const std::string &name)
+{
+    if(name.empty())
+        return;
+
+    if(dirfd_ >= 0)
+    {
+        msg_info("Deleting symlink %s/%s", directory_.c_str(), name.c_str());
+
+        if(unlinkat(dirfd_, name.c_str(), 0) != 0 && errno != ENOENT)
+            msg_error(errno, LOG_ERR, "Failed to delete symbolic link.");
+    }
+
+    release_name(name);
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef LABEL_SYMLINKS_HH
+#define LABEL_SYMLINKS_HH
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <unordered_set>
+#include <unordered_map>
+
+namespace Devices
+{
+
+/*!
+ * Registry of symlinks named after volume labels.
+ *
+ * The names of all symlinks in the symlink directory are kept in memory, so
+ * that a free name for a new symlink can be found without asking the file
+ * system. In case a label is already taken, the name is the label followed by
+ * a hyphen and the smallest number starting at 2 which makes it unique
+ * (e.g., \c MUSIC, \c MUSIC-2, \c MUSIC-3).
+ *
+ * For each label which has collided before, the next number to try and the
+ * numbers released since are remembered, so that finding a free name does
+ * not depend on the number of symlinks with the same label.
+ *
+ * All file operations are done relative to a file descriptor of the
+ * directory, and symlinks are first created under a temporary name and then
+ * renamed to their final name so that they appear atomically.
+ */
+class LabelSymlinks
+{
+  private:
+    /*!
+     * Numbers used for names of a label which has collided before.
+     */
+    struct Suffixes
+    {
+        /*! All numbers below this one have been handed out at some point. */
+        unsigned int next_;
+
+        /*! Numbers below \c next_ whose names have been released. */
+        std::priority_queue<unsigned int, std::vector<unsigned int>,
+                            std::greater<unsigned int>> released_;
+
+        explicit Suffixes(): next_(2) {}
+    };
+
+    std::string directory_;
+    int dirfd_;
+    std::unordered_set<std::string> names_;
+    std::unordered_map<std::string, Suffixes> suffixes_;
+
+  public:
+    LabelSymlinks(const LabelSymlinks &) = delete;
+    LabelSymlinks &operator=(const LabelSymlinks &) = delete;
+
+    explicit LabelSymlinks(const std::string &directory):
+        directory_(directory),
+        dirfd_(-1)
+    {}
+
+    ~LabelSymlinks();
+
+    const std::string &get_directory() const { return directory_; }
+
+    /*!
+     * Open symlink directory and register names of symlinks found in there.
+     *
+     * This function should be called once at startup. Dangling symlinks,
+     * typically left over from a previous run, are removed. Nothing happens
+     * if the directory name is empty.
+     *
+     * \returns
+     *     False if the directory is configured, but cannot be opened. No
+     *     symlinks will be created in this case.
+     */
+    bool seed();
+
+    /*!
+     * Switch to another symlink directory.
+     *
+     * The current directory is closed and all names are forgotten, so the
+     * symlinks in there should be removed before. Call
+     * #Devices::LabelSymlinks::seed() afterwards.
+     */
+    void reset(const std::string &directory);
+
+    /*!
+     * Whether or not symlinks are going to be created at all.
+     */
+    bool is_enabled() const { return dirfd_ >= 0; }
+
+    /*!
+     * Find and register a free name for given label.
+     *
+     * This function does not touch the file system.
+     */
+    std::string reserve_name(const std::string &label);
+
+    /*!
+     * Remove name from registry.
+     *
+     * This function does not touch the file system.
+     */
+    void release_name(const std::string &name);
+
+    bool is_name_in_use(const std::string &name) const
+    {
+        return names_.find(name) != names_.end();
+    }
+
+    /*!
+     * Create symlink to \p target named after \p label.
+     *
+     * \param label
+     *     The volume label the name of the symlink is derived from.
+     *
+     * \param target
+     *     Where the symlink should point to.
+     *
+     * \param[out] name
+     *     Name of the symlink inside the symlink directory, empty in case of
+     *     failure.
+     *
+     * \returns
+     *     True on success, false on error or if symlinks are disabled.
+     */
+    bool create(const std::string &label, const std::string &target,
+                std::string &name);
+
+    /*!
+     * Delete symlink and release its name.
+     *
+     * \param name
+     *     Name of the symlink as returned by #Devices::LabelSymlinks::create().
+     *     Nothing happens if the name is empty.
+     */
+    void remove(const std::string &name);
+};
+
+}
+
+#endif /* !LABEL_SYMLINKS_HH */
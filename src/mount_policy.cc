@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include <glib.h>
+#pragma GCC diagnostic pop
+
+#include "mount_policy.hh"
+#include "messages.h"
+
+Automounter::ExternalTools Automounter::MountPolicy::mk_external_tools() const
+{
+    return ExternalTools(
+        ExternalTools::Command(mount_tool_.c_str(),      mount_options_.c_str()),
+        ExternalTools::Command(unmount_tool_.c_str(),    nullptr),
+        ExternalTools::Command(mountpoint_tool_.c_str(), "-q"),
+        ExternalTools::Command(udevadm_tool_.c_str(),    nullptr),
+        ExternalTools::Command(findmnt_tool_.c_str(),    "-n"),
+        ExternalTools::Command(power_off_tool_.c_str(),  nullptr));
+}
+
+class KeyFile
+{
+  private:
+    GKeyFile *const key_file_;
+    const char *const path_;
+
+  public:
+    KeyFile(const KeyFile &) = delete;
+    KeyFile &operator=(const KeyFile &) = delete;
+
+    explicit KeyFile(const char *path):
+        key_file_(g_key_file_new()),
+        path_(path)
+    {}
+
+    ~KeyFile() { g_key_file_free(key_file_); }
+
+    bool load(bool must_exist)
+    {
+        GError *error = nullptr;
+
+        if(g_key_file_load_from_file(key_file_, path_, G_KEY_FILE_NONE, &error))
+            return true;
+
+        const bool is_missing =
+            g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+
+        if(is_missing && !must_exist)
+            msg_vinfo(MESSAGE_LEVEL_DIAG, "No configuration file %s", path_);
+        else
+            msg_error(0, LOG_ERR, "Failed reading configuration file %s: %s",
+                      path_, error->message);
+
+        g_error_free(error);
+
+        return is_missing && !must_exist;
+    }
+
+    /*!
+     * Read string, leave \p value alone if the key does not exist.
+     */
+    bool get(const char *group, const char *key, std::string &value,
+             bool may_be_empty) const
+    {
+        if(!g_key_file_has_key(key_file_, group, key, nullptr))
+            return true;
+
+        GError *error = nullptr;
+        gchar *str = g_key_file_get_string(key_file_, group, key, &error);
+
+        if(str == nullptr)
+            return fail(group, key, error);
+
+        if(!may_be_empty && str[0] == '\0')
+        {
+            g_free(str);
+            return fail(group, key, "must not be empty");
+        }
+
+        value = str;
+        g_free(str);
+
+        return true;
+    }
+
+    /*!
+     * Read semicolon-separated list, empty entries are skipped.
+     */
+    bool get(const char *group, const char *key,
+             std::vector<std::string> &values) const
+    {
+        if(!g_key_file_has_key(key_file_, group, key, nullptr))
+            return true;
+
+        GError *error = nullptr;
+        gchar **list = g_key_file_get_string_list(key_file_, group, key,
+                                                  nullptr, &error);
+
+        if(list == nullptr)
+            return fail(group, key, error);
+
+        values.clear();
+
+        for(gchar **it = list; *it != nullptr; ++it)
+            if((*it)[0] != '\0')
+                values.emplace_back(*it);
+
+        g_strfreev(list);
+
+        return true;
+    }
+
+    /*!
+     * Read all keys and values of a group.
+     */
+    bool get(const char *group,
+             std::vector<std::pair<std::string, std::string>> &values) const
+    {
+        gchar **keys = g_key_file_get_keys(key_file_, group, nullptr, nullptr);
+
+        if(keys == nullptr)
+            return true;
+
+        bool retval = true;
+        values.clear();
+
+        for(gchar **it = keys; *it != nullptr && retval; ++it)
+        {
+            std::string value;
+            retval = get(group, *it, value, true);
+
+            if(retval)
+                values.emplace_back(*it, std::move(value));
+        }
+
+        g_strfreev(keys);
+
+        return retval;
+    }
+
+  private:
+    bool fail(const char *group, const char *key, GError *error) const
+    {
+        fail(group, key, error != nullptr ? error->message : "invalid value");
+
+        if(error != nullptr)
+            g_error_free(error);
+
+        return false;
+    }
+
+    bool fail(const char *group, const char *key, const char *what) const
+    {
+        msg_error(0, LOG_ERR, "Configuration file %s, [%s] %s: %s",
+                  path_, group, key, what);
+        return false;
+    }
+};
+
+bool Automounter::load_mount_policy(const char *path, bool must_exist,
+                                    MountPolicy &policy)
+{
+    KeyFile key_file(path);
+
+    if(!key_file.load(must_exist))
+        return false;
+
+    MountPolicy p(policy);
+
+    if(!key_file.get("tools", "mount",         p.mount_tool_,      false) ||
+       !key_file.get("tools", "mount-options", p.mount_options_,   true) ||
+       !key_file.get("tools", "unmount",       p.unmount_tool_,    false) ||
+       !key_file.get("tools", "mountpoint",    p.mountpoint_tool_, false) ||
+       !key_file.get("tools", "udevadm",       p.udevadm_tool_,    false) ||
+       !key_file.get("tools", "findmnt",       p.findmnt_tool_,    false) ||
+       !key_file.get("tools", "power-off",     p.power_off_tool_,  false) ||
+       !key_file.get("symlinks", "directory",  p.symlink_directory_, true) ||
+       !key_file.get("devices", "prefixes",    p.device_prefixes_) ||
+       !key_file.get("filesystems", "allowed", p.allowed_filesystems_) ||
+       !key_file.get("options",                p.fs_options_))
+        return false;
+
+    if(p.device_prefixes_.empty())
+    {
+        msg_error(0, LOG_ERR,
+                  "Configuration file %s, [devices] prefixes: must not be empty",
+                  path);
+        return false;
+    }
+
+    policy = std::move(p);
+
+    return true;
+}
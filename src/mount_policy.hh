@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef MOUNT_POLICY_HH
+#define MOUNT_POLICY_HH
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "external_tools.hh"
+
+namespace Automounter
+{
+
+/*!
+ * Settings which may be changed at runtime by reloading the configuration.
+ */
+struct MountPolicy
+{
+    std::string mount_tool_;
+    std::string mount_options_;
+    std::string unmount_tool_;
+    std::string mountpoint_tool_;
+    std::string udevadm_tool_;
+    std::string findmnt_tool_;
+    std::string power_off_tool_;
+
+    /*! Where label symlinks are created, empty to disable them. */
+    std::string symlink_directory_;
+
+    /*! Accepted prefixes of names in \c /dev/disk/by-id/. */
+    std::vector<std::string> device_prefixes_;
+
+    /*! File systems which may be mounted, empty for all supported ones. */
+    std::vector<std::string> allowed_filesystems_;
+
+    /*! Mount tool options by file system or driver name. */
+    std::vector<std::pair<std::string, std::string>> fs_options_;
+
+    ExternalTools mk_external_tools() const;
+};
+
+/*!
+ * Read configuration file and overlay its settings on \p policy.
+ *
+ * Settings not found in the file keep the values \p policy has been set to
+ * by the caller, so that removing a setting from the file restores its
+ * default on the next reload. The file uses the usual key file format, see
+ * README.md for the groups and keys.
+ *
+ * \param path
+ *     Name of the configuration file.
+ *
+ * \param must_exist
+ *     If false, a missing file is not an error and leaves \p policy alone.
+ *
+ * \param policy
+ *     Policy to be modified. It is left untouched in case of any error.
+ *
+ * \returns
+ *     True on success, false if the file could not be read or contains
+ *     invalid settings.
+ */
+bool load_mount_policy(const char *path, bool must_exist, MountPolicy &policy);
+
+}
+
+#endif /* !MOUNT_POLICY_HH */
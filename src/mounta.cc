@@ -24,7 +24,13 @@
 #endif /* HAVE_CONFIG_H */
 
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/utsname.h>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
@@ -34,8 +40,14 @@
 
 #include "fdevents.hh"
 #include "automounter.hh"
+#include "usb_by_path.hh"
 #include "external_tools.hh"
+#include "fsmount_options.hh"
+#include "mount_policy.hh"
 #include "dbus_iface.h"
+#include "dbus_changes.hh"
+#include "shm_snapshot.hh"
+#include "event_socket.hh"
 #include "messages.h"
 #include "versioninfo.h"
 
@@ -49,11 +61,20 @@ struct Parameters
     const char *working_directory;
     bool working_directory_is_watched;
     const char *symlink_directory;
+    bool watch_by_path;
+    int changes_signal_window_ms;
+    unsigned int max_parallel_mounts;
+    bool use_native_mount;
+    bool publish_shm_snapshot;
+    const char *event_socket_path;
     const char *mount_tool;
     const char *unmount_tool;
     const char *mpoint_tool;
     const char *udevadm_tool;
     const char *findmnt_tool;
+    const char *power_off_tool;
+    const char *config_file;
+    bool config_file_is_explicit;
 };
 
 static void show_version_info(void)
@@ -105,6 +126,14 @@ static int setup(const Parameters &parameters, GMainLoop *&loop)
     return 0;
 }
 
+/*
+ * Not inside the working directory because that is removed when there are no
+ * devices, and any unknown files in there are considered junk.
+ */
+static const char default_event_socket_path[] = "/run/MounTA-events";
+
+static const char default_config_file[] = "/etc/mounta.conf";
+
 static void usage(const char *program_name)
 {
     std::cout <<
@@ -114,8 +143,23 @@ static void usage(const char *program_name)
         "  --help         Show this help.\n"
         "  --version      Print version information to stdout.\n"
         "  --fg           Run in foreground, don't run as daemon.\n"
+        "  --config PATH  Read mount policy from PATH, reloaded on SIGHUP\n"
+        "                 (default: " << default_config_file << ").\n"
         "  --workdir PATH Where the mountpoints are to be maintained.\n"
         "  --watch PATH   For environments with other means of mounting.\n"
+        "  --watch-by-path\n"
+        "                 Take USB ports from /dev/disk/by-path if possible.\n"
+        "  --changes-signal MS\n"
+        "                 Emit batched Changes signal, coalescing changes for MS\n"
+        "                 milliseconds (0: until idle).\n"
+        "  --parallel-mounts N\n"
+        "                 Mount up to N volumes at the same time (default: 4).\n"
+        "  --native-mount Mount through the kernel mount API instead of the\n"
+        "                 mount tool (requires CAP_SYS_ADMIN).\n"
+        "  --shm-snapshot Publish device table in shared memory /dev/shm.\n"
+        "  --event-socket Send binary event records to local clients.\n"
+        "  --event-socket-path PATH\n"
+        "                 Path of event socket (default: " << default_event_socket_path << ").\n"
         "  --session-dbus Connect to session D-Bus.\n"
         "  --system-dbus  Connect to system D-Bus."
         << std::endl;
@@ -130,9 +174,18 @@ static int process_command_line(int argc, char *argv[], Parameters &parameters)
     parameters.mpoint_tool = "/bin/mountpoint";
     parameters.udevadm_tool = "/bin/udevadm";
     parameters.findmnt_tool = "/bin/findmnt";
+    parameters.power_off_tool = "/usr/bin/sudo /usr/bin/tee";
     parameters.working_directory = "/run/MounTA";
     parameters.working_directory_is_watched = false;
     parameters.symlink_directory = "/run/mount-by-label";
+    parameters.watch_by_path = false;
+    parameters.changes_signal_window_ms = -1;
+    parameters.max_parallel_mounts = 4;
+    parameters.use_native_mount = false;
+    parameters.publish_shm_snapshot = false;
+    parameters.event_socket_path = nullptr;
+    parameters.config_file = default_config_file;
+    parameters.config_file_is_explicit = false;
 
 #define CHECK_ARGUMENT() \
     do \
@@ -169,6 +222,12 @@ static int process_command_line(int argc, char *argv[], Parameters &parameters)
             return 2;
         else if(strcmp(argv[i], "--fg") == 0)
             parameters.run_in_foreground = true;
+        else if(strcmp(argv[i], "--config") == 0)
+        {
+            CHECK_ARGUMENT();
+            parameters.config_file = argv[i];
+            parameters.config_file_is_explicit = true;
+        }
         else if(strcmp(argv[i], "--workdir") == 0)
         {
             CHECK_ARGUMENT();
@@ -183,6 +242,50 @@ static int process_command_line(int argc, char *argv[], Parameters &parameters)
             parameters.working_directory = argv[i];
             parameters.working_directory_is_watched = true;
         }
+        else if(strcmp(argv[i], "--watch-by-path") == 0)
+            parameters.watch_by_path = true;
+        else if(strcmp(argv[i], "--changes-signal") == 0)
+        {
+            CHECK_ARGUMENT();
+            char *endptr;
+            const long ms = strtol(argv[i], &endptr, 10);
+
+            if(*argv[i] == '\0' || *endptr != '\0' || ms < 0 || ms > 60000)
+            {
+                fprintf(stderr, "Invalid window for --changes-signal.\n");
+                return -1;
+            }
+
+            parameters.changes_signal_window_ms = ms;
+        }
+        else if(strcmp(argv[i], "--parallel-mounts") == 0)
+        {
+            CHECK_ARGUMENT();
+            char *endptr;
+            const long n = strtol(argv[i], &endptr, 10);
+
+            if(*argv[i] == '\0' || *endptr != '\0' || n < 1 || n > 64)
+            {
+                fprintf(stderr, "Invalid number for --parallel-mounts.\n");
+                return -1;
+            }
+
+            parameters.max_parallel_mounts = n;
+        }
+        else if(strcmp(argv[i], "--native-mount") == 0)
+            parameters.use_native_mount = true;
+        else if(strcmp(argv[i], "--shm-snapshot") == 0)
+            parameters.publish_shm_snapshot = true;
+        else if(strcmp(argv[i], "--event-socket") == 0)
+        {
+            if(parameters.event_socket_path == nullptr)
+                parameters.event_socket_path = default_event_socket_path;
+        }
+        else if(strcmp(argv[i], "--event-socket-path") == 0)
+        {
+            CHECK_ARGUMENT();
+            parameters.event_socket_path = argv[i];
+        }
         else if(strcmp(argv[i], "--session-dbus") == 0)
             parameters.connect_to_session_dbus = true;
         else if(strcmp(argv[i], "--system-dbus") == 0)
@@ -294,6 +397,39 @@ static void handle_mountpoint_changes(FdEvents::EventType ev,
     }
 }
 
+static void handle_by_path_changes(FdEvents::EventType ev,
+                                   const char *path, bool is_dir, void *user_data)
+{
+    if(is_dir || path == nullptr)
+        return;
+
+    auto &by_path = *static_cast<Devices::UsbByPath *>(user_data);
+    const char *const slash = strrchr(path, '/');
+    const char *const link_name = slash != nullptr ? slash + 1 : path;
+
+    switch(ev)
+    {
+      case FdEvents::NEW_DEVICE:
+        {
+            std::unique_ptr<char, decltype(std::free) *>
+                devnode(os_resolve_symlink(path), std::free);
+
+            if(devnode != nullptr)
+                by_path.add(link_name, devnode.get());
+        }
+
+        break;
+
+      case FdEvents::DEVICE_GONE:
+        by_path.remove(link_name);
+        break;
+
+      case FdEvents::SHUTDOWN:
+        msg_info("Stopped watching /dev/disk/by-path");
+        break;
+    }
+}
+
 static gboolean handle_fd_event(gint fd, GIOCondition condition, gpointer user_data)
 {
     return (static_cast<FdEvents *>(user_data)->process()
@@ -303,9 +439,9 @@ static gboolean handle_fd_event(gint fd, GIOCondition condition, gpointer user_d
 
 static int setup_inotify_watch(FdEvents &ev, const char *path,
                                const FdEvents::callback_type &handler,
-                               std::pair<Automounter::Core, GMainLoop *> &data)
+                               void *data)
 {
-    int fd = ev.watch(path, handler, &data);
+    int fd = ev.watch(path, handler, data);
 
     if(fd < 0)
         return -1;
@@ -316,6 +452,8 @@ static int setup_inotify_watch(FdEvents &ev, const char *path,
     return 0;
 }
 
+static const char usb_by_path_directory[] = "/dev/disk/by-path";
+
 using CollectDevicesData =
     std::pair<std::pair<Automounter::Core, GMainLoop *> &, const char *const>;
 
@@ -333,6 +471,18 @@ static int collect_devices(const char *path, unsigned char dtype,
     return 0;
 }
 
+static int collect_by_path_links(const char *path, unsigned char dtype,
+                                 void *user_data)
+{
+    std::string full_path(usb_by_path_directory);
+    full_path += '/';
+    full_path += path;
+
+    handle_by_path_changes(FdEvents::NEW_DEVICE, full_path.c_str(), false, user_data);
+
+    return 0;
+}
+
 static int collect_mountpoints(const char *path, unsigned char dtype,
                                void *user_data)
 {
@@ -346,6 +496,139 @@ static int collect_mountpoints(const char *path, unsigned char dtype,
     return 0;
 }
 
+/*!
+ * Find out which file system drivers can be used.
+ *
+ * Kernel drivers are available if they are listed in \c /proc/filesystems or
+ * if the running kernel has a module for them. FUSE drivers additionally
+ * require their helper program.
+ */
+static void probe_fs_drivers(Automounter::FSMountOptions &mount_options)
+{
+    const int fd = open("/proc/filesystems", O_RDONLY | O_CLOEXEC);
+
+    if(fd >= 0)
+    {
+        std::string content;
+        char buffer[512];
+        ssize_t len;
+
+        while((len = os_read(fd, buffer, sizeof(buffer))) > 0 ||
+              (len < 0 && errno == EINTR))
+        {
+            if(len > 0)
+                content.append(buffer, len);
+        }
+
+        os_file_close(fd);
+        mount_options.add_kernel_filesystems(content.c_str(), content.length());
+    }
+    else
+        msg_error(errno, LOG_NOTICE, "Failed reading /proc/filesystems");
+
+    struct utsname uts;
+    const std::string modules_dir(uname(&uts) == 0
+                                  ? std::string("/lib/modules/") + uts.release + "/kernel/fs/"
+                                  : std::string());
+
+    Automounter::FSMountOptions::for_each_driver(
+        [&mount_options, &modules_dir] (const Automounter::FSDriver &driver)
+        {
+            if(!modules_dir.empty() &&
+               os_path_get_type((modules_dir + driver.kernel_fs).c_str()) == OS_PATH_TYPE_DIRECTORY)
+                mount_options.add_kernel_module(driver.kernel_fs);
+
+            if(driver.helper != nullptr && access(driver.helper, X_OK) == 0)
+                mount_options.add_helper(driver.helper);
+        });
+
+    Automounter::FSMountOptions::for_each_driver(
+        [&mount_options] (const Automounter::FSDriver &driver)
+        {
+            msg_vinfo(MESSAGE_LEVEL_DIAG, "File system driver %s is %savailable",
+                      driver.name,
+                      mount_options.is_driver_available(driver) ? "" : "not ");
+        });
+}
+
+/*!
+ * Read mount policy from configuration file on top of built-in defaults.
+ */
+static bool load_policy(const Parameters &parameters,
+                        Automounter::MountPolicy &policy)
+{
+    policy.mount_tool_ = parameters.mount_tool;
+    policy.mount_options_ = "-o ro,noexec,nosuid,nodev,user";
+    policy.unmount_tool_ = parameters.unmount_tool;
+    policy.mountpoint_tool_ = parameters.mpoint_tool;
+    policy.udevadm_tool_ = parameters.udevadm_tool;
+    policy.findmnt_tool_ = parameters.findmnt_tool;
+    policy.power_off_tool_ = parameters.power_off_tool;
+    policy.symlink_directory_ = parameters.symlink_directory;
+    policy.device_prefixes_ = {"usb-", "ata-"};
+    policy.allowed_filesystems_.clear();
+    policy.fs_options_.clear();
+
+    return Automounter::load_mount_policy(parameters.config_file,
+                                          parameters.config_file_is_explicit,
+                                          policy);
+}
+
+static void apply_fs_policy(Automounter::MountPolicy &&policy,
+                            Automounter::FSMountOptions &mount_options)
+{
+    mount_options.set_policy(std::move(policy.allowed_filesystems_),
+                             std::move(policy.fs_options_));
+}
+
+struct ReloadData
+{
+    const Parameters &parameters;
+    Automounter::ExternalTools &tools;
+    Automounter::FSMountOptions &mount_options;
+    Automounter::Core &core;
+
+    explicit ReloadData(const Parameters &p, Automounter::ExternalTools &t,
+                        Automounter::FSMountOptions &o, Automounter::Core &c):
+        parameters(p),
+        tools(t),
+        mount_options(o),
+        core(c)
+    {}
+};
+
+/*!
+ * Reload configuration file on SIGHUP.
+ *
+ * The new settings are applied to volumes and devices showing up from now
+ * on. Mounted volumes stay mounted, but their label symlinks are moved if
+ * the symlink directory has changed. The old configuration is kept if the
+ * file cannot be read.
+ */
+static gboolean reload_handler(gpointer user_data)
+{
+    auto &data(*static_cast<ReloadData *>(user_data));
+    Automounter::MountPolicy policy;
+
+    if(!load_policy(data.parameters, policy))
+    {
+        msg_error(0, LOG_ERR, "Keeping previous configuration");
+        return G_SOURCE_CONTINUE;
+    }
+
+    data.tools = policy.mk_external_tools();
+    data.core.set_device_prefixes(std::move(policy.device_prefixes_));
+
+    if(!data.parameters.working_directory_is_watched)
+        data.core.set_symlink_directory(policy.symlink_directory_);
+
+    apply_fs_policy(std::move(policy), data.mount_options);
+
+    msg_info("Reloaded configuration from %s", data.parameters.config_file);
+
+    return G_SOURCE_CONTINUE;
+}
+
 static gboolean signal_handler(gpointer user_data)
 {
     g_main_loop_quit(static_cast<GMainLoop *>(user_data));
@@ -379,52 +662,77 @@ int main(int argc, char *argv[])
     g_unix_signal_add(SIGINT, signal_handler, loop);
     g_unix_signal_add(SIGTERM, signal_handler, loop);
 
-    static constexpr const char mount_options_default[] = "-o ro,noexec,nosuid,nodev,user";
+    Automounter::MountPolicy policy;
 
-    static constexpr const char mount_options_ext234[] = "-o errors=continue";
-    static constexpr const char mount_options_fat[] = "-o umask=222,utf8";
-    static constexpr const char mount_options_ntfs[] = "-o umask=222,nls=utf8";
-    static constexpr const char mount_options_hfs[] = "-o umask=222";
+    if(!load_policy(parameters, policy))
+    {
+        /* a broken default configuration file shouldn't keep us from
+         * mounting anything, the policy has been left at its defaults */
+        if(parameters.config_file_is_explicit)
+            return EXIT_FAILURE;
+
+        msg_error(0, LOG_NOTICE, "Using built-in configuration");
+    }
+
+    static Automounter::FSMountOptions mount_options;
+    probe_fs_drivers(mount_options);
 
-    static const Automounter::FSMountOptions
-    mount_options(std::map<const std::string, const char *const>
+    Automounter::ExternalTools tools(policy.mk_external_tools());
+
+    static Devices::UsbByPath usb_by_path;
+    static FdEvents ev_by_path;
+
+    if(parameters.watch_by_path && !parameters.working_directory_is_watched)
     {
-        { "ext2",    mount_options_ext234 },
-        { "ext3",    mount_options_ext234 },
-        { "ext4",    mount_options_ext234 },
-        { "jfs",     mount_options_ext234 },
-        { "xfs",     nullptr },
-        { "btrfs",   nullptr },
-        { "msdos",   mount_options_fat },
-        { "vfat",    mount_options_fat },
-        { "exfat",   mount_options_fat },
-        { "ntfs",    mount_options_ntfs },
-        { "hfs",     mount_options_hfs },
-        { "hfsplus", mount_options_hfs },
-        { "iso9660", nullptr },
-    });
-
-    Automounter::ExternalTools tools(
-        Automounter::ExternalTools::Command(parameters.mount_tool,   mount_options_default),
-        Automounter::ExternalTools::Command(parameters.unmount_tool, nullptr),
-        Automounter::ExternalTools::Command(parameters.mpoint_tool,  "-q"),
-        Automounter::ExternalTools::Command(parameters.udevadm_tool, nullptr),
-        Automounter::ExternalTools::Command(parameters.findmnt_tool, "-n")
-    );
-
-    Devices::init(tools);
+        /* failure is not fatal, ports are found through sysfs then */
+        if(setup_inotify_watch(ev_by_path, usb_by_path_directory,
+                               handle_by_path_changes, &usb_by_path) < 0 ||
+           os_foreach_in_path(usb_by_path_directory,
+                              collect_by_path_links, &usb_by_path) < 0)
+            msg_error(0, LOG_NOTICE, "Not using %s", usb_by_path_directory);
+    }
+
+    Devices::init(tools, parameters.watch_by_path ? &usb_by_path : nullptr);
     if(!parameters.working_directory_is_watched)
         cleanup_working_directory(parameters.working_directory, tools);
 
     auto event_data =
         std::make_pair(Automounter::Core(parameters.working_directory, tools,
                                          mount_options,
-                                         parameters.symlink_directory),
+                                         policy.symlink_directory_,
+                                         parameters.max_parallel_mounts,
+                                         parameters.use_native_mount),
                        loop);
 
+    event_data.first.set_device_prefixes(std::move(policy.device_prefixes_));
+    apply_fs_policy(std::move(policy), mount_options);
+
+    static ReloadData reload_data(parameters, tools, mount_options,
+                                  event_data.first);
+    g_unix_signal_add(SIGHUP, reload_handler, &reload_data);
+
+    if(!parameters.working_directory_is_watched)
+        event_data.first.seed_label_symlinks();
+
+    if(parameters.changes_signal_window_ms >= 0)
+        dbus_changes_signal_enable(parameters.changes_signal_window_ms);
+
+    /* failure is not fatal, state is still available via D-Bus */
+    if(parameters.publish_shm_snapshot && !shm_snapshot_setup())
+        msg_error(0, LOG_NOTICE, "Not publishing device table in shared memory");
+
+    /* failure is not fatal either */
+    if(parameters.event_socket_path != nullptr &&
+       !event_socket_setup(parameters.event_socket_path, event_data.first))
+        msg_error(0, LOG_NOTICE, "Not sending events to local socket");
+
     if(dbus_setup(loop, parameters.connect_to_session_dbus, &event_data.first) < 0)
         return EXIT_FAILURE;
 
+    /* the D-Bus name is acquired from the main loop while devices are being
+     * scanned, probed, and mounted; they are announced on D-Bus as soon as
+     * the name has been acquired */
+
     /* install inotify watch first to make sure we are not losing anything */
     static FdEvents ev;
 
@@ -433,7 +741,7 @@ int main(int argc, char *argv[])
         msg_info("Just watching %s", parameters.working_directory);
 
         if(setup_inotify_watch(ev, parameters.working_directory,
-                               handle_mountpoint_changes, event_data) < 0)
+                               handle_mountpoint_changes, &event_data) < 0)
             return EXIT_FAILURE;
 
         CollectDevicesData data(std::ref(event_data), parameters.working_directory);
@@ -447,7 +755,7 @@ int main(int argc, char *argv[])
         static const char watched_directory[] = "/dev/disk/by-id";
 
         if(setup_inotify_watch(ev, watched_directory,
-                               handle_device_changes, event_data) < 0)
+                               handle_device_changes, &event_data) < 0)
             return EXIT_FAILURE;
 
         /* after the inotify watch has been installed, we check the directory
@@ -461,12 +769,27 @@ int main(int argc, char *argv[])
             return EXIT_FAILURE;
     }
 
+    /* all devices found so far have been probed and mounted */
+    event_data.first.set_initial_scan_complete();
+
     /* any inotify events already received from kernel, if any, will be
      * processed within a GLib main loop */
     g_main_loop_run(loop);
 
+    if(dbus_has_failed())
+    {
+        /* devices may have been mounted while trying to get the name */
+        event_data.first.shutdown();
+        event_socket_shutdown();
+        shm_snapshot_shutdown();
+        dbus_shutdown(loop);
+        return EXIT_FAILURE;
+    }
+
     msg_info("Shutting down");
 
+    event_socket_shutdown();
+    shm_snapshot_shutdown();
     dbus_shutdown(loop);
 
     return EXIT_SUCCESS;
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+/*!
+ * \file
+ * Records sent by MounTA on its Unix event socket.
+ *
+ * With option \c --event-socket, the daemon listens on a \c SOCK_SEQPACKET
+ * socket and sends one record per packet to each connected client. A new
+ * client first receives the current state as a sequence of
+ * #MOUNTA_EVENT_DEVICE_ADDED and #MOUNTA_EVENT_VOLUME_ADDED records,
+ * terminated by a #MOUNTA_EVENT_DUMP_COMPLETE record. After that, it receives
+ * a record for each transition at the points where the corresponding D-Bus
+ * signals are emitted.
+ *
+ * Each record starts with a struct #mounta_event_header, followed by a fixed
+ * part specific to the record type (if any), followed by length-prefixed
+ * strings. All integers are in host byte order. Clients which do not keep up
+ * with reading are disconnected and must reconnect.
+ *
+ * This header is self-contained and may be copied to other projects. Typical
+ * use:
+ *
+ * \code
+ * uint8_t buffer[MOUNTA_EVENT_MAX_RECORD_SIZE];
+ * ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+ * struct mounta_event_header header;
+ * struct mounta_event_cursor cursor;
+ * struct mounta_event_volume volume;
+ * const char *label;
+ * uint16_t label_length;
+ *
+ * if(len > 0 && mounta_event_parse(buffer, len, &header, &cursor) == 0 &&
+ *    header.type == MOUNTA_EVENT_VOLUME_ADDED &&
+ *    mounta_event_get_fixed(&cursor, &volume, sizeof(volume)) == 0 &&
+ *    mounta_event_get_string(&cursor, &label, &label_length) == 0)
+ *     printf("%.*s\n", label_length, label);
+ * \endcode
+ */
+
+#ifndef MOUNTA_EVENTS_H
+#define MOUNTA_EVENTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define MOUNTA_EVENT_VERSION 1U
+
+/*! No record is larger than this, packets are never truncated. */
+#define MOUNTA_EVENT_MAX_RECORD_SIZE 65535U
+
+/*!
+ * Device has been announced.
+ *
+ * Fixed part: struct #mounta_event_device. Strings: name, UUID, working
+ * directory, USB port, USB port chain, vendor, model, serial.
+ */
+#define MOUNTA_EVENT_DEVICE_ADDED          1U
+
+/*!
+ * Device is about to be removed, volumes are going to be unmounted.
+ *
+ * No fixed part. Strings: UUID, working directory.
+ */
+#define MOUNTA_EVENT_DEVICE_WILL_BE_REMOVED 2U
+
+/*!
+ * Device and its volumes have been removed.
+ *
+ * No fixed part. Strings: UUID, working directory.
+ */
+#define MOUNTA_EVENT_DEVICE_REMOVED        3U
+
+/*!
+ * Volume has been mounted.
+ *
+ * Fixed part: struct #mounta_event_volume. Strings: label, mountpoint, UUID,
+ * file system type.
+ */
+#define MOUNTA_EVENT_VOLUME_ADDED          4U
+
+/*!
+ * End of initial state dump. No fixed part, no strings.
+ */
+#define MOUNTA_EVENT_DUMP_COMPLETE         5U
+
+/*!
+ * Volume has been unmounted on request, its device remains.
+ *
+ * Same fixed part and strings as #MOUNTA_EVENT_VOLUME_ADDED.
+ */
+#define MOUNTA_EVENT_VOLUME_REMOVED        6U
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mounta_event_header
+{
+    /*! Size of the whole record including this header. */
+    uint16_t length;
+    uint8_t type;
+    uint8_t version;
+    uint16_t device_id;
+    uint16_t reserved;
+
+    /*! Same generation as reported by GetChangesSince. */
+    uint64_t generation;
+};
+
+struct mounta_event_device
+{
+    uint16_t usb_bus;
+    uint8_t usb_depth;
+    uint8_t reserved;
+    uint32_t usb_speed_kbps;
+    uint64_t size_bytes;
+};
+
+struct mounta_event_volume
+{
+    /*! Partition number, \c UINT32_MAX for whole-disk file systems. */
+    uint32_t index;
+    uint32_t reserved;
+    uint64_t size_bytes;
+};
+
+/*!
+ * Read position within a record.
+ */
+struct mounta_event_cursor
+{
+    const uint8_t *pos;
+    const uint8_t *end;
+};
+
+/*!
+ * Check a received record and extract its header.
+ *
+ * \returns
+ *     0 on success, -1 if the record is malformed or of unknown version.
+ */
+static inline int mounta_event_parse(const void *record, size_t length,
+                                     struct mounta_event_header *header,
+                                     struct mounta_event_cursor *cursor)
+{
+    if(length < sizeof(*header))
+        return -1;
+
+    memcpy(header, record, sizeof(*header));
+
+    if(header->length != length || header->version != MOUNTA_EVENT_VERSION)
+        return -1;
+
+    cursor->pos = (const uint8_t *)record + sizeof(*header);
+    cursor->end = (const uint8_t *)record + length;
+
+    return 0;
+}
+
+/*!
+ * Copy fixed part of a record.
+ */
+static inline int mounta_event_get_fixed(struct mounta_event_cursor *cursor,
+                                         void *dest, size_t size)
+{
+    if((size_t)(cursor->end - cursor->pos) < size)
+        return -1;
+
+    memcpy(dest, cursor->pos, size);
+    cursor->pos += size;
+
+    return 0;
+}
+
+/*!
+ * Get next string from a record.
+ *
+ * \param cursor
+ *     Read position, advanced to the next string on success.
+ *
+ * \param[out] str
+ *     Pointer into the record. The string is \e not zero-terminated.
+ *
+ * \param[out] length
+ *     Length of the string.
+ *
+ * \returns
+ *     0 on success, -1 if there are no more strings.
+ */
+static inline int mounta_event_get_string(struct mounta_event_cursor *cursor,
+                                          const char **str, uint16_t *length)
+{
+    if(cursor->end - cursor->pos < 2)
+        return -1;
+
+    memcpy(length, cursor->pos, sizeof(*length));
+
+    if(cursor->end - cursor->pos - 2 < *length)
+        return -1;
+
+    *str = (const char *)cursor->pos + 2;
+    cursor->pos += 2 + *length;
+
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !MOUNTA_EVENTS_H */
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+/*!
+ * \file
+ * Read-only snapshot of the MounTA device table in shared memory.
+ *
+ * The daemon publishes its current devices and volumes in a POSIX shared
+ * memory object named #MOUNTA_SHM_NAME. Local processes may map it and take
+ * consistent copies of the table without any system calls and without taking
+ * any locks: the table is protected by a sequence lock, so readers simply
+ * retry while the daemon is writing.
+ *
+ * This header is self-contained and may be copied to other projects. It
+ * needs POSIX.1-2008 declarations, so strict ISO C modes (such as
+ * \c -std=c99) should define \c _POSIX_C_SOURCE to \c 200809L or greater
+ * before including any system header. Typical use:
+ *
+ * \code
+ * const struct mounta_shm *shm = mounta_shm_attach();
+ * struct mounta_shm_table table;
+ *
+ * if(shm != NULL && mounta_shm_read(shm, &table) == 0)
+ *     for(uint32_t i = 0; i < table.number_of_devices; ++i)
+ *         puts(table.devices[i].name);
+ *
+ * mounta_shm_detach(shm);
+ * \endcode
+ */
+
+#ifndef MOUNTA_SHM_H
+#define MOUNTA_SHM_H
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define MOUNTA_SHM_NAME    "/mounta-state"
+#define MOUNTA_SHM_MAGIC   0x4154554dU   /* "MUTA" */
+#define MOUNTA_SHM_VERSION 1U
+
+#define MOUNTA_SHM_MAX_DEVICES 32
+#define MOUNTA_SHM_MAX_VOLUMES 64
+
+/*! More devices or volumes exist than fit into the table. */
+#define MOUNTA_SHM_FLAG_TRUNCATED (1U << 0)
+
+/*! The daemon has shut down, the table is empty and will not change. */
+#define MOUNTA_SHM_FLAG_SHUTDOWN  (1U << 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * Device as announced on D-Bus. Strings are zero-terminated and truncated if
+ * necessary.
+ */
+struct mounta_shm_device
+{
+    uint16_t id;
+    uint16_t usb_bus;
+    uint8_t usb_depth;
+    uint8_t reserved[3];
+    uint32_t usb_speed_kbps;
+    uint64_t size_bytes;
+    char name[128];
+    char uuid[64];
+    char working_directory[128];
+    char usb_port[160];
+    char usb_port_chain[32];
+    char vendor[32];
+    char model[64];
+    char serial[64];
+};
+
+/*!
+ * Mounted volume as announced on D-Bus.
+ */
+struct mounta_shm_volume
+{
+    /*! Partition number, \c UINT32_MAX for whole-disk file systems. */
+    uint32_t index;
+    uint16_t device_id;
+    uint16_t reserved;
+    uint64_t size_bytes;
+    char label[64];
+    char mountpoint[160];
+    char uuid[64];
+    char fstype[16];
+};
+
+/*!
+ * The part of the shared memory object protected by the sequence lock.
+ */
+struct mounta_shm_table
+{
+    /*! Same generation as reported by GetChangesSince. */
+    uint64_t generation;
+    uint32_t flags;
+    uint32_t number_of_devices;
+    uint32_t number_of_volumes;
+    uint32_t reserved;
+    struct mounta_shm_device devices[MOUNTA_SHM_MAX_DEVICES];
+    struct mounta_shm_volume volumes[MOUNTA_SHM_MAX_VOLUMES];
+};
+
+/*!
+ * Layout of the shared memory object.
+ */
+struct mounta_shm
+{
+    uint32_t magic;
+    uint32_t version;
+
+    /*! Size of the whole object, for compatibility checks. */
+    uint32_t size;
+
+    /*! Sequence lock, odd while the daemon is writing. */
+    uint32_t sequence;
+
+    struct mounta_shm_table table;
+};
+
+/*!
+ * Map the shared memory object published by the daemon.
+ *
+ * \returns
+ *     Read-only mapping, or \c NULL if the object does not exist or is not
+ *     compatible with this header.
+ */
+static inline const struct mounta_shm *mounta_shm_attach(void)
+{
+#ifdef O_CLOEXEC
+    const int fd = shm_open(MOUNTA_SHM_NAME, O_RDONLY | O_CLOEXEC, 0);
+#else
+    /* the descriptor is closed right after mapping anyway */
+    const int fd = shm_open(MOUNTA_SHM_NAME, O_RDONLY, 0);
+#endif
+
+    if(fd < 0)
+        return NULL;
+
+    void *p = mmap(NULL, sizeof(struct mounta_shm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(p == MAP_FAILED)
+        return NULL;
+
+    const struct mounta_shm *shm = (const struct mounta_shm *)p;
+
+    if(shm->magic != MOUNTA_SHM_MAGIC || shm->version != MOUNTA_SHM_VERSION ||
+       shm->size != sizeof(struct mounta_shm))
+    {
+        munmap(p, sizeof(struct mounta_shm));
+        return NULL;
+    }
+
+    return shm;
+}
+
+static inline void mounta_shm_detach(const struct mounta_shm *shm)
+{
+    if(shm != NULL)
+        munmap((void *)(uintptr_t)(const void *)shm, sizeof(struct mounta_shm));
+}
+
+/*!
+ * Take a consistent copy of the table.
+ *
+ * \param shm
+ *     Mapping as returned by #mounta_shm_attach().
+ *
+ * \param[out] table
+ *     Copy of the table.
+ *
+ * \returns
+ *     0 on success, -1 if no consistent copy could be taken after many
+ *     attempts (the daemon is probably stuck while writing).
+ */
+static inline int mounta_shm_read(const struct mounta_shm *shm,
+                                  struct mounta_shm_table *table)
+{
+    for(unsigned int attempt = 0; attempt < 100000; ++attempt)
+    {
+        const uint32_t before = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+
+        if(before & 1U)
+            continue;
+
+        memcpy(table, &shm->table, sizeof(*table));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if(__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) == before)
+            return 0;
+    }
+
+    return -1;
+}
+
+/*!
+ * Generation of the table, without copying it.
+ *
+ * Readers may poll this cheaply and call #mounta_shm_read() only if the
+ * generation has changed. The value is read under the sequence lock because
+ * 64 bit loads are not single-copy atomic on all platforms (e.g., 32 bit ARM).
+ *
+ * eturns
+ *     The generation, or 0 if no consistent value could be read; in the
+ *     latter case, #mounta_shm_read() will fail as well.
+ */
+static inline uint64_t mounta_shm_get_generation(const struct mounta_shm *shm)
+{
+    for(unsigned int attempt = 0; attempt < 100000; ++attempt)
+    {
+        const uint32_t before = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+
+        if(before & 1U)
+            continue;
+
+        uint64_t generation;
+        memcpy(&generation, &shm->table.generation, sizeof(generation));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if(__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) == before)
+            return generation;
+    }
+
+    return 0;
+}
+
+/*!
+ * Begin modification of the table. For use by the daemon only.
+ */
+static inline void mounta_shm_write_begin(struct mounta_shm *shm)
+{
+    __atomic_store_n(&shm->sequence, shm->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/*!
+ * End modification of the table. For use by the daemon only.
+ */
+static inline void mounta_shm_write_end(struct mounta_shm *shm)
+{
+    __atomic_store_n(&shm->sequence, shm->sequence + 1, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !MOUNTA_SHM_H */
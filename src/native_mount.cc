@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mount.h>
+#include <sys/syscall.h>
+
+#include "native_mount.hh"
+
+#ifndef FSOPEN_CLOEXEC
+#define FSOPEN_CLOEXEC          0x00000001
+#endif /* !FSOPEN_CLOEXEC */
+
+#ifndef FSCONFIG_SET_FLAG
+#define FSCONFIG_SET_FLAG       0
+#define FSCONFIG_SET_STRING     1
+#define FSCONFIG_CMD_CREATE     6
+#endif /* !FSCONFIG_SET_FLAG */
+
+#ifndef FSMOUNT_CLOEXEC
+#define FSMOUNT_CLOEXEC         0x00000001
+#endif /* !FSMOUNT_CLOEXEC */
+
+#ifndef MOUNT_ATTR_RDONLY
+#define MOUNT_ATTR_RDONLY       0x00000001
+#define MOUNT_ATTR_NOSUID       0x00000002
+#define MOUNT_ATTR_NODEV        0x00000004
+#define MOUNT_ATTR_NOEXEC       0x00000008
+#endif /* !MOUNT_ATTR_RDONLY */
+
+#ifndef MOUNT_ATTR_NOATIME
+#define MOUNT_ATTR_NOATIME      0x00000010
+#define MOUNT_ATTR_NODIRATIME   0x00000080
+#endif /* !MOUNT_ATTR_NOATIME */
+
+#ifndef MOVE_MOUNT_F_EMPTY_PATH
+#define MOVE_MOUNT_F_EMPTY_PATH 0x00000004
+#endif /* !MOVE_MOUNT_F_EMPTY_PATH */
+
+/*
+ * Direct system calls, not all C libraries have wrappers for them.
+ */
+#ifdef __NR_fsopen
+static int sys_fsopen(const char *fstype, unsigned int flags)
+{
+    return syscall(__NR_fsopen, fstype, flags);
+}
+
+static int sys_fsconfig(int fd, unsigned int cmd, const char *key,
+                        const char *value)
+{
+    return syscall(__NR_fsconfig, fd, cmd, key, value, 0);
+}
+
+static int sys_fsmount(int fd, unsigned int flags, unsigned int attr_flags)
+{
+    return syscall(__NR_fsmount, fd, flags, attr_flags);
+}
+
+static int sys_move_mount(int from_fd, const char *from_path,
+                          int to_fd, const char *to_path, unsigned int flags)
+{
+    return syscall(__NR_move_mount, from_fd, from_path, to_fd, to_path, flags);
+}
+#else /* !__NR_fsopen */
+static int sys_fsopen(const char *, unsigned int)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+static int sys_fsconfig(int, unsigned int, const char *, const char *)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+static int sys_fsmount(int, unsigned int, unsigned int)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+static int sys_move_mount(int, const char *, int, const char *, unsigned int)
+{
+    errno = ENOSYS;
+    return -1;
+}
+#endif /* __NR_fsopen */
+
+static bool is_space(char ch)
+{
+    return ch == ' ' || ch == '\t';
+}
+
+static bool split_option_list(const char *list, size_t length,
+                              std::vector<Automounter::MountOption> &result)
+{
+    const char *const end = list + length;
+
+    while(list < end)
+    {
+        const char *comma = static_cast<const char *>(memchr(list, ',', end - list));
+
+        if(comma == nullptr)
+            comma = end;
+
+        if(comma == list)
+            return false;
+
+        const char *equals = static_cast<const char *>(memchr(list, '=', comma - list));
+
+        if(equals == nullptr)
+            result.emplace_back(std::string(list, comma - list), std::string());
+        else if(equals == list)
+            return false;
+        else
+            result.emplace_back(std::string(list, equals - list),
+                                std::string(equals + 1, comma - equals - 1));
+
+        list = comma + 1;
+    }
+
+    return true;
+}
+
+bool Automounter::parse_mount_tool_options(const char *options,
+                                           std::vector<MountOption> &result)
+{
+    if(options == nullptr)
+        return true;
+
+    bool expecting_list = false;
+
+    while(*options != '\0')
+    {
+        if(is_space(*options))
+        {
+            ++options;
+            continue;
+        }
+
+        const char *end = options;
+
+        while(*end != '\0' && !is_space(*end))
+            ++end;
+
+        if(expecting_list)
+        {
+            if(!split_option_list(options, end - options, result))
+                return false;
+
+            expecting_list = false;
+        }
+        else if(options[0] != '-' || options[1] != 'o')
+            return false;
+        else if(end - options == 2)
+            expecting_list = true;
+        else if(!split_option_list(options + 2, end - options - 2, result))
+            return false;
+
+        options = end;
+    }
+
+    return !expecting_list;
+}
+
+/*!
+ * Generic mount option and what it does to the \c mount(2) flags.
+ */
+struct GenericMountOption
+{
+    const char *const name;
+    const unsigned long set;
+    const unsigned long clear;
+};
+
+static constexpr unsigned long user_mount_flags = MS_NOEXEC | MS_NOSUID | MS_NODEV;
+
+static constexpr GenericMountOption generic_mount_options[] =
+{
+    { "ro",         MS_RDONLY,        0 },
+    { "rw",         0,                MS_RDONLY },
+    { "noexec",     MS_NOEXEC,        0 },
+    { "exec",       0,                MS_NOEXEC },
+    { "nosuid",     MS_NOSUID,        0 },
+    { "suid",       0,                MS_NOSUID },
+    { "nodev",      MS_NODEV,         0 },
+    { "dev",        0,                MS_NODEV },
+    { "noatime",    MS_NOATIME,       0 },
+    { "atime",      0,                MS_NOATIME },
+    { "nodiratime", MS_NODIRATIME,    0 },
+    { "diratime",   0,                MS_NODIRATIME },
+    { "user",       user_mount_flags, 0 },
+    { "users",      user_mount_flags, 0 },
+    { "nouser",     0,                0 },
+    { "defaults",   0,                0 },
+    { "auto",       0,                0 },
+    { "noauto",     0,                0 },
+    { "nofail",     0,                0 },
+};
+
+static const GenericMountOption *
+find_generic_mount_option(const Automounter::MountOption &opt)
+{
+    if(!opt.second.empty())
+        return nullptr;
+
+    for(const auto &generic : generic_mount_options)
+        if(opt.first == generic.name)
+            return &generic;
+
+    return nullptr;
+}
+
+void Automounter::extract_mount_flags(std::vector<MountOption> &options,
+                                      unsigned long &mount_flags)
+{
+    size_t kept = 0;
+
+    for(size_t i = 0; i < options.size(); ++i)
+    {
+        const auto *const generic = find_generic_mount_option(options[i]);
+
+        if(generic != nullptr)
+        {
+            mount_flags &= ~generic->clear;
+            mount_flags |= generic->set;
+        }
+        else
+        {
+            if(kept != i)
+                options[kept] = std::move(options[i]);
+
+            ++kept;
+        }
+    }
+
+    options.resize(kept);
+}
+
+std::string Automounter::mk_mount_data(const std::vector<MountOption> &options)
+{
+    std::string data;
+
+    for(const auto &opt : options)
+    {
+        if(!data.empty())
+            data.push_back(',');
+
+        data.append(opt.first);
+
+        if(!opt.second.empty())
+            data.append(1, '=').append(opt.second);
+    }
+
+    return data;
+}
+
+/*!
+ * Append error and warning messages from a file system context's log.
+ *
+ * Each message read from the context descriptor is prefixed by its severity
+ * (\c "e ", \c "w ", or \c "i "), informational messages are skipped.
+ */
+static void append_fs_log(int fd, std::string &message)
+{
+    char buffer[256];
+    ssize_t len;
+
+    while((len = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        if(len < 3 || (buffer[0] != 'e' && buffer[0] != 'w') || buffer[1] != ' ')
+            continue;
+
+        while(len > 2 && buffer[len - 1] == '\n')
+            --len;
+
+        message.append(message.empty() ? "" : "; ").append(buffer + 2, len - 2);
+    }
+}
+
+static void set_error(int fd, const char *what, const std::string &detail,
+                      int error_code, std::string &error_message)
+{
+    std::string log;
+
+    if(fd >= 0)
+        append_fs_log(fd, log);
+
+    error_message = what;
+
+    if(!detail.empty())
+        error_message.append(" \"").append(detail).push_back('"');
+
+    error_message.append(": ").append(log.empty() ? strerror(error_code) : log);
+}
+
+static unsigned int to_mount_attributes(unsigned long mount_flags)
+{
+    unsigned int attr = 0;
+
+    if((mount_flags & MS_RDONLY) != 0)
+        attr |= MOUNT_ATTR_RDONLY;
+
+    if((mount_flags & MS_NOSUID) != 0)
+        attr |= MOUNT_ATTR_NOSUID;
+
+    if((mount_flags & MS_NODEV) != 0)
+        attr |= MOUNT_ATTR_NODEV;
+
+    if((mount_flags & MS_NOEXEC) != 0)
+        attr |= MOUNT_ATTR_NOEXEC;
+
+    if((mount_flags & MS_NOATIME) != 0)
+        attr |= MOUNT_ATTR_NOATIME;
+
+    if((mount_flags & MS_NODIRATIME) != 0)
+        attr |= MOUNT_ATTR_NODIRATIME;
+
+    return attr;
+}
+
+static bool mount_legacy(const Automounter::NativeMountRequest &request,
+                         const std::vector<Automounter::MountOption> &options,
+                         unsigned long mount_flags, std::string &error_message)
+{
+    const std::string data(Automounter::mk_mount_data(options));
+
+    if(mount(request.source_.c_str(), request.target_.c_str(),
+             request.fstype_.c_str(), mount_flags,
+             data.empty() ? nullptr : data.c_str()) == 0)
+        return true;
+
+    const int error_code = errno;
+    set_error(-1, "mount", data, error_code, error_message);
+    return false;
+}
+
+bool Automounter::mount_native(const NativeMountRequest &request,
+                               std::string &error_message)
+{
+    std::vector<MountOption> options;
+
+    if(!parse_mount_tool_options(request.options_.c_str(), options))
+    {
+        error_message = "Cannot translate mount options \"" + request.options_ + '"';
+        return false;
+    }
+
+    unsigned long mount_flags = request.mount_flags_;
+    extract_mount_flags(options, mount_flags);
+
+    const int fd = sys_fsopen(request.fstype_.c_str(), FSOPEN_CLOEXEC);
+
+    if(fd < 0)
+    {
+        if(errno == ENOSYS)
+            return mount_legacy(request, options, mount_flags, error_message);
+
+        set_error(-1, "fsopen", request.fstype_, errno, error_message);
+        return false;
+    }
+
+    bool succeeded = false;
+
+    if(sys_fsconfig(fd, FSCONFIG_SET_STRING, "source", request.source_.c_str()) < 0)
+        set_error(fd, "source", request.source_, errno, error_message);
+    else if((mount_flags & MS_RDONLY) != 0 &&
+            sys_fsconfig(fd, FSCONFIG_SET_FLAG, "ro", nullptr) < 0)
+        set_error(fd, "option", "ro", errno, error_message);
+    else
+    {
+        succeeded = true;
+
+        for(const auto &opt : options)
+        {
+            const int ret = opt.second.empty()
+                ? sys_fsconfig(fd, FSCONFIG_SET_FLAG, opt.first.c_str(), nullptr)
+                : sys_fsconfig(fd, FSCONFIG_SET_STRING, opt.first.c_str(),
+                               opt.second.c_str());
+
+            if(ret < 0)
+            {
+                set_error(fd, "option", mk_mount_data({opt}), errno, error_message);
+                succeeded = false;
+                break;
+            }
+        }
+    }
+
+    if(succeeded && sys_fsconfig(fd, FSCONFIG_CMD_CREATE, nullptr, nullptr) < 0)
+    {
+        set_error(fd, "create", request.source_, errno, error_message);
+        succeeded = false;
+    }
+
+    int mfd = -1;
+
+    if(succeeded)
+    {
+        mfd = sys_fsmount(fd, FSMOUNT_CLOEXEC,
+                          to_mount_attributes(mount_flags));
+
+        if(mfd < 0)
+        {
+            set_error(fd, "fsmount", request.source_, errno, error_message);
+            succeeded = false;
+        }
+    }
+
+    close(fd);
+
+    if(mfd < 0)
+        return false;
+
+    if(sys_move_mount(mfd, "", AT_FDCWD, request.target_.c_str(),
+                      MOVE_MOUNT_F_EMPTY_PATH) < 0)
+    {
+        set_error(-1, "move_mount", request.target_, errno, error_message);
+        succeeded = false;
+    }
+
+    close(mfd);
+
+    return succeeded;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef NATIVE_MOUNT_HH
+#define NATIVE_MOUNT_HH
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace Automounter
+{
+
+/*!
+ * A mount option as passed to the kernel, value empty for flags.
+ */
+using MountOption = std::pair<std::string, std::string>;
+
+/*!
+ * Everything required for mounting a volume without the mount tool.
+ */
+struct NativeMountRequest
+{
+    std::string source_;
+    std::string target_;
+    std::string fstype_;
+
+    /*!
+     * Options in mount tool syntax (\c "-o a=b,c").
+     *
+     * Generic options such as \c ro are taken out, see
+     * #Automounter::extract_mount_flags(). The others are passed to the
+     * file system driver.
+     */
+    std::string options_;
+
+    /*! Flags as they would be passed to \c mount(2), before \c options_. */
+    unsigned long mount_flags_;
+
+    explicit NativeMountRequest(const std::string &source,
+                                const std::string &target,
+                                const std::string &fstype,
+                                const char *options,
+                                unsigned long mount_flags):
+        source_(source),
+        target_(target),
+        fstype_(fstype),
+        options_(options != nullptr ? options : ""),
+        mount_flags_(mount_flags)
+    {}
+};
+
+/*!
+ * Translate mount tool options to a list of kernel mount options.
+ *
+ * Only \c -o arguments can be translated, either separated from their option
+ * list by white space or not.
+ *
+ * \param options
+ *     Options as found in #Automounter::FSType::options.
+ *
+ * \param result
+ *     Options are appended to this list.
+ *
+ * \returns
+ *     False if \p options contains anything other than \c -o arguments.
+ */
+bool parse_mount_tool_options(const char *options,
+                              std::vector<MountOption> &result);
+
+/*!
+ * Move generic mount options from a list of options to \c mount(2) flags.
+ *
+ * Options such as \c ro or \c noexec are handled by the VFS, not by the
+ * file system driver. They are removed from \p options and set or clear
+ * their flag in \p mount_flags instead, later options overriding earlier
+ * ones. As with the mount tool, \c user and \c users imply \c noexec,
+ * \c nosuid, and \c nodev. Options which only mean something to the mount
+ * tool, such as \c defaults or \c nouser, are dropped. All other options
+ * are left for the file system driver.
+ */
+void extract_mount_flags(std::vector<MountOption> &options,
+                         unsigned long &mount_flags);
+
+/*!
+ * Compose data argument for \c mount(2) from a list of options.
+ */
+std::string mk_mount_data(const std::vector<MountOption> &options);
+
+/*!
+ * Mount a file system using the kernel mount API.
+ *
+ * The file system context is created with \c fsopen(2) and configured option
+ * by option using \c fsconfig(2), so that a rejected option can be reported
+ * together with the message the file system driver has left in the context's
+ * log. The mount is attached to the target directory in a single
+ * \c move_mount(2) call. On kernels without the new API, \c mount(2) is
+ * used instead.
+ *
+ * This function blocks while the kernel reads the superblock and does not
+ * emit any log messages, so it may be called from a worker thread.
+ *
+ * \param request
+ *     What to mount where.
+ *
+ * \param error_message
+ *     Reason of failure, suitable for logging and for passing to clients.
+ *
+ * \returns
+ *     True on success, false on error.
+ */
+bool mount_native(const NativeMountRequest &request, std::string &error_message);
+
+}
+
+#endif /* !NATIVE_MOUNT_HH */
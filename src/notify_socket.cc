@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+#include <cstdlib>
+#include <cstddef>
+#include <cerrno>
+#include <unistd.h>
+
+#include "notify_socket.hh"
+#include "messages.h"
+
+bool Automounter::mk_notify_socket_address(const char *name,
+                                           struct sockaddr_un &addr,
+                                           socklen_t &addr_length)
+{
+    if(name == nullptr || (name[0] != '/' && name[0] != '@'))
+        return false;
+
+    const size_t length = strlen(name);
+
+    if(length < 2 || length >= sizeof(addr.sun_path))
+        return false;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, name, length);
+
+    if(name[0] == '@')
+    {
+        /* abstract namespace, name is not zero-terminated */
+        addr.sun_path[0] = '\0';
+        addr_length = offsetof(struct sockaddr_un, sun_path) + length;
+    }
+    else
+        addr_length = offsetof(struct sockaddr_un, sun_path) + length + 1;
+
+    return true;
+}
+
+bool Automounter::notify_service_manager(const char *state)
+{
+    const char *name = getenv("NOTIFY_SOCKET");
+
+    if(name == nullptr)
+        return false;
+
+    struct sockaddr_un addr;
+    socklen_t addr_length;
+
+    if(!mk_notify_socket_address(name, addr, addr_length))
+    {
+        msg_error(0, LOG_ERR, "Invalid NOTIFY_SOCKET \"%s\"", name);
+        return false;
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+    if(fd < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed creating notification socket");
+        return false;
+    }
+
+    const size_t length = strlen(state);
+    const bool ok =
+        sendto(fd, state, length, MSG_NOSIGNAL,
+               reinterpret_cast<const struct sockaddr *>(&addr),
+               addr_length) == ssize_t(length);
+
+    if(!ok)
+        msg_error(errno, LOG_ERR, "Failed notifying service manager");
+
+    close(fd);
+
+    return ok;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef NOTIFY_SOCKET_HH
+#define NOTIFY_SOCKET_HH
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace Automounter
+{
+
+/*!
+ * Fill in address of the service manager's notification socket.
+ *
+ * \param name
+ *     Value of the \c NOTIFY_SOCKET environment variable. Either an absolute
+ *     path, or an abstract socket name prefixed by \c @.
+ *
+ * \param[out] addr, addr_length
+ *     Address for \c sendto(2). Not touched in case of failure.
+ *
+ * \returns
+ *     True on success, false if \p name is not a valid socket name.
+ */
+bool mk_notify_socket_address(const char *name,
+                              struct sockaddr_un &addr, socklen_t &addr_length);
+
+/*!
+ * Send state to the service manager, as in \c sd_notify(3).
+ *
+ * Does nothing if the \c NOTIFY_SOCKET environment variable is not set,
+ * i.e., if we have not been started by a service manager which supports
+ * this protocol.
+ *
+ * \param state
+ *     Newline-separated assignments such as \c READY=1.
+ *
+ * \returns
+ *     True if the state has been sent, false otherwise.
+ */
+bool notify_service_manager(const char *state);
+
+}
+
+#endif /* !NOTIFY_SOCKET_HH */
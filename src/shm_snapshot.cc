@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <cerrno>
+#include <sys/stat.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include "mounta_shm.h"
+#pragma GCC diagnostic pop
+
+#include "shm_snapshot.hh"
+#include "automounter.hh"
+#include "messages.h"
+
+struct SnapshotData
+{
+    struct mounta_shm *shm_;
+    uint64_t generation_;
+};
+
+static SnapshotData snapshot_data;
+
+template <size_t N>
+static void copy_string(char (&dest)[N], const std::string &src)
+{
+    const size_t length = std::min(src.length(), N - 1);
+    std::copy(src.begin(), src.begin() + length, dest);
+    std::fill(dest + length, dest + N, '\0');
+}
+
+template <size_t N>
+static void copy_string(char (&dest)[N], const char *src)
+{
+    copy_string(dest, std::string(src != nullptr ? src : ""));
+}
+
+static void fill_device(struct mounta_shm_device &d, const Devices::Device &dev)
+{
+    d.id = dev.get_id();
+    d.usb_bus = dev.get_usb_bus();
+    d.usb_depth = dev.get_usb_depth();
+    d.usb_speed_kbps = dev.get_usb_speed_kbps();
+    d.size_bytes = dev.get_size();
+    copy_string(d.name, dev.get_display_name());
+    copy_string(d.uuid, dev.get_device_uuid());
+    copy_string(d.working_directory, dev.get_working_directory().str());
+    copy_string(d.usb_port, dev.get_usb_port());
+    copy_string(d.usb_port_chain, dev.get_usb_port_chain());
+    copy_string(d.vendor, dev.get_vendor());
+    copy_string(d.model, dev.get_model());
+    copy_string(d.serial, dev.get_serial());
+}
+
+static void fill_volume(struct mounta_shm_volume &v, const Devices::Volume &vol)
+{
+    v.index = vol.get_index() >= 0 ? vol.get_index() : UINT32_MAX;
+    v.device_id = vol.get_device()->get_id();
+    v.size_bytes = vol.get_size();
+    copy_string(v.label, vol.get_label());
+    copy_string(v.mountpoint, vol.get_mountpoint_name());
+    copy_string(v.uuid, vol.get_volume_uuid());
+    copy_string(v.fstype, vol.get_fstype());
+}
+
+bool shm_snapshot_setup()
+{
+    static const char name[] = MOUNTA_SHM_NAME;
+
+    if(snapshot_data.shm_ != nullptr)
+    {
+        MSG_BUG("Shared memory snapshot set up twice");
+        return true;
+    }
+
+    /* readers still attached to a stale object keep their mapping, they
+     * never see a truncated object */
+    shm_unlink(name);
+
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+                            S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if(fd < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed creating shared memory object %s", name);
+        return false;
+    }
+
+    if(ftruncate(fd, sizeof(struct mounta_shm)) < 0)
+    {
+        msg_error(errno, LOG_ERR, "Failed resizing shared memory object %s", name);
+        close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    void *p = mmap(nullptr, sizeof(struct mounta_shm),
+                   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(p == MAP_FAILED)
+    {
+        msg_error(errno, LOG_ERR, "Failed mapping shared memory object %s", name);
+        shm_unlink(name);
+        return false;
+    }
+
+    auto *shm = static_cast<struct mounta_shm *>(p);
+
+    /* object is zero-filled, so the table is empty and consistent; the
+     * header is written last so that readers do not attach too early */
+    shm->version = MOUNTA_SHM_VERSION;
+    shm->size = sizeof(struct mounta_shm);
+    __atomic_store_n(&shm->magic, MOUNTA_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    snapshot_data.shm_ = shm;
+    snapshot_data.generation_ = 0;
+
+    return true;
+}
+
+void shm_snapshot_update(const Automounter::Core &am)
+{
+    auto *const shm = snapshot_data.shm_;
+
+    if(shm == nullptr || am.get_generation() == snapshot_data.generation_)
+        return;
+
+    snapshot_data.generation_ = am.get_generation();
+
+    mounta_shm_write_begin(shm);
+
+    auto &table(shm->table);
+    uint32_t flags = 0;
+    uint32_t number_of_devices = 0;
+    uint32_t number_of_volumes = 0;
+
+    for(const auto &device : am)
+    {
+        if(device.get_state() != Devices::Device::OK)
+            continue;
+
+        if(number_of_devices >= MOUNTA_SHM_MAX_DEVICES)
+        {
+            flags |= MOUNTA_SHM_FLAG_TRUNCATED;
+            break;
+        }
+
+        fill_device(table.devices[number_of_devices++], device);
+
+        for(const auto &volume_iter : device)
+        {
+            const auto *volume = volume_iter.second.get();
+
+            if(volume == nullptr || volume->get_state() != Devices::Volume::MOUNTED)
+                continue;
+
+            if(number_of_volumes >= MOUNTA_SHM_MAX_VOLUMES)
+            {
+                flags |= MOUNTA_SHM_FLAG_TRUNCATED;
+                break;
+            }
+
+            fill_volume(table.volumes[number_of_volumes++], *volume);
+        }
+    }
+
+    table.flags = flags;
+    table.number_of_devices = number_of_devices;
+    table.number_of_volumes = number_of_volumes;
+    __atomic_store_n(&table.generation, snapshot_data.generation_, __ATOMIC_RELAXED);
+
+    mounta_shm_write_end(shm);
+}
+
+void shm_snapshot_shutdown()
+{
+    auto *const shm = snapshot_data.shm_;
+
+    if(shm == nullptr)
+        return;
+
+    mounta_shm_write_begin(shm);
+    shm->table.flags = MOUNTA_SHM_FLAG_SHUTDOWN;
+    shm->table.number_of_devices = 0;
+    shm->table.number_of_volumes = 0;
+    mounta_shm_write_end(shm);
+
+    munmap(shm, sizeof(struct mounta_shm));
+    shm_unlink(MOUNTA_SHM_NAME);
+    snapshot_data.shm_ = nullptr;
+}
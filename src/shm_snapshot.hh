@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef SHM_SNAPSHOT_HH
+#define SHM_SNAPSHOT_HH
+
+namespace Automounter { class Core; }
+
+/*!
+ * Create shared memory object #MOUNTA_SHM_NAME for the device table.
+ *
+ * \returns
+ *     True on success, false on error. In case of error, the table is not
+ *     published, but the daemon may continue to run.
+ */
+bool shm_snapshot_setup();
+
+/*!
+ * Update the device table if the generation has changed.
+ *
+ * To be called after handling an event. Does nothing if the table has not
+ * been set up.
+ */
+void shm_snapshot_update(const Automounter::Core &am);
+
+/*!
+ * Mark table as shut down and remove the shared memory object.
+ *
+ * Readers which still have it mapped see an empty table with the shutdown
+ * flag set.
+ */
+void shm_snapshot_shutdown();
+
+#endif /* !SHM_SNAPSHOT_HH */
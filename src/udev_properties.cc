@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+
+#include "udev_properties.hh"
+
+struct PropertyKey
+{
+    const char *const name;
+    const size_t length;
+    const Devices::UdevProperties::Key key;
+};
+
+#define MK_KEY(NAME, KEY) \
+    PropertyKey{ NAME, sizeof(NAME) - 1, Devices::UdevProperties::Key::KEY }
+
+/*!
+ * Environment keys we are interested in.
+ */
+static const PropertyKey property_keys[] =
+{
+    MK_KEY("ID_FS_TYPE",         FS_TYPE),
+    MK_KEY("ID_FS_UUID",         FS_UUID),
+    MK_KEY("ID_FS_LABEL",        FS_LABEL),
+    MK_KEY("ID_PART_ENTRY_UUID", PART_ENTRY_UUID),
+    MK_KEY("ID_PART_TABLE_UUID", PART_TABLE_UUID),
+    MK_KEY("ID_VENDOR",          VENDOR),
+    MK_KEY("ID_MODEL",           MODEL),
+    MK_KEY("ID_SERIAL_SHORT",    SERIAL_SHORT),
+};
+
+#undef MK_KEY
+
+void Devices::UdevProperties::parse(const char *const output, size_t length)
+{
+    buffer_.assign(output, length);
+    spans_.fill(Span{0, 0});
+    number_of_unexpected_lines_ = 0;
+
+    const char *const begin = buffer_.data();
+    const char *const end = begin + buffer_.length();
+    const char *line = begin;
+
+    auto set_span =
+        [this, begin] (Key key, const char *value, const char *end_of_value)
+        {
+            spans_[size_t(key)] = Span{uint32_t(value - begin),
+                                       uint32_t(end_of_value - value)};
+        };
+
+    while(line < end)
+    {
+        const char *eol = static_cast<const char *>(memchr(line, '\n', end - line));
+
+        if(eol == nullptr)
+            eol = end;
+
+        const size_t line_length = eol - line;
+
+        if(line_length < 4 || line[1] != ':' || line[2] != ' ')
+        {
+            if(line_length > 0)
+                ++number_of_unexpected_lines_;
+        }
+        else if(line[0] == 'P')
+            set_span(Key::DEVPATH, line + 3, eol);
+        else if(line[0] == 'E')
+        {
+            const char *const key = line + 3;
+            const char *const equals =
+                static_cast<const char *>(memchr(key, '=', eol - key));
+
+            if(equals != nullptr)
+            {
+                const size_t key_length = equals - key;
+
+                for(const auto &k : property_keys)
+                {
+                    if(k.length == key_length && memcmp(k.name, key, key_length) == 0)
+                    {
+                        set_span(k.key, equals + 1, eol);
+                        break;
+                    }
+                }
+            }
+        }
+
+        line = eol + 1;
+    }
+}
+
+Devices::UdevProperties::Value
+Devices::UdevProperties::get_best_uuid(bool allow_partition_table_uuid) const
+{
+    const Value fs_uuid(get(Key::FS_UUID));
+
+    if(!fs_uuid.empty())
+        return fs_uuid;
+
+    const Value part_entry_uuid(get(Key::PART_ENTRY_UUID));
+
+    if(!part_entry_uuid.empty() || !allow_partition_table_uuid)
+        return part_entry_uuid;
+
+    return get(Key::PART_TABLE_UUID);
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef UDEV_PROPERTIES_HH
+#define UDEV_PROPERTIES_HH
+
+#include <string>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace Devices
+{
+
+/*!
+ * Properties of a block device we are interested in.
+ *
+ * These are extracted from the output of <tt>udevadm info --query all</tt> in
+ * a single pass, and they contain everything required for filling in both,
+ * #Devices::DeviceInfo and #Devices::VolumeInfo.
+ *
+ * The output is stored in a single buffer, and properties refer to parts of
+ * it. No strings are allocated for properties; this is left to the users of
+ * this class, and only for those values which are actually kept.
+ */
+class UdevProperties
+{
+  public:
+    enum class Key
+    {
+        DEVPATH,            /*!< Kernel device path from the \c P: line. */
+        PART_TABLE_UUID,
+        PART_ENTRY_UUID,
+        FS_UUID,
+        FS_LABEL,
+        FS_TYPE,
+        VENDOR,
+        MODEL,
+        SERIAL_SHORT,
+
+        LAST_KEY = SERIAL_SHORT,
+    };
+
+    /*!
+     * Non-owning reference to a property value.
+     *
+     * Valid as long as the #Devices::UdevProperties object it was taken from
+     * is neither modified nor destroyed.
+     */
+    class Value
+    {
+      private:
+        const char *data_;
+        size_t length_;
+
+      public:
+        explicit constexpr Value(const char *data, size_t length):
+            data_(data),
+            length_(length)
+        {}
+
+        const char *data() const { return data_; }
+        size_t length() const { return length_; }
+        bool empty() const { return length_ == 0; }
+
+        std::string str() const { return std::string(data_, length_); }
+
+        bool operator==(const char *s) const
+        {
+            return s != nullptr && strncmp(data_, s, length_) == 0 &&
+                   s[length_] == '\0';
+        }
+    };
+
+  private:
+    struct Span
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    std::string buffer_;
+    std::array<Span, size_t(Key::LAST_KEY) + 1> spans_;
+    unsigned int number_of_unexpected_lines_;
+
+  public:
+    UdevProperties(const UdevProperties &) = delete;
+    UdevProperties(UdevProperties &&) = default;
+    UdevProperties &operator=(const UdevProperties &) = delete;
+    UdevProperties &operator=(UdevProperties &&) = default;
+
+    explicit UdevProperties():
+        spans_{},
+        number_of_unexpected_lines_(0)
+    {}
+
+    /*!
+     * Extract properties from udevadm output.
+     *
+     * The output is copied to an internal buffer, so it does not need to stay
+     * around after this function has returned. Any previously parsed
+     * properties are discarded first.
+     */
+    void parse(const char *output, size_t length);
+
+    Value get(Key key) const
+    {
+        const auto &span(spans_[size_t(key)]);
+        return Value(buffer_.data() + span.offset, span.length);
+    }
+
+    /*!
+     * Number of lines not looking like udevadm output.
+     */
+    unsigned int get_number_of_unexpected_lines() const
+    {
+        return number_of_unexpected_lines_;
+    }
+
+    /*!
+     * Return best UUID available for identifying the device or volume.
+     *
+     * File system UUIDs are preferred over partition entry UUIDs, which are
+     * preferred over partition table UUIDs. Empty UUIDs are ignored.
+     *
+     * \param allow_partition_table_uuid
+     *     Whether or not the partition table UUID may be returned.
+     *
+     * \returns
+     *     The UUID, empty if there is no suitable UUID.
+     */
+    Value get_best_uuid(bool allow_partition_table_uuid) const;
+};
+
+}
+
+#endif /* !UDEV_PROPERTIES_HH */
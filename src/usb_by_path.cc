@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <algorithm>
+#include <cstring>
+
+#include "usb_by_path.hh"
+
+static const char *find_substring(const char *begin, const char *end,
+                                  const char *needle, size_t needle_length)
+{
+    const char *const last = end - needle_length;
+
+    for(const char *p = begin; p <= last; ++p)
+        if(memcmp(p, needle, needle_length) == 0)
+            return p;
+
+    return nullptr;
+}
+
+/*!
+ * Find start of kernel name of the USB host controller.
+ *
+ * The controller is the last PCI or platform device in front of the USB part
+ * of the name. Platform device names may contain dashes themselves.
+ */
+static const char *find_controller(const char *begin, const char *end)
+{
+    static const char pci[] = "pci-";
+    static const char platform[] = "platform-";
+
+    const char *result = nullptr;
+
+    for(const char *p = begin; p < end; ++p)
+    {
+        if(p != begin && p[-1] != '-')
+            continue;
+
+        if(size_t(end - p) > sizeof(pci) - 1 &&
+           memcmp(p, pci, sizeof(pci) - 1) == 0)
+            result = p + sizeof(pci) - 1;
+        else if(size_t(end - p) > sizeof(platform) - 1 &&
+                memcmp(p, platform, sizeof(platform) - 1) == 0)
+            result = p + sizeof(platform) - 1;
+    }
+
+    return result;
+}
+
+bool Devices::parse_usb_by_path_name(const char *name, size_t length,
+                                     std::string &controller,
+                                     std::string &port_path)
+{
+    static const char usb[] = "-usb-0:";
+    static const char part[] = "-part";
+
+    const char *const end = name + length;
+    const char *const usb_begin = find_substring(name, end, usb, sizeof(usb) - 1);
+
+    if(usb_begin == nullptr ||
+       find_substring(usb_begin, end, part, sizeof(part) - 1) != nullptr)
+        return false;
+
+    const char *const controller_begin = find_controller(name, usb_begin);
+
+    if(controller_begin == nullptr)
+        return false;
+
+    const char *const port_begin = usb_begin + sizeof(usb) - 1;
+    const char *port_end =
+        static_cast<const char *>(memchr(port_begin, '-', end - port_begin));
+
+    if(port_end == nullptr)
+        port_end = end;
+
+    /* expect something like 1.5:1.0 */
+    const char *const colon =
+        static_cast<const char *>(memchr(port_begin, ':', port_end - port_begin));
+
+    if(colon == nullptr || colon == port_begin || colon + 1 >= port_end)
+        return false;
+
+    controller.assign(controller_begin, usb_begin);
+    port_path.assign(port_begin, port_end);
+
+    return true;
+}
+
+bool Devices::UsbByPath::add(const char *link_name, const char *devnode)
+{
+    Entry entry;
+
+    if(!parse_usb_by_path_name(link_name, strlen(link_name),
+                               entry.controller_, entry.port_path_))
+        return false;
+
+    entry.link_name_ = link_name;
+    entry.devnode_ = devnode;
+
+    auto it(std::find_if(entries_.begin(), entries_.end(),
+                         [link_name] (const Entry &e)
+                         {
+                             return e.link_name_ == link_name;
+                         }));
+
+    if(it != entries_.end())
+        *it = std::move(entry);
+    else
+        entries_.emplace_back(std::move(entry));
+
+    return true;
+}
+
+void Devices::UsbByPath::remove(const char *link_name)
+{
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [link_name] (const Entry &e)
+                                  {
+                                      return e.link_name_ == link_name;
+                                  }),
+                   entries_.end());
+}
+
+const Devices::UsbByPath::Entry *
+Devices::UsbByPath::find(const std::string &devnode) const
+{
+    for(const auto &e : entries_)
+        if(e.devnode_ == devnode)
+            return &e;
+
+    return nullptr;
+}
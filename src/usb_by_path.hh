@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef USB_BY_PATH_HH
+#define USB_BY_PATH_HH
+
+#include <string>
+#include <vector>
+
+namespace Devices
+{
+
+/*!
+ * Extract USB location from a \c /dev/disk/by-path link name.
+ *
+ * Names look like
+ * <tt>platform-3f980000.usb-usb-0:1.5:1.0-scsi-0:0:0:0</tt> or
+ * <tt>pci-0000:00:14.0-usb-0:2:1.0-scsi-0:0:0:0</tt>. Note that udev does not
+ * encode the USB bus number, so a port path such as \c 1.5:1.0 is only unique
+ * together with its host controller.
+ *
+ * \param name, length
+ *     Name of the link, without directory.
+ *
+ * \param[out] controller
+ *     Kernel name of the USB host controller, such as \c 3f980000.usb.
+ *     Not touched in case of failure.
+ *
+ * \param[out] port_path
+ *     Ports and interface below the root hub, such as \c 1.5:1.0. Not touched
+ *     in case of failure.
+ *
+ * \returns
+ *     True if the name refers to a whole USB block device, false otherwise
+ *     (including partition links).
+ */
+bool parse_usb_by_path_name(const char *name, size_t length,
+                            std::string &controller, std::string &port_path);
+
+/*!
+ * Map of block devices to USB locations maintained from
+ * \c /dev/disk/by-path.
+ *
+ * The map is fed with link names and their targets as they appear in and
+ * disappear from the directory, so that the USB location of a block device is
+ * known without looking at sysfs or running udevadm. Non-USB links are
+ * ignored.
+ */
+class UsbByPath
+{
+  public:
+    struct Entry
+    {
+        std::string link_name_;
+        std::string devnode_;
+        std::string controller_;
+        std::string port_path_;
+    };
+
+  private:
+    std::vector<Entry> entries_;
+
+  public:
+    UsbByPath(const UsbByPath &) = delete;
+    UsbByPath &operator=(const UsbByPath &) = delete;
+
+    explicit UsbByPath() {}
+
+    /*!
+     * Add link to the map.
+     *
+     * \param link_name
+     *     Name of the link inside \c /dev/disk/by-path.
+     *
+     * \param devnode
+     *     Block device the link points to, such as \c /dev/sda.
+     *
+     * \returns
+     *     True if the link has been added, false if it is not a link to a
+     *     whole USB block device.
+     */
+    bool add(const char *link_name, const char *devnode);
+
+    /*!
+     * Remove link from the map.
+     */
+    void remove(const char *link_name);
+
+    /*!
+     * Find USB location of a block device.
+     *
+     * \returns
+     *     Entry for the block device, or \c nullptr if unknown.
+     */
+    const Entry *find(const std::string &devnode) const;
+
+    size_t size() const { return entries_.size(); }
+};
+
+}
+
+#endif /* !USB_BY_PATH_HH */
@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <unistd.h>
+
+#include "usb_topology.hh"
+
+constexpr size_t Devices::UsbTopology::MAX_CACHED_PORTS;
+
+static const char *skip_digits(const char *p, const char *end)
+{
+    while(p < end && *p >= '0' && *p <= '9')
+        ++p;
+
+    return p;
+}
+
+/*!
+ * Check if path component is a USB interface name such as \c 1-1.5:1.0.
+ *
+ * \returns
+ *     Pointer to the colon, or \c nullptr if the component is not a USB
+ *     interface name.
+ */
+static const char *is_usb_interface_name(const char *name, const char *end)
+{
+    const char *p = skip_digits(name, end);
+
+    if(p == name || p >= end || *p != '-')
+        return nullptr;
+
+    while(true)
+    {
+        const char *const q = skip_digits(++p, end);
+
+        if(q == p || q >= end)
+            return nullptr;
+
+        p = q;
+
+        if(*p == ':')
+            break;
+
+        if(*p != '.')
+            return nullptr;
+    }
+
+    const char *const colon = p;
+    const char *q = skip_digits(++p, end);
+
+    if(q == p || q >= end || *q != '.')
+        return nullptr;
+
+    p = q + 1;
+    q = skip_digits(p, end);
+
+    return (q != p && q == end) ? colon : nullptr;
+}
+
+bool Devices::parse_usb_topology(const char *path, size_t length, UsbPort &port)
+{
+    const char *const end = path + length;
+    const char *component = path;
+    const char *previous = nullptr;
+
+    while(component < end)
+    {
+        const char *next =
+            static_cast<const char *>(memchr(component, '/', end - component));
+
+        if(next == nullptr)
+            next = end;
+
+        const char *const colon = is_usb_interface_name(component, next);
+
+        if(colon != nullptr)
+        {
+            const size_t chain_length = colon - component;
+
+            /* the USB device node is the parent of its interface nodes */
+            if(previous == nullptr ||
+               size_t(component - 1 - previous) != chain_length ||
+               memcmp(previous, component, chain_length) != 0)
+                return false;
+
+            port.interface_path_.assign(path, next);
+            port.chain_.assign(component, colon);
+            port.bus_ = 0;
+            port.depth_ = 1;
+
+            for(const char *p = component; *p != '-'; ++p)
+                port.bus_ = port.bus_ * 10 + (*p - '0');
+
+            for(const char *p = component; p < colon; ++p)
+                if(*p == '.')
+                    ++port.depth_;
+
+            return true;
+        }
+
+        previous = component;
+        component = next + 1;
+    }
+
+    return false;
+}
+
+std::string Devices::mk_usb_port_disable_path(const std::string &chain,
+                                              const char *sysfs_mountpoint)
+{
+    const char *const begin = chain.c_str();
+    const char *const end = begin + chain.length();
+    const char *p = skip_digits(begin, end);
+
+    if(p == begin || p >= end || *p != '-')
+        return "";
+
+    const char *const dash = p;
+    const char *last_separator = dash;
+
+    while(p < end)
+    {
+        const char *const q = skip_digits(p + 1, end);
+
+        if(q == p + 1 || (q < end && *q != '.'))
+            return "";
+
+        last_separator = p;
+        p = q;
+    }
+
+    const std::string port(last_separator + 1, end);
+    std::string path(sysfs_mountpoint);
+    path.append("/bus/usb/devices/");
+
+    if(last_separator == dash)
+    {
+        const std::string bus(begin, dash);
+        path.append(bus).append("-0:1.0/usb").append(bus);
+    }
+    else
+    {
+        const std::string hub(begin, last_separator);
+        path.append(hub).append(":1.0/").append(hub);
+    }
+
+    path.append("-port").append(port).append("/disable");
+
+    return path;
+}
+
+void Devices::UsbTopology::use_cached(std::vector<UsbPort>::reverse_iterator it,
+                                     UsbPort &port)
+{
+    port = *it;
+
+    if(it != cache_.rbegin())
+    {
+        UsbPort temp(std::move(*it));
+        cache_.erase(std::next(it).base());
+        cache_.emplace_back(std::move(temp));
+    }
+}
+
+bool Devices::UsbTopology::resolve(unsigned int major, unsigned int minor,
+                                   UsbPort &port)
+{
+    char link[64];
+    snprintf(link, sizeof(link), "%s/dev/block/%u:%u",
+             sysfs_mountpoint_.c_str(), major, minor);
+
+    char target[PATH_MAX];
+    const ssize_t length = readlink(link, target, sizeof(target));
+
+    if(length <= 0 || size_t(length) >= sizeof(target))
+        return false;
+
+    return resolve_link_target(target, length, port);
+}
+
+bool Devices::UsbTopology::resolve_link_target(const char *target, size_t length,
+                                               UsbPort &port)
+{
+    /* link targets are relative to /sys/dev/block */
+    while(length >= 3 && memcmp(target, "../", 3) == 0)
+    {
+        target += 3;
+        length -= 3;
+    }
+
+    std::string path;
+    path.reserve(sysfs_mountpoint_.length() + 1 + length);
+    path.append(sysfs_mountpoint_);
+    path.push_back('/');
+    path.append(target, length);
+
+    for(auto it = cache_.rbegin(); it != cache_.rend(); ++it)
+    {
+        const auto &p(it->interface_path_);
+
+        if(path.length() > p.length() && path[p.length()] == '/' &&
+           path.compare(0, p.length(), p) == 0)
+        {
+            use_cached(it, port);
+            return true;
+        }
+    }
+
+    UsbPort resolved;
+
+    if(!parse_usb_topology(path.c_str(), path.length(), resolved))
+        return false;
+
+    if(cache_.size() >= MAX_CACHED_PORTS)
+        cache_.erase(cache_.begin());
+
+    cache_.push_back(resolved);
+    port = std::move(resolved);
+
+    return true;
+}
+
+bool Devices::UsbTopology::find_cached(const std::string &controller,
+                                       const std::string &port_path,
+                                       UsbPort &port)
+{
+    const std::string controller_component('/' + controller + '/');
+
+    for(auto it = cache_.rbegin(); it != cache_.rend(); ++it)
+    {
+        /* the interface node name is the port path prefixed by the bus
+         * number, as in 1-1.5:1.0 vs. 1.5:1.0 */
+        const auto &p(it->interface_path_);
+        const size_t name = p.rfind('/') + 1;
+        const size_t dash = p.find('-', name);
+
+        if(dash == std::string::npos ||
+           p.compare(dash + 1, std::string::npos, port_path) != 0 ||
+           p.find(controller_component) == std::string::npos)
+            continue;
+
+        use_cached(it, port);
+        return true;
+    }
+
+    return false;
+}
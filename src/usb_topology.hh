@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#ifndef USB_TOPOLOGY_HH
+#define USB_TOPOLOGY_HH
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Devices
+{
+
+/*!
+ * Location of a USB mass storage interface in the USB topology.
+ */
+struct UsbPort
+{
+    /*!
+     * Full sysfs path to the USB interface node, such as
+     * \c /sys/devices/platform/soc/3f980000.usb/usb1/1-1/1-1.5/1-1.5:1.0.
+     */
+    std::string interface_path_;
+
+    /*!
+     * Hub and port chain, such as \c 1-1.5 for port 5 of the hub connected to
+     * port 1 of root hub 1.
+     */
+    std::string chain_;
+
+    /*!
+     * USB bus number (1 in the example above).
+     */
+    uint16_t bus_;
+
+    /*!
+     * Number of ports in the chain (2 in the example above).
+     */
+    uint8_t depth_;
+
+    explicit UsbPort(): bus_(0), depth_(0) {}
+};
+
+/*!
+ * Find USB interface node in a sysfs device path.
+ *
+ * \param path, length
+ *     Absolute path to a device in sysfs, such as a block device below some
+ *     USB interface node.
+ *
+ * \param[out] port
+ *     Location of the USB interface. Not touched in case of failure.
+ *
+ * \returns
+ *     True if the path contains a USB interface node, false otherwise.
+ */
+bool parse_usb_topology(const char *path, size_t length, UsbPort &port);
+
+/*!
+ * Path to the \c disable attribute of the hub port a USB device is plugged
+ * into.
+ *
+ * Writing 1 to this attribute switches the port off, so that the device is
+ * powered down and not enumerated again until the port is enabled. Ports of
+ * root hubs are found below interface \c N-0:1.0, all others below interface
+ * \c 1.0 of their hub.
+ *
+ * \param chain
+ *     Hub and port chain as in #Devices::UsbPort::chain_, such as \c 1-1.5.
+ *
+ * \param sysfs_mountpoint
+ *     Where sysfs is mounted.
+ *
+ * \returns
+ *     Path such as <tt>/sys/bus/usb/devices/1-1:1.0/1-1-port5/disable</tt>,
+ *     or an empty string if \p chain is not a valid hub and port chain.
+ */
+std::string mk_usb_port_disable_path(const std::string &chain,
+                                     const char *sysfs_mountpoint = "/sys");
+
+/*!
+ * Resolve block devices to USB ports by looking at sysfs directly.
+ *
+ * A block device is resolved with a single \c readlink() call on
+ * <tt>/sys/dev/block/MAJOR:MINOR</tt>. Resolved ports are cached by their
+ * interface node, so that further block devices below the same USB interface
+ * (such as the LUNs of a card reader) do not need to be parsed again.
+ */
+class UsbTopology
+{
+  private:
+    static constexpr size_t MAX_CACHED_PORTS = 16;
+
+    const std::string sysfs_mountpoint_;
+
+    /*! Most recently used port last. */
+    std::vector<UsbPort> cache_;
+
+    void use_cached(std::vector<UsbPort>::reverse_iterator it, UsbPort &port);
+
+  public:
+    UsbTopology(const UsbTopology &) = delete;
+    UsbTopology &operator=(const UsbTopology &) = delete;
+
+    explicit UsbTopology(const char *sysfs_mountpoint = "/sys"):
+        sysfs_mountpoint_(sysfs_mountpoint)
+    {}
+
+    /*!
+     * Find USB port of a block device given by its device number.
+     */
+    bool resolve(unsigned int major, unsigned int minor, UsbPort &port);
+
+    /*!
+     * Find USB port given the target of a \c /sys/dev/block/ symlink.
+     *
+     * \param target, length
+     *     Symlink target relative to \c /sys/dev/block, such as
+     *     <tt>../../devices/platform/...</tt>.
+     *
+     * \param[out] port
+     *     Location of the USB interface.
+     *
+     * \returns
+     *     True on success, false if the block device is not connected via USB.
+     */
+    bool resolve_link_target(const char *target, size_t length, UsbPort &port);
+
+    /*!
+     * Find cached USB port by host controller and port path.
+     *
+     * This is for locations taken from \c /dev/disk/by-path links, see
+     * #Devices::parse_usb_by_path_name(). No system calls are made.
+     *
+     * \param controller
+     *     Kernel name of the USB host controller, such as \c 3f980000.usb.
+     *
+     * \param port_path
+     *     Ports and interface below the root hub, such as \c 1.5:1.0.
+     *
+     * \param[out] port
+     *     Location of the USB interface.
+     *
+     * \returns
+     *     True if the port is in the cache, false otherwise.
+     */
+    bool find_cached(const std::string &controller, const std::string &port_path,
+                     UsbPort &port);
+
+    size_t get_number_of_cached_ports() const { return cache_.size(); }
+    void clear() { cache_.clear(); }
+};
+
+}
+
+#endif /* !USB_TOPOLOGY_HH */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#ifndef WAIT_INDEX_HH
+#define WAIT_INDEX_HH
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+
+namespace Automounter
+{
+
+/*!
+ * Pending requests waiting for something identified by a string key.
+ *
+ * Used for holding D-Bus method invocations which wait for a volume to be
+ * mounted, keyed by volume UUID. Whoever makes the awaited thing happen takes
+ * all waiters for its key in a single lookup, so there is no need to poll.
+ *
+ * \tparam T
+ *     Type of the waiters, usually a pointer. Waiters must be comparable for
+ *     removal.
+ */
+template <typename T>
+class WaitIndex
+{
+  private:
+    std::unordered_map<std::string, std::vector<T>> waiters_;
+    size_t number_of_waiters_;
+
+  public:
+    WaitIndex(const WaitIndex &) = delete;
+    WaitIndex &operator=(const WaitIndex &) = delete;
+
+    explicit WaitIndex(): number_of_waiters_(0) {}
+
+    size_t size() const { return number_of_waiters_; }
+
+    void add(const std::string &key, T waiter)
+    {
+        waiters_[key].push_back(std::move(waiter));
+        ++number_of_waiters_;
+    }
+
+    /*!
+     * Remove a specific waiter, for instance, after it has timed out.
+     *
+     * \returns
+     *     True if the waiter was found, false otherwise.
+     */
+    bool remove(const std::string &key, const T &waiter)
+    {
+        auto it = waiters_.find(key);
+
+        if(it == waiters_.end())
+            return false;
+
+        auto &list(it->second);
+        auto w = std::find(list.begin(), list.end(), waiter);
+
+        if(w == list.end())
+            return false;
+
+        list.erase(w);
+        --number_of_waiters_;
+
+        if(list.empty())
+            waiters_.erase(it);
+
+        return true;
+    }
+
+    /*!
+     * Remove and return all waiters for given key, oldest first.
+     */
+    std::vector<T> take(const std::string &key)
+    {
+        std::vector<T> result;
+        auto it = waiters_.find(key);
+
+        if(it == waiters_.end())
+            return result;
+
+        result = std::move(it->second);
+        waiters_.erase(it);
+        number_of_waiters_ -= result.size();
+
+        return result;
+    }
+
+    /*!
+     * Remove and return all waiters, for instance, on shutdown.
+     */
+    std::vector<T> take_all()
+    {
+        std::vector<T> result;
+        result.reserve(number_of_waiters_);
+
+        for(auto &it : waiters_)
+            std::move(it.second.begin(), it.second.end(), std::back_inserter(result));
+
+        waiters_.clear();
+        number_of_waiters_ = 0;
+
+        return result;
+    }
+};
+
+}
+
+#endif /* !WAIT_INDEX_HH */
@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "device_manager.hh"
+#include "external_tools.hh"
+#include "automounter.hh"
+
+#include "mock_messages.hh"
+#include "mock_os.hh"
+#include "mock_devices_os.hh"
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <fstream>
+
+/* Stuff the linker wants, but we don't need */
+bool os_rmdir(const char *path, bool must_exist)
+{
+    FAIL("Unexpected call");
+    return false;
+}
+
+int os_stat(const char *path, struct stat *buf)
+{
+    FAIL("Unexpected call");
+    return -1;
+}
+
+bool os_mkdir_hierarchy(const char *path, bool must_not_exist)
+{
+    FAIL("Unexpected call");
+    return false;
+}
+
+void os_nanosleep(const struct timespec *tp)
+{
+    FAIL("Unexpected call");
+}
+
+/*
+ * Scaling benchmark for #Devices::AllDevices.
+ *
+ * The device manager is fed with N synthetic devices with M partitions each,
+ * and the time taken for adding them, for handling duplicate events for all of
+ * them, for iterating over all devices and volumes, and for removing them is
+ * measured. All expectations for the mocks are set up before the clock is
+ * started, but the timings include the cost of checking them, which is
+ * constant per call.
+ *
+ * Results are written to \c benchmark_device_manager.json in the current
+ * working directory. Note that there cannot be more than 999 devices at the
+ * same time because that is the size of the device ID space.
+ */
+TEST_SUITE_BEGIN("Device manager benchmark");
+
+static Automounter::ExternalTools tools(
+            Automounter::ExternalTools::Command("/bin/mount",          nullptr),
+            Automounter::ExternalTools::Command("/bin/umount",         nullptr),
+            Automounter::ExternalTools::Command("/usr/bin/mountpoint", "-q"),
+            Automounter::ExternalTools::Command("/bin/udevadm",        nullptr),
+            Automounter::ExternalTools::Command("/bin/findmnt",        "-n"),
+            Automounter::ExternalTools::Command("/usr/bin/tee",        nullptr)
+);
+
+class Fixture
+{
+  public:
+    std::unique_ptr<MockMessages::Mock> mock_messages;
+    std::unique_ptr<MockOS::Mock> mock_os;
+    std::unique_ptr<MockDevicesOs::Mock> mock_devices_os;
+
+    std::unique_ptr<Devices::AllDevices> devs;
+
+    explicit Fixture():
+        mock_messages(std::make_unique<MockMessages::Mock>()),
+        mock_os(std::make_unique<MockOS::Mock>()),
+        mock_devices_os(std::make_unique<MockDevicesOs::Mock>()),
+        devs(std::make_unique<Devices::AllDevices>(tools, std::string()))
+    {
+        MockMessages::singleton = mock_messages.get();
+        MockOS::singleton = mock_os.get();
+        MockDevicesOs::singleton = mock_devices_os.get();
+    }
+
+    ~Fixture()
+    {
+        devs = nullptr;
+
+        try
+        {
+            mock_messages->done();
+            mock_os->done();
+            mock_devices_os->done();
+        }
+        catch(...)
+        {
+            /* no throwing from dtors */
+        }
+
+        MockMessages::singleton = nullptr;
+        MockOS::singleton = nullptr;
+        MockDevicesOs::singleton = nullptr;
+    }
+};
+
+struct Result
+{
+    const char *operation;
+    size_t number_of_devices;
+    size_t number_of_partitions;
+    size_t count;
+    uint64_t total_ns;
+};
+
+class Stopwatch
+{
+  private:
+    const std::chrono::steady_clock::time_point start_;
+
+  public:
+    explicit Stopwatch(): start_(std::chrono::steady_clock::now()) {}
+
+    uint64_t elapsed_ns() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_).count();
+    }
+};
+
+/*!
+ * Block device names "/dev/sda" through "/dev/sdzz" and so on.
+ */
+static std::string mk_devname(size_t i)
+{
+    std::string suffix;
+
+    do
+    {
+        suffix.insert(suffix.begin(), char('a' + i % 26));
+        i /= 26;
+    }
+    while(i-- > 0);
+
+    return "/dev/sd" + suffix;
+}
+
+static void run_scenario(size_t number_of_devices, size_t number_of_partitions,
+                         std::vector<Result> &results)
+{
+    Fixture f;
+
+    const Devices::DeviceInfo device_info("b2291fc4-77b9-4bb4-b661-09a831dc3fdb",
+            "/sys/devices/platform/soc/3f980000.usb/usb1/1-1/1-1.3/1-1.3:1.0");
+
+    std::vector<std::string> devlinks;
+    std::vector<std::string> devnames;
+    std::vector<Devices::VolumeInfo> volinfos;
+
+    devlinks.reserve(number_of_devices * (number_of_partitions + 1));
+    devnames.reserve(number_of_devices * (number_of_partitions + 1));
+    volinfos.reserve(number_of_devices * number_of_partitions);
+
+    for(size_t i = 0; i < number_of_devices; ++i)
+    {
+        const std::string devlink("usb-Bench_Disk_" + std::to_string(i));
+        const std::string devname(mk_devname(i));
+
+        devlinks.push_back(devlink);
+        devnames.push_back(devname);
+
+        for(size_t j = 1; j <= number_of_partitions; ++j)
+        {
+            devlinks.push_back(devlink + "-part" + std::to_string(j));
+            devnames.push_back(devname + std::to_string(j));
+            volinfos.emplace_back(j, "866b54b6-547f-4812-8b97-" + std::to_string(100000000000 + i),
+                                  "P" + std::to_string(j), "ext4");
+        }
+    }
+
+    auto add_result =
+        [&results, number_of_devices, number_of_partitions]
+        (const char *operation, size_t count, uint64_t total_ns)
+        {
+            results.push_back(Result{operation, number_of_devices, number_of_partitions,
+                                     count, total_ns});
+        };
+
+    /* add all devices and volumes */
+    for(size_t i = 0, v = 0; i < devlinks.size(); ++i)
+    {
+        expect<MockOS::ResolveSymlink>(f.mock_os, devnames[i].c_str(), 0, devlinks[i].c_str());
+
+        if(i % (number_of_partitions + 1) == 0)
+        {
+            expect<MockDevicesOs::GetVolumeInformation>(f.mock_devices_os, devnames[i].c_str(), nullptr);
+            expect<MockDevicesOs::GetDeviceInformation>(f.mock_devices_os, devlinks[i].c_str(), &device_info);
+        }
+        else
+            expect<MockDevicesOs::GetVolumeInformation>(f.mock_devices_os, devnames[i].c_str(), &volinfos[v++]);
+    }
+
+    {
+        Stopwatch sw;
+
+        for(const auto &devlink : devlinks)
+        {
+            Devices::Volume *volume;
+            bool have_probed_dev;
+            f.devs->new_entry(devlink.c_str(), volume, have_probed_dev);
+        }
+
+        add_result("new_entry", devlinks.size(), sw.elapsed_ns());
+    }
+
+    REQUIRE(f.devs->get_number_of_devices() == number_of_devices);
+
+    /* the same events again */
+    for(size_t i = 0, v = 0, d = 0; i < devlinks.size(); ++i)
+    {
+        expect<MockOS::ResolveSymlink>(f.mock_os, devnames[i].c_str(), 0, devlinks[i].c_str());
+
+        if(i % (number_of_partitions + 1) == 0)
+        {
+            d = i;
+            expect<MockMessages::MsgInfo>(f.mock_messages,
+                                          ("Device " + devlinks[i] + " already registered").c_str(),
+                                          false);
+        }
+        else
+        {
+            expect<MockDevicesOs::GetVolumeInformation>(f.mock_devices_os, devnames[i].c_str(), &volinfos[v++]);
+            expect<MockMessages::MsgInfo>(f.mock_messages,
+                                          ("Volume " + devlinks[i] + " already registered on device " +
+                                           devlinks[d]).c_str(),
+                                          false);
+        }
+    }
+
+    {
+        Stopwatch sw;
+
+        for(const auto &devlink : devlinks)
+        {
+            Devices::Volume *volume;
+            bool have_probed_dev;
+            f.devs->new_entry(devlink.c_str(), volume, have_probed_dev);
+        }
+
+        add_result("duplicate_new_entry", devlinks.size(), sw.elapsed_ns());
+    }
+
+    REQUIRE(f.devs->get_number_of_devices() == number_of_devices);
+
+    /* iterate over everything */
+    {
+        static constexpr size_t iterations = 10;
+        size_t number_of_volumes = 0;
+        Stopwatch sw;
+
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            for(const auto &dev : *f.devs)
+                for(const auto &vol : *dev.second)
+                    if(vol.second != nullptr)
+                        ++number_of_volumes;
+        }
+
+        add_result("iterate", iterations * devlinks.size(), sw.elapsed_ns());
+
+        CHECK(number_of_volumes == iterations * number_of_devices * number_of_partitions);
+    }
+
+    /* remove all devices */
+    {
+        size_t number_of_removed_devices = 0;
+        Stopwatch sw;
+
+        for(size_t i = 0; i < devlinks.size(); i += number_of_partitions + 1)
+            if(f.devs->remove_entry(devlinks[i].c_str()))
+                ++number_of_removed_devices;
+
+        add_result("remove_entry", number_of_devices, sw.elapsed_ns());
+
+        CHECK(number_of_removed_devices == number_of_devices);
+    }
+
+    CHECK(f.devs->get_number_of_devices() == 0);
+}
+
+static void write_json(const char *filename, const std::vector<Result> &results)
+{
+    std::ofstream out(filename);
+
+    out << "{\n  \"benchmark\": \"device_manager\",\n  \"results\": [\n";
+
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const auto &r(results[i]);
+
+        out << "    { \"operation\": \"" << r.operation << "\""
+            << ", \"devices\": " << r.number_of_devices
+            << ", \"partitions\": " << r.number_of_partitions
+            << ", \"count\": " << r.count
+            << ", \"total_ns\": " << r.total_ns
+            << ", \"ns_per_op\": " << (r.count > 0 ? r.total_ns / r.count : 0)
+            << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n}\n";
+}
+
+/*!\test
+ * Measure device manager operations for increasing numbers of devices.
+ */
+TEST_CASE("Device manager scales with number of devices and volumes")
+{
+    static const std::array<std::pair<size_t, size_t>, 6> scenarios =
+    {
+        std::make_pair(10, 1),
+        std::make_pair(10, 4),
+        std::make_pair(100, 1),
+        std::make_pair(100, 4),
+        std::make_pair(999, 1),
+        std::make_pair(999, 4),
+    };
+
+    std::vector<Result> results;
+
+    for(const auto &s : scenarios)
+        run_scenario(s.first, s.second, results);
+
+    for(const auto &r : results)
+        MESSAGE(r.operation << " with " << r.number_of_devices << "x"
+                << r.number_of_partitions << ": "
+                << (r.count > 0 ? r.total_ns / r.count : 0) << " ns/op");
+
+    write_json("benchmark_device_manager.json", results);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,414 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "udev_properties.hh"
+#include "devices_os_parsers.hh"
+
+#include <algorithm>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <new>
+#include <cstdlib>
+#include <dirent.h>
+
+#ifndef CORPUS_DIR
+#define CORPUS_DIR "corpus"
+#endif /* !CORPUS_DIR */
+
+/*
+ * Allocation counting. Only the number of calls of operator new is of
+ * interest here.
+ */
+static size_t heap_allocations;
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size > 0 ? size : 1);
+
+    if(p == nullptr)
+        throw std::bad_alloc();
+
+    ++heap_allocations;
+
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept
+{
+    free(p);
+}
+
+/*
+ * Microbenchmarks for the parsers of external tool output.
+ *
+ * Each parser is run repeatedly over all files found in its corpus directory
+ * below \c CORPUS_DIR. Time per parse, time per input byte, and heap
+ * allocations per parse are reported. Results are written to
+ * \c benchmark_parsers.json in the current working directory.
+ */
+TEST_SUITE_BEGIN("Parser benchmarks");
+
+struct CorpusFile
+{
+    std::string name_;
+    std::string content_;
+};
+
+struct Result
+{
+    std::string parser;
+    std::string input;
+    size_t bytes;
+    size_t count;
+    uint64_t total_ns;
+    size_t allocations;
+};
+
+class Stopwatch
+{
+  private:
+    const std::chrono::steady_clock::time_point start_;
+
+  public:
+    explicit Stopwatch(): start_(std::chrono::steady_clock::now()) {}
+
+    uint64_t elapsed_ns() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_).count();
+    }
+};
+
+static std::vector<CorpusFile> read_corpus(const char *subdir)
+{
+    const std::string path(std::string(CORPUS_DIR) + '/' + subdir);
+    std::vector<CorpusFile> result;
+
+    DIR *dir = opendir(path.c_str());
+
+    if(dir == nullptr)
+        return result;
+
+    const struct dirent *entry;
+
+    while((entry = readdir(dir)) != nullptr)
+    {
+        if(entry->d_name[0] == '.')
+            continue;
+
+        std::ifstream in(path + '/' + entry->d_name);
+        std::ostringstream content;
+        content << in.rdbuf();
+
+        result.push_back(CorpusFile{entry->d_name, content.str()});
+    }
+
+    closedir(dir);
+
+    std::sort(result.begin(), result.end(),
+              [] (const CorpusFile &a, const CorpusFile &b)
+              {
+                  return a.name_ < b.name_;
+              });
+
+    return result;
+}
+
+static constexpr size_t iterations = 20000;
+
+template <typename ParseFn>
+static void run_parser(const char *parser, const std::vector<CorpusFile> &corpus,
+                       std::vector<Result> &results, const ParseFn &parse)
+{
+    for(const auto &file : corpus)
+    {
+        /* warm up, also gives parsers a chance to allocate buffers */
+        parse(file.content_);
+
+        const size_t allocs_before = heap_allocations;
+        size_t failures = 0;
+        Stopwatch sw;
+
+        for(size_t i = 0; i < iterations; ++i)
+            if(!parse(file.content_))
+                ++failures;
+
+        const uint64_t total_ns = sw.elapsed_ns();
+        const size_t allocations = heap_allocations - allocs_before;
+
+        CHECK_MESSAGE(failures == 0, parser << " failed on " << file.name_);
+
+        results.push_back(Result{parser, file.name_, file.content_.length(),
+                                 iterations, total_ns, allocations});
+    }
+}
+
+static void write_json(const char *filename, const std::vector<Result> &results)
+{
+    std::ofstream out(filename);
+
+    out << "{\n  \"benchmark\": \"parsers\",\n  \"results\": [\n";
+
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const auto &r(results[i]);
+
+        out << "    { \"parser\": \"" << r.parser << "\""
+            << ", \"input\": \"" << r.input << "\""
+            << ", \"bytes\": " << r.bytes
+            << ", \"count\": " << r.count
+            << ", \"total_ns\": " << r.total_ns
+            << ", \"ns_per_parse\": " << double(r.total_ns) / r.count
+            << ", \"ns_per_byte\": " << double(r.total_ns) / (r.count * r.bytes)
+            << ", \"allocations_per_parse\": " << double(r.allocations) / r.count
+            << " }" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n}\n";
+}
+
+static void report(const std::vector<Result> &results, size_t first)
+{
+    for(size_t i = first; i < results.size(); ++i)
+    {
+        const auto &r(results[i]);
+        MESSAGE(r.parser << " " << r.input << " (" << r.bytes << " bytes): "
+                << double(r.total_ns) / r.count << " ns/parse, "
+                << double(r.total_ns) / (r.count * r.bytes) << " ns/byte, "
+                << double(r.allocations) / r.count << " allocations/parse");
+    }
+}
+
+/* results of all test cases, written to the JSON file after each of them */
+static std::vector<Result> all_results;
+
+static std::vector<CorpusFile> filter_corpus(
+        const std::vector<CorpusFile> &corpus,
+        const std::function<bool(const Devices::UdevProperties &)> &pred)
+{
+    std::vector<CorpusFile> result;
+    Devices::UdevProperties props;
+
+    for(const auto &file : corpus)
+    {
+        props.parse(file.content_.c_str(), file.content_.length());
+
+        if(pred(props))
+            result.push_back(file);
+    }
+
+    return result;
+}
+
+/*!\test
+ * Parse udevadm dumps of USB sticks, card readers, and SSD enclosures.
+ *
+ * The "udev_properties" run reuses one object as done for refreshed cache
+ * entries. The "udev_properties_volume" run parses into a new object and
+ * copies out the values kept for a volume, which is what happens for each
+ * hotplugged partition.
+ */
+TEST_CASE("Parse udevadm output")
+{
+    const auto corpus(read_corpus("udevadm"));
+    REQUIRE_FALSE(corpus.empty());
+
+    const size_t first = all_results.size();
+    Devices::UdevProperties props;
+
+    run_parser("udev_properties", corpus, all_results,
+        [&props] (const std::string &output)
+        {
+            props.parse(output.c_str(), output.length());
+            return true;
+        });
+
+    std::string uuid;
+    std::string label;
+    std::string fstype;
+
+    run_parser("udev_properties_volume", corpus, all_results,
+        [&uuid, &label, &fstype] (const std::string &output)
+        {
+            using Key = Devices::UdevProperties::Key;
+
+            Devices::UdevProperties p;
+            p.parse(output.c_str(), output.length());
+
+            const auto u(p.get_best_uuid(false));
+            const auto l(p.get(Key::FS_LABEL));
+            const auto t(p.get(Key::FS_TYPE));
+            uuid.assign(u.data(), u.length());
+            label.assign(l.data(), l.length());
+            fstype.assign(t.data(), t.length());
+            return true;
+        });
+
+    report(all_results, first);
+    write_json("benchmark_parsers.json", all_results);
+}
+
+/*!\test
+ * Determine the USB port from the kernel device paths found in the udevadm
+ * corpus.
+ */
+TEST_CASE("Parse USB device ID")
+{
+    std::vector<CorpusFile> corpus;
+
+    for(const auto &file : read_corpus("udevadm"))
+    {
+        Devices::UdevProperties props;
+        props.parse(file.content_.c_str(), file.content_.length());
+        corpus.push_back(CorpusFile{file.name_,
+                                    props.get(Devices::UdevProperties::Key::DEVPATH).str()});
+    }
+
+    REQUIRE_FALSE(corpus.empty());
+
+    const size_t first = all_results.size();
+    Devices::DeviceInfo info;
+
+    run_parser("parse_usb_device_id", corpus, all_results,
+        [&info] (const std::string &devpath)
+        {
+            return Devices::parse_usb_device_id(devpath.c_str(), devpath.length(), info);
+        });
+
+    report(all_results, first);
+    write_json("benchmark_parsers.json", all_results);
+}
+
+/*!\test
+ * Full path from udevadm output to #Devices::DeviceInfo and
+ * #Devices::VolumeInfo as taken for each hotplugged device and volume.
+ *
+ * Only outputs which do not cause any log messages are used so that the
+ * numbers are not distorted by the mock.
+ */
+TEST_CASE("Parse device and volume information")
+{
+    using Key = Devices::UdevProperties::Key;
+
+    const auto corpus(read_corpus("udevadm"));
+    const auto devices(filter_corpus(corpus,
+        [] (const Devices::UdevProperties &p)
+        {
+            return !p.get_best_uuid(true).empty();
+        }));
+    const auto volumes(filter_corpus(corpus,
+        [] (const Devices::UdevProperties &p)
+        {
+            return !p.get(Key::FS_TYPE).empty() && !p.get_best_uuid(true).empty();
+        }));
+
+    REQUIRE_FALSE(devices.empty());
+    REQUIRE_FALSE(volumes.empty());
+
+    const size_t first = all_results.size();
+    const std::string devlink("/dev/disk/by-id/usb-Bench_Disk-0:0");
+    const std::string devname("/dev/sda");
+    Devices::UdevProperties props;
+    Devices::DeviceInfo devinfo;
+    Devices::VolumeInfo volinfo;
+
+    run_parser("parse_device_info", devices, all_results,
+        [&props, &devlink, &devinfo] (const std::string &output)
+        {
+            props.parse(output.c_str(), output.length());
+            devinfo.type = Devices::DeviceType::UNKNOWN;
+            return Devices::parse_device_info(props, devlink, devinfo);
+        });
+
+    run_parser("parse_volume_info", volumes, all_results,
+        [&props, &devname, &volinfo] (const std::string &output)
+        {
+            props.parse(output.c_str(), output.length());
+            return Devices::parse_volume_info(props, devname, volinfo);
+        });
+
+    report(all_results, first);
+    write_json("benchmark_parsers.json", all_results);
+}
+
+/*!\test
+ * Extract device links from <tt>udevadm info --query symlink --root</tt>
+ * output for a whole disk and one of its volumes.
+ */
+TEST_CASE("Parse device links")
+{
+    const auto corpus(read_corpus("udevadm_symlinks"));
+    REQUIRE_FALSE(corpus.empty());
+
+    const size_t first = all_results.size();
+    std::pair<std::string, std::string> links;
+
+    run_parser("parse_device_link_from_line", corpus, all_results,
+        [&links] (const std::string &output)
+        {
+            size_t offset = 0;
+            links.first = Devices::parse_device_link_from_line(output.c_str(), output.length(), offset);
+            links.second = Devices::parse_device_link_from_line(output.c_str(), output.length(), offset);
+            return !links.second.empty();
+        });
+
+    report(all_results, first);
+    write_json("benchmark_parsers.json", all_results);
+}
+
+/*!\test
+ * Extract block device names from findmnt output.
+ */
+TEST_CASE("Parse findmnt output")
+{
+    const auto corpus(read_corpus("findmnt"));
+    REQUIRE_FALSE(corpus.empty());
+
+    const size_t first = all_results.size();
+    std::string dev_device;
+    std::string vol_device;
+
+    run_parser("parse_findmnt_source", corpus, all_results,
+        [&dev_device, &vol_device] (const std::string &output)
+        {
+            return Devices::parse_findmnt_source(output.c_str(), output.length(),
+                                                 dev_device, vol_device);
+        });
+
+    report(all_results, first);
+    write_json("benchmark_parsers.json", all_results);
+}
+
+TEST_SUITE_END();
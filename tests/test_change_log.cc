@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "change_log.hh"
+
+TEST_SUITE_BEGIN("Change log");
+
+using Kind = Automounter::ChangeLog::Kind;
+
+/*!\test
+ * Changes are numbered by consecutive generations, and only those made after
+ * the client's generation are returned.
+ */
+TEST_CASE("Changes since a known generation are found")
+{
+    Automounter::ChangeLog log;
+    CHECK(log.get_generation() == 0);
+
+    log.append(Kind::DEVICE_ADDED, 5);
+    log.append(Kind::VOLUME_ADDED, 5, 1);
+    log.append(Kind::VOLUME_ADDED, 5, 2);
+    CHECK(log.get_generation() == 3);
+
+    std::deque<Automounter::ChangeLog::Change>::const_iterator it;
+
+    REQUIRE(log.find_changes_since(1, it));
+    REQUIRE(it != log.end());
+    CHECK(it->generation_ == 2);
+    CHECK(it->kind_ == Kind::VOLUME_ADDED);
+    CHECK(it->device_id_ == 5);
+    CHECK(it->volume_index_ == 1);
+    ++it;
+    REQUIRE(it != log.end());
+    CHECK(it->volume_index_ == 2);
+    CHECK(++it == log.end());
+
+    REQUIRE(log.find_changes_since(0, it));
+    CHECK(std::distance(it, log.end()) == 3);
+
+    REQUIRE(log.find_changes_since(3, it));
+    CHECK(it == log.end());
+}
+
+/*!\test
+ * Clients with unknown generations must resync.
+ */
+TEST_CASE("Generations from the future require resync")
+{
+    Automounter::ChangeLog log;
+    std::deque<Automounter::ChangeLog::Change>::const_iterator it;
+
+    log.append(Kind::DEVICE_ADDED, 1);
+    CHECK_FALSE(log.find_changes_since(2, it));
+}
+
+/*!\test
+ * Oldest changes are dropped when the log is full.
+ */
+TEST_CASE("Truncated log requires resync for old generations")
+{
+    Automounter::ChangeLog log;
+    std::deque<Automounter::ChangeLog::Change>::const_iterator it;
+
+    for(size_t i = 0; i < Automounter::ChangeLog::MAX_CHANGES + 2; ++i)
+        log.append(Kind::DEVICE_ADDED, 1);
+
+    CHECK_FALSE(log.find_changes_since(0, it));
+    CHECK_FALSE(log.find_changes_since(1, it));
+
+    REQUIRE(log.find_changes_since(2, it));
+    CHECK(std::distance(it, log.end()) == ptrdiff_t(Automounter::ChangeLog::MAX_CHANGES));
+}
+
+/*!\test
+ * Changes which are not recorded individually invalidate all generations
+ * known by clients.
+ */
+TEST_CASE("Invalidation requires resync")
+{
+    Automounter::ChangeLog log;
+    std::deque<Automounter::ChangeLog::Change>::const_iterator it;
+
+    log.append(Kind::DEVICE_ADDED, 1);
+    log.invalidate();
+    CHECK(log.get_generation() == 2);
+
+    CHECK_FALSE(log.find_changes_since(0, it));
+    CHECK_FALSE(log.find_changes_since(1, it));
+
+    REQUIRE(log.find_changes_since(2, it));
+    CHECK(it == log.end());
+
+    log.append(Kind::DEVICE_REMOVED, 1);
+    REQUIRE(log.find_changes_since(2, it));
+    REQUIRE(it != log.end());
+    CHECK(it->kind_ == Kind::DEVICE_REMOVED);
+    CHECK(it->volume_index_ == UINT_MAX);
+}
+
+TEST_SUITE_END();
@@ -59,12 +59,6 @@ void os_nanosleep(const struct timespec *tp)
     FAIL("Unexpected call");
 }
 
-const char *Automounter::FSMountOptions::get_options(const std::string &fstype) const
-{
-    FAIL("Unexpected call");
-    return nullptr;
-}
-
 /* The actual unit tests */
 TEST_SUITE_BEGIN("Device manager");
 
@@ -96,7 +90,8 @@ static Automounter::ExternalTools tools(
             Automounter::ExternalTools::Command("/bin/umount",         nullptr),
             Automounter::ExternalTools::Command("/usr/bin/mountpoint", "-q"),
             Automounter::ExternalTools::Command("/bin/udevadm",        nullptr),
-            Automounter::ExternalTools::Command("/bin/findmnt",        "-n")
+            Automounter::ExternalTools::Command("/bin/findmnt",        "-n"),
+            Automounter::ExternalTools::Command("/usr/bin/tee",        nullptr)
 );
 
 class Fixture
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "devices_os_parsers.hh"
+
+TEST_SUITE_BEGIN("Parsers for external tool output");
+
+/*!\test
+ * Block device sizes are given in 512 byte sectors.
+ */
+TEST_CASE("Parse block device size from sysfs")
+{
+    static const char size[] = "30529536\n";
+    uint64_t size_bytes = 0;
+
+    REQUIRE(Devices::parse_sysfs_size(size, sizeof(size) - 1, size_bytes));
+    CHECK(size_bytes == 15631122432ULL);
+
+    CHECK_FALSE(Devices::parse_sysfs_size("", 0, size_bytes));
+    CHECK_FALSE(Devices::parse_sysfs_size("12x\n", 4, size_bytes));
+    CHECK(size_bytes == 15631122432ULL);
+}
+
+/*!\test
+ * USB speeds are given in Mbit/s, with fractional part for low speed.
+ */
+TEST_CASE("Parse USB speed from sysfs")
+{
+    uint32_t speed_kbps = 0;
+
+    REQUIRE(Devices::parse_usb_speed("480\n", 4, speed_kbps));
+    CHECK(speed_kbps == 480000);
+
+    REQUIRE(Devices::parse_usb_speed("5000\n", 5, speed_kbps));
+    CHECK(speed_kbps == 5000000);
+
+    REQUIRE(Devices::parse_usb_speed("1.5\n", 4, speed_kbps));
+    CHECK(speed_kbps == 1500);
+
+    CHECK_FALSE(Devices::parse_usb_speed("0\n", 2, speed_kbps));
+    CHECK_FALSE(Devices::parse_usb_speed("unknown\n", 8, speed_kbps));
+    CHECK(speed_kbps == 1500);
+}
+
+/*!\test
+ * Whole disk and volume names are both taken from the findmnt output.
+ */
+TEST_CASE("Parse findmnt source")
+{
+    std::string dev;
+    std::string vol;
+
+    REQUIRE(Devices::parse_findmnt_source("/dev/sdab12\n", 12, dev, vol));
+    CHECK(dev == "/dev/sdab");
+    CHECK(vol == "/dev/sdab12");
+
+    REQUIRE(Devices::parse_findmnt_source("/dev/sde\n\n", 10, dev, vol));
+    CHECK(dev == "/dev/sde");
+    CHECK(vol == "/dev/sde");
+
+    CHECK_FALSE(Devices::parse_findmnt_source("\n", 1, dev, vol));
+    CHECK_FALSE(Devices::parse_findmnt_source("123\n", 4, dev, vol));
+    CHECK(vol == "/dev/sde");
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "event_record.hh"
+
+TEST_SUITE_BEGIN("Event socket records");
+
+static std::string next_string(struct mounta_event_cursor &cursor)
+{
+    const char *str;
+    uint16_t length;
+
+    REQUIRE(mounta_event_get_string(&cursor, &str, &length) == 0);
+    return std::string(str, length);
+}
+
+/*!\test
+ * What is put into a record is parsed back by the client-side functions.
+ */
+TEST_CASE("Volume record is parsed back")
+{
+    struct mounta_event_volume fixed {};
+    fixed.index = 2;
+    fixed.size_bytes = 1ULL << 33;
+
+    Automounter::EventRecord rec(MOUNTA_EVENT_VOLUME_ADDED, 7, 42);
+    rec.put_fixed(fixed)
+       .put_string("Music")
+       .put_string("/run/MounTA/7/Music")
+       .put_string("")
+       .put_string("vfat");
+
+    struct mounta_event_header header;
+    struct mounta_event_cursor cursor;
+
+    REQUIRE(mounta_event_parse(rec.data(), rec.size(), &header, &cursor) == 0);
+    CHECK(header.length == rec.size());
+    CHECK(header.type == MOUNTA_EVENT_VOLUME_ADDED);
+    CHECK(header.version == MOUNTA_EVENT_VERSION);
+    CHECK(header.device_id == 7);
+    CHECK(header.generation == 42);
+
+    struct mounta_event_volume volume;
+    REQUIRE(mounta_event_get_fixed(&cursor, &volume, sizeof(volume)) == 0);
+    CHECK(volume.index == 2);
+    CHECK(volume.size_bytes == 1ULL << 33);
+
+    CHECK(next_string(cursor) == "Music");
+    CHECK(next_string(cursor) == "/run/MounTA/7/Music");
+    CHECK(next_string(cursor) == "");
+    CHECK(next_string(cursor) == "vfat");
+
+    const char *str;
+    uint16_t length;
+    CHECK(mounta_event_get_string(&cursor, &str, &length) == -1);
+}
+
+/*!\test
+ * Overlong strings are cut so that records stay small.
+ */
+TEST_CASE("Long strings are truncated")
+{
+    const std::string long_string(5000, 'x');
+
+    Automounter::EventRecord rec(MOUNTA_EVENT_DEVICE_REMOVED, 1, 1);
+    rec.put_string(long_string);
+
+    CHECK(rec.size() == sizeof(struct mounta_event_header) + 2 +
+                        Automounter::EventRecord::MAX_STRING_LENGTH);
+
+    struct mounta_event_header header;
+    struct mounta_event_cursor cursor;
+
+    REQUIRE(mounta_event_parse(rec.data(), rec.size(), &header, &cursor) == 0);
+    CHECK(next_string(cursor) == long_string.substr(0, Automounter::EventRecord::MAX_STRING_LENGTH));
+}
+
+/*!\test
+ * Records whose size does not match the header are rejected, as are strings
+ * reaching beyond the end of the record.
+ */
+TEST_CASE("Malformed records are rejected")
+{
+    Automounter::EventRecord rec(MOUNTA_EVENT_DEVICE_REMOVED, 1, 1);
+    rec.put_string("uuid");
+
+    struct mounta_event_header header;
+    struct mounta_event_cursor cursor;
+
+    CHECK(mounta_event_parse(rec.data(), rec.size() - 1, &header, &cursor) == -1);
+    CHECK(mounta_event_parse(rec.data(), 4, &header, &cursor) == -1);
+
+    REQUIRE(mounta_event_parse(rec.data(), rec.size(), &header, &cursor) == 0);
+    cursor.end -= 1;
+
+    const char *str;
+    uint16_t length;
+    CHECK(mounta_event_get_string(&cursor, &str, &length) == -1);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "fsmount_options.hh"
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <sys/mount.h>
+
+TEST_SUITE_BEGIN("File system mount options");
+
+/*!\test
+ * All file systems in the table can be found, and they map to the expected
+ * options.
+ */
+TEST_CASE("Known file systems are found")
+{
+    const Automounter::FSMountOptions mount_options;
+
+    static const std::array<std::pair<const char *, const char *>, 13> expected =
+    {
+        std::make_pair("ext2",    "-o errors=continue"),
+        std::make_pair("ext3",    "-o errors=continue"),
+        std::make_pair("ext4",    "-o errors=continue"),
+        std::make_pair("jfs",     "-o errors=continue"),
+        std::make_pair("xfs",     ""),
+        std::make_pair("btrfs",   ""),
+        std::make_pair("msdos",   "-o umask=222,utf8"),
+        std::make_pair("vfat",    "-o umask=222,utf8"),
+        std::make_pair("exfat",   "-o umask=222,utf8"),
+        std::make_pair("ntfs",    "-o umask=222,nls=utf8"),
+        std::make_pair("hfs",     "-o umask=222"),
+        std::make_pair("hfsplus", "-o umask=222"),
+        std::make_pair("iso9660", ""),
+    };
+
+    for(const auto &e : expected)
+    {
+        const auto *fs = mount_options.lookup(e.first);
+
+        REQUIRE(fs != nullptr);
+        CHECK(fs->name == e.first);
+        CHECK(fs->options == e.second);
+        CHECK(fs->is_supported());
+        CHECK((fs->mount_flags & MS_RDONLY) != 0);
+        CHECK(mount_options.get_options(e.first) == e.second);
+    }
+}
+
+/*!\test
+ * Volumes which do not contain a mountable file system are classified as
+ * unsupported.
+ */
+TEST_CASE("Non-mountable volume types are unsupported")
+{
+    const Automounter::FSMountOptions mount_options;
+
+    for(const char *name : { "swap", "crypto_LUKS", "LVM2_member", "linux_raid_member" })
+    {
+        const auto *fs = mount_options.lookup(name);
+
+        REQUIRE(fs != nullptr);
+        CHECK_FALSE(fs->is_supported());
+    }
+}
+
+/*!\test
+ * Unknown file systems are not found and have no extra options.
+ */
+TEST_CASE("Unknown file systems are not found")
+{
+    const Automounter::FSMountOptions mount_options;
+
+    for(const char *name : { "", "ext", "ext44", "EXT4", "vfat ", "zfs", "ntfs3" })
+    {
+        CHECK(mount_options.lookup(name) == nullptr);
+        CHECK(std::string(mount_options.get_options(name)).empty());
+    }
+}
+
+/*!\test
+ * The mount tool chooses the driver as long as nothing is known about the
+ * drivers installed on the system.
+ */
+TEST_CASE("No driver is selected without driver information")
+{
+    const Automounter::FSMountOptions mount_options;
+
+    for(const char *name : { "ntfs", "exfat", "ext4" })
+    {
+        const auto *fs = mount_options.lookup(name);
+
+        REQUIRE(fs != nullptr);
+        CHECK(mount_options.select_driver(*fs, false, nullptr) == nullptr);
+    }
+}
+
+/*!\test
+ * In-kernel drivers are tried before FUSE drivers, and only available
+ * drivers are tried at all.
+ */
+TEST_CASE("Available drivers are selected in order of preference")
+{
+    Automounter::FSMountOptions mount_options;
+
+    static const char proc_filesystems[] =
+        "nodev\tsysfs\n"
+        "nodev\tproc\n"
+        "\text4\n"
+        "nodev\tfuse\n"
+        "\tfuseblk\n"
+        "\tntfs3\n";
+
+    mount_options.add_kernel_filesystems(proc_filesystems, sizeof(proc_filesystems) - 1);
+    mount_options.add_helper("/sbin/mount.ntfs-3g");
+
+    const auto *ntfs = mount_options.lookup("ntfs");
+    REQUIRE(ntfs != nullptr);
+
+    const auto *drv = mount_options.select_driver(*ntfs, false, nullptr);
+    REQUIRE(drv != nullptr);
+    CHECK(drv->name == std::string("ntfs3"));
+    CHECK(drv->is_kernel_driver());
+
+    drv = mount_options.select_driver(*ntfs, false, drv);
+    REQUIRE(drv != nullptr);
+    CHECK(drv->name == std::string("ntfs-3g"));
+    CHECK_FALSE(drv->is_kernel_driver());
+
+    /* legacy driver is not available */
+    CHECK(mount_options.select_driver(*ntfs, false, drv) == nullptr);
+
+    /* FUSE drivers cannot be used through the kernel mount API */
+    drv = mount_options.select_driver(*ntfs, true, nullptr);
+    REQUIRE(drv != nullptr);
+    CHECK(drv->name == std::string("ntfs3"));
+    CHECK(mount_options.select_driver(*ntfs, true, drv) == nullptr);
+
+    /* no candidate list, mount tool chooses */
+    CHECK(mount_options.select_driver(*mount_options.lookup("ext4"), false, nullptr) == nullptr);
+}
+
+/*!\test
+ * Drivers available as kernel module are selected, FUSE drivers require
+ * their helper program.
+ */
+TEST_CASE("Drivers from kernel modules and FUSE helpers")
+{
+    Automounter::FSMountOptions mount_options;
+
+    const auto *exfat = mount_options.lookup("exfat");
+    REQUIRE(exfat != nullptr);
+
+    mount_options.add_kernel_module("fuse");
+    CHECK(mount_options.select_driver(*exfat, false, nullptr) == nullptr);
+
+    mount_options.add_helper("/sbin/mount.exfat-fuse");
+    const auto *drv = mount_options.select_driver(*exfat, false, nullptr);
+    REQUIRE(drv != nullptr);
+    CHECK(drv->name == std::string("exfat-fuse"));
+
+    mount_options.add_kernel_module("exfat");
+    drv = mount_options.select_driver(*exfat, false, nullptr);
+    REQUIRE(drv != nullptr);
+    CHECK(drv->name == std::string("exfat"));
+    CHECK(drv->options == std::string("-o umask=222,utf8"));
+}
+
+/*!\test
+ * All drivers in the table are visited, for probing.
+ */
+TEST_CASE("Iterate over all drivers")
+{
+    std::vector<std::string> names;
+
+    Automounter::FSMountOptions::for_each_driver(
+        [&names] (const Automounter::FSDriver &drv) { names.emplace_back(drv.name); });
+
+    CHECK(std::find(names.begin(), names.end(), "ntfs3") != names.end());
+    CHECK(std::find(names.begin(), names.end(), "ntfs-3g") != names.end());
+    CHECK(std::find(names.begin(), names.end(), "exfat") != names.end());
+    CHECK(std::find(names.begin(), names.end(), "exfat-fuse") != names.end());
+}
+
+/*!\test
+ * Configured options take precedence over the table, both for file systems
+ * and for drivers.
+ */
+TEST_CASE("Configured mount options replace built-in options")
+{
+    Automounter::FSMountOptions mount_options;
+
+    const auto *exfat = mount_options.lookup("exfat");
+    REQUIRE(exfat != nullptr);
+    REQUIRE(exfat->number_of_drivers > 0);
+    const auto &drv(exfat->drivers[0]);
+
+    CHECK(std::string(mount_options.get_options("ext4")) == "-o errors=continue");
+    CHECK(std::string(mount_options.get_driver_options(drv)) == "-o umask=222,utf8");
+
+    mount_options.set_policy({}, {{"ext4", "-o errors=remount-ro"},
+                                  {"exfat", "-o umask=022"},
+                                  {"btrfs", "-o compress=no"}});
+
+    CHECK(std::string(mount_options.get_options("ext4")) == "-o errors=remount-ro");
+    CHECK(std::string(mount_options.get_options("btrfs")) == "-o compress=no");
+    CHECK(std::string(mount_options.get_options("vfat")) == "-o umask=222,utf8");
+    CHECK(std::string(mount_options.get_driver_options(drv)) == "-o umask=022");
+
+    /* back to defaults */
+    mount_options.set_policy({}, {});
+    CHECK(std::string(mount_options.get_options("ext4")) == "-o errors=continue");
+    CHECK(std::string(mount_options.get_driver_options(drv)) == "-o umask=222,utf8");
+}
+
+/*!\test
+ * All file systems are allowed unless restricted by policy.
+ */
+TEST_CASE("Mounting may be restricted to some file systems")
+{
+    Automounter::FSMountOptions mount_options;
+
+    CHECK(mount_options.is_allowed("ext4"));
+    CHECK(mount_options.is_allowed("ntfs"));
+    CHECK(mount_options.is_allowed("somefs"));
+
+    mount_options.set_policy({"vfat", "exfat"}, {});
+
+    CHECK(mount_options.is_allowed("vfat"));
+    CHECK(mount_options.is_allowed("exfat"));
+    CHECK_FALSE(mount_options.is_allowed("ext4"));
+    CHECK_FALSE(mount_options.is_allowed("ntfs"));
+    CHECK_FALSE(mount_options.is_allowed("somefs"));
+}
+
+TEST_SUITE_END();
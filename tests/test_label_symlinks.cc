@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "label_symlinks.hh"
+
+TEST_SUITE_BEGIN("Label symlinks");
+
+/*!\test
+ * Colliding labels get numbered names, starting at 2.
+ */
+TEST_CASE("Names for colliding labels are numbered")
+{
+    Devices::LabelSymlinks symlinks("");
+
+    CHECK_FALSE(symlinks.is_enabled());
+
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-2");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-3");
+    CHECK(symlinks.reserve_name("Backup") == "Backup");
+
+    CHECK(symlinks.is_name_in_use("MUSIC"));
+    CHECK(symlinks.is_name_in_use("MUSIC-2"));
+    CHECK(symlinks.is_name_in_use("MUSIC-3"));
+    CHECK_FALSE(symlinks.is_name_in_use("MUSIC-4"));
+}
+
+/*!\test
+ * Released names are reused, always picking the smallest free number.
+ */
+TEST_CASE("Released names are reused")
+{
+    Devices::LabelSymlinks symlinks("");
+
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-2");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-3");
+
+    symlinks.release_name("MUSIC-2");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-2");
+
+    symlinks.release_name("MUSIC");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-4");
+}
+
+/*!\test
+ * Numbered names do not grow when labels look like numbered names.
+ */
+TEST_CASE("Labels ending in numbers are numbered like any other label")
+{
+    Devices::LabelSymlinks symlinks("");
+
+    CHECK(symlinks.reserve_name("MUSIC-2") == "MUSIC-2");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-3");
+    CHECK(symlinks.reserve_name("MUSIC-2") == "MUSIC-2-2");
+}
+
+/*!\test
+ * Nothing is created if symlinks are disabled.
+ */
+TEST_CASE("No symlinks are created when disabled")
+{
+    Devices::LabelSymlinks symlinks("");
+
+    CHECK(symlinks.seed());
+    CHECK_FALSE(symlinks.is_enabled());
+
+    std::string name("garbage");
+    CHECK_FALSE(symlinks.create("MUSIC", "/tmp/mounta/1/1", name));
+    CHECK(name.empty());
+    CHECK_FALSE(symlinks.is_name_in_use("MUSIC"));
+}
+
+/*!\test
+ * Switching to another directory forgets all names reserved before.
+ */
+TEST_CASE("Names are forgotten when switching directories")
+{
+    Devices::LabelSymlinks symlinks("");
+
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-2");
+
+    symlinks.reset("");
+    CHECK(symlinks.seed());
+    CHECK(symlinks.get_directory().empty());
+    CHECK_FALSE(symlinks.is_name_in_use("MUSIC"));
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC");
+}
+
+/*!\test
+ * Numbers skipped because another label took the name are used as soon as
+ * that name is released.
+ */
+TEST_CASE("Names released by other labels are reused")
+{
+    Devices::LabelSymlinks symlinks("");
+
+    CHECK(symlinks.reserve_name("MUSIC-2") == "MUSIC-2");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-3");
+
+    symlinks.release_name("MUSIC-2");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-2");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-4");
+
+    /* released number taken by another label in the meantime */
+    symlinks.release_name("MUSIC-3");
+    CHECK(symlinks.reserve_name("MUSIC-3") == "MUSIC-3");
+    CHECK(symlinks.reserve_name("MUSIC") == "MUSIC-5");
+}
+
+/*!\test
+ * Many volumes with the same label get consecutive numbers.
+ */
+TEST_CASE("Many colliding labels")
+{
+    Devices::LabelSymlinks symlinks("");
+
+    CHECK(symlinks.reserve_name("USB") == "USB");
+
+    for(unsigned int i = 2; i <= 1000; ++i)
+        REQUIRE(symlinks.reserve_name("USB") == "USB-" + std::to_string(i));
+
+    symlinks.release_name("USB-500");
+    symlinks.release_name("USB-7");
+    CHECK(symlinks.reserve_name("USB") == "USB-7");
+    CHECK(symlinks.reserve_name("USB") == "USB-500");
+    CHECK(symlinks.reserve_name("USB") == "USB-1001");
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "device_manager.hh"
+#include "external_tools.hh"
+#include "automounter.hh"
+
+#include "mock_messages.hh"
+#include "mock_os.hh"
+#include "mock_devices_os.hh"
+
+#include <array>
+#include <vector>
+#include <new>
+#include <malloc.h>
+
+/* Stuff the linker wants, but we don't need */
+bool os_rmdir(const char *path, bool must_exist)
+{
+    FAIL("Unexpected call");
+    return false;
+}
+
+int os_stat(const char *path, struct stat *buf)
+{
+    FAIL("Unexpected call");
+    return -1;
+}
+
+bool os_mkdir_hierarchy(const char *path, bool must_not_exist)
+{
+    FAIL("Unexpected call");
+    return false;
+}
+
+void os_nanosleep(const struct timespec *tp)
+{
+    FAIL("Unexpected call");
+}
+
+/*
+ * Heap accounting. All allocations made through operator new are tracked by
+ * their usable size so that allocator overhead for small strings shows up in
+ * the numbers as well.
+ */
+static size_t heap_bytes_in_use;
+static size_t heap_allocations;
+
+void *operator new(size_t size)
+{
+    void *p = malloc(size > 0 ? size : 1);
+
+    if(p == nullptr)
+        throw std::bad_alloc();
+
+    heap_bytes_in_use += malloc_usable_size(p);
+    ++heap_allocations;
+
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if(p == nullptr)
+        return;
+
+    heap_bytes_in_use -= malloc_usable_size(p);
+    free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept
+{
+    operator delete(p);
+}
+
+TEST_SUITE_BEGIN("Memory footprint");
+
+static Automounter::ExternalTools tools(
+            Automounter::ExternalTools::Command("/bin/mount",          nullptr),
+            Automounter::ExternalTools::Command("/bin/umount",         nullptr),
+            Automounter::ExternalTools::Command("/usr/bin/mountpoint", "-q"),
+            Automounter::ExternalTools::Command("/bin/udevadm",        nullptr),
+            Automounter::ExternalTools::Command("/bin/findmnt",        "-n"),
+            Automounter::ExternalTools::Command("/usr/bin/tee",        nullptr)
+);
+
+class Fixture
+{
+  protected:
+    std::unique_ptr<MockMessages::Mock> mock_messages;
+    std::unique_ptr<MockOS::Mock> mock_os;
+    std::unique_ptr<MockDevicesOs::Mock> mock_devices_os;
+
+    explicit Fixture():
+        mock_messages(std::make_unique<MockMessages::Mock>()),
+        mock_os(std::make_unique<MockOS::Mock>()),
+        mock_devices_os(std::make_unique<MockDevicesOs::Mock>())
+    {
+        MockMessages::singleton = mock_messages.get();
+        MockOS::singleton = mock_os.get();
+        MockDevicesOs::singleton = mock_devices_os.get();
+    }
+
+    ~Fixture()
+    {
+        try
+        {
+            mock_messages->done();
+            mock_os->done();
+            mock_devices_os->done();
+        }
+        catch(...)
+        {
+            /* no throwing from dtors */
+        }
+
+        MockMessages::singleton = nullptr;
+        MockOS::singleton = nullptr;
+        MockDevicesOs::singleton = nullptr;
+    }
+};
+
+struct FakeVolume
+{
+    const char *const label;
+    const char *const uuid;
+    const char *const fstype;
+};
+
+/*!\test
+ * Report heap and object sizes of devices and volumes.
+ *
+ * The volume data resemble what we typically see on USB sticks and external
+ * disks. Strings stored in the shared string pool are accounted to the pool,
+ * not to the objects which refer to them.
+ */
+TEST_CASE_FIXTURE(Fixture, "Report memory used per device and per volume")
+{
+    static constexpr size_t number_of_devices = 16;
+
+    static constexpr std::array<const FakeVolume, 4> volumes =
+    {
+        FakeVolume{ "MUSIC",         "1A2B-3C4D",                            "vfat" },
+        FakeVolume{ "",              "64A1-0F7E",                            "exfat" },
+        FakeVolume{ "Backup Disk",   "5E8A3B2F8A3B0591",                     "ntfs" },
+        FakeVolume{ "Hi-Res Albums", "9b2f0d6e-3c1a-4e55-8f0b-6a7c2d9e1f34", "ext4" },
+    };
+
+    Devices::SharedData shared(tools, "/run/mount-by-label");
+
+    std::vector<std::string> devlinks;
+    std::vector<std::string> devnames;
+    std::vector<Devices::VolumeInfo> volinfos;
+    std::vector<std::shared_ptr<Devices::Device>> devices;
+
+    for(size_t i = 0; i < number_of_devices; ++i)
+    {
+        devlinks.emplace_back("/dev/disk/by-id/usb-SanDisk_Cruzer_Blade_4C5300012309141171" +
+                              std::to_string(10 + i) + "-0:0");
+
+        for(size_t j = 0; j < volumes.size(); ++j)
+            devnames.emplace_back("/dev/sd" + std::string(1, char('b' + i)) + std::to_string(j + 1));
+    }
+
+    volinfos.reserve(devnames.size());
+
+    devices.reserve(number_of_devices);
+
+    for(const auto &v : volumes)
+        shared.strings_.intern(v.fstype);
+
+    const size_t pool_strings = shared.strings_.size();
+
+    /* devices */
+    const size_t heap_before_devices = heap_bytes_in_use;
+    const size_t allocs_before_devices = heap_allocations;
+
+    for(const auto &devlink : devlinks)
+        devices.emplace_back(std::make_shared<Devices::Device>(Devices::ID(), devlink,
+                                                               false, shared.strings_));
+
+    const size_t device_heap = heap_bytes_in_use - heap_before_devices;
+    const size_t device_allocs = heap_allocations - allocs_before_devices;
+
+    /* volumes */
+    const size_t heap_before_volumes = heap_bytes_in_use;
+    const size_t allocs_before_volumes = heap_allocations;
+
+    for(size_t i = 0; i < devices.size(); ++i)
+    {
+        for(size_t j = 0; j < volumes.size(); ++j)
+        {
+            /* strings allocated here are moved into the volume */
+            volinfos.emplace_back(j + 1, volumes[j].uuid, volumes[j].label, volumes[j].fstype);
+
+            auto &v(volinfos.back());
+            auto vol = std::unique_ptr<Devices::Volume>(
+                new Devices::Volume(devices[i], v.idx,
+                                    std::move(v.label), std::move(v.volume_uuid),
+                                    v.fstype, devnames[i * volumes.size() + j],
+                                    v.size_bytes, shared));
+            REQUIRE(devices[i]->add_volume(std::move(vol)));
+        }
+    }
+
+    const size_t volume_heap = heap_bytes_in_use - heap_before_volumes;
+    const size_t volume_allocs = heap_allocations - allocs_before_volumes;
+    const size_t number_of_volumes = number_of_devices * volumes.size();
+
+    MESSAGE("sizeof(Devices::Device) = " << sizeof(Devices::Device));
+    MESSAGE("sizeof(Devices::Volume) = " << sizeof(Devices::Volume));
+    MESSAGE("Heap per device: " << device_heap / number_of_devices << " bytes in "
+            << double(device_allocs) / number_of_devices << " allocations");
+    MESSAGE("Heap per volume: " << volume_heap / number_of_volumes << " bytes in "
+            << double(volume_allocs) / number_of_volumes << " allocations");
+
+    /* file system types are shared, not copied */
+    CHECK(shared.strings_.size() == pool_strings);
+    CHECK(&devices[0]->begin()->second->get_fstype() ==
+          &devices[1]->begin()->second->get_fstype());
+
+    /* volumes without label use their file system type as label */
+    CHECK(std::next(devices[0]->begin())->second->get_label() == "exfat");
+
+    /* generous upper bounds, just to detect accidental regressions */
+    CHECK(device_heap / number_of_devices < 512);
+    CHECK(volume_heap / number_of_volumes < 512);
+
+    for(const auto &dev : devices)
+        dev->drop_volumes();
+}
+
+/*!\test
+ * Report heap allocations made while attaching devices and their volumes.
+ *
+ * All mock expectations are set up before counting starts, so the numbers
+ * reflect what #Devices::AllDevices::new_entry() allocates by itself plus the
+ * strings copied out of the (mocked) udev information.
+ */
+TEST_CASE_FIXTURE(Fixture, "Report heap allocations per attach")
+{
+    static constexpr size_t number_of_devices = 8;
+    static constexpr size_t number_of_partitions = 4;
+
+    Devices::AllDevices devs(tools, "/run/mount-by-label");
+
+    const Devices::DeviceInfo device_info("",
+            "/sys/devices/platform/soc/3f980000.usb/usb1/1-1/1-1.3/1-1.3:1.0");
+
+    std::vector<std::string> devlinks;
+    std::vector<std::string> devnames;
+    std::vector<Devices::VolumeInfo> volinfos;
+
+    devlinks.reserve(number_of_devices * (number_of_partitions + 1));
+    devnames.reserve(number_of_devices * (number_of_partitions + 1));
+    volinfos.reserve(number_of_devices * number_of_partitions);
+
+    for(size_t i = 0; i < number_of_devices; ++i)
+    {
+        const std::string devlink =
+            "/dev/disk/by-id/usb-Generic_Flash_Disk_8A3B2F" + std::to_string(10 + i) + "-0:0";
+        const std::string devname = "/dev/sd" + std::string(1, char('b' + i));
+
+        devlinks.push_back(devlink);
+        devnames.push_back(devname);
+
+        expect<MockOS::ResolveSymlink>(mock_os, devnames.back().c_str(), 0, devlinks.back().c_str());
+        expect<MockDevicesOs::GetVolumeInformation>(mock_devices_os, devname.c_str(), nullptr);
+        expect<MockDevicesOs::GetDeviceInformation>(mock_devices_os, devlink.c_str(), &device_info);
+
+        for(size_t j = 1; j <= number_of_partitions; ++j)
+        {
+            devlinks.push_back(devlink + "-part" + std::to_string(j));
+            devnames.push_back(devname + std::to_string(j));
+            volinfos.emplace_back(j, "9b2f0d6e-3c1a-4e55-8f0b-6a7c2d9e1f3" + std::to_string(j),
+                                  "Hi-Res Albums", "vfat");
+
+            expect<MockOS::ResolveSymlink>(mock_os, devnames.back().c_str(), 0, devlinks.back().c_str());
+            expect<MockDevicesOs::GetVolumeInformation>(mock_devices_os, devnames.back().c_str(),
+                                                        &volinfos.back());
+        }
+    }
+
+    size_t device_allocs = 0;
+    size_t volume_allocs = 0;
+
+    for(size_t i = 0; i < devlinks.size(); ++i)
+    {
+        const bool is_device = (i % (number_of_partitions + 1)) == 0;
+        const size_t allocs_before = heap_allocations;
+
+        Devices::Volume *volume;
+        bool have_probed_dev;
+        const auto dev = devs.new_entry(devlinks[i].c_str(), volume, have_probed_dev);
+
+        if(is_device)
+            device_allocs += heap_allocations - allocs_before;
+        else
+            volume_allocs += heap_allocations - allocs_before;
+
+        REQUIRE(dev != nullptr);
+        CHECK(have_probed_dev == is_device);
+        CHECK((volume == nullptr) == is_device);
+    }
+
+    MESSAGE("Allocations per device attach: "
+            << double(device_allocs) / number_of_devices);
+    MESSAGE("Allocations per volume attach: "
+            << double(volume_allocs) / (number_of_devices * number_of_partitions));
+
+    /*
+     * Measured with libstdc++ on x86_64. Before pooling and reusing
+     * temporaries while attaching, a device attach took 8.25 allocations and
+     * a volume attach 6.03; now they take about 7.4 and 3.0, respectively.
+     * The bounds below sit between these figures so that falling back to the
+     * old behavior is noticed.
+     */
+    CHECK(device_allocs <= 8 * number_of_devices);
+    CHECK(volume_allocs <= 4 * number_of_devices * number_of_partitions);
+
+    for(const auto &it : devs)
+        it.second->drop_volumes();
+}
+
+TEST_SUITE_END();
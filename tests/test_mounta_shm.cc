@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <cstring>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+#include "mounta_shm.h"
+#pragma GCC diagnostic pop
+
+TEST_SUITE_BEGIN("Shared memory snapshot");
+
+/* the object is large, so keep it off the stack */
+static std::unique_ptr<struct mounta_shm> mk_shm()
+{
+    std::unique_ptr<struct mounta_shm> shm(new struct mounta_shm);
+    memset(shm.get(), 0, sizeof(*shm));
+    shm->magic = MOUNTA_SHM_MAGIC;
+    shm->version = MOUNTA_SHM_VERSION;
+    shm->size = sizeof(*shm);
+    return shm;
+}
+
+/*!\test
+ * Readers get a copy of what has been written between begin and end.
+ */
+TEST_CASE("Completed modification is read back")
+{
+    auto shm(mk_shm());
+    std::unique_ptr<struct mounta_shm_table> table(new struct mounta_shm_table);
+
+    mounta_shm_write_begin(shm.get());
+    CHECK(shm->sequence == 1);
+    shm->table.generation = 7;
+    shm->table.number_of_devices = 1;
+    shm->table.devices[0].id = 3;
+    strcpy(shm->table.devices[0].name, "usb-Stick-0:0");
+    mounta_shm_write_end(shm.get());
+    CHECK(shm->sequence == 2);
+
+    REQUIRE(mounta_shm_read(shm.get(), table.get()) == 0);
+    CHECK(table->generation == 7);
+    CHECK(table->number_of_devices == 1);
+    CHECK(table->devices[0].id == 3);
+    CHECK(std::string(table->devices[0].name) == "usb-Stick-0:0");
+    CHECK(mounta_shm_get_generation(shm.get()) == 7);
+}
+
+/*!\test
+ * A table which is being written is never returned.
+ */
+TEST_CASE("Table is not read while being modified")
+{
+    auto shm(mk_shm());
+    std::unique_ptr<struct mounta_shm_table> table(new struct mounta_shm_table);
+
+    mounta_shm_write_begin(shm.get());
+    shm->table.generation = 1;
+
+    CHECK(mounta_shm_read(shm.get(), table.get()) == -1);
+
+    mounta_shm_write_end(shm.get());
+
+    REQUIRE(mounta_shm_read(shm.get(), table.get()) == 0);
+    CHECK(table->generation == 1);
+}
+
+/*!\test
+ * Structure sizes are part of the ABI and must only change together with
+ * #MOUNTA_SHM_VERSION.
+ */
+TEST_CASE("Layout of shared memory object is stable")
+{
+    CHECK(sizeof(struct mounta_shm_device) == 696);
+    CHECK(sizeof(struct mounta_shm_volume) == 320);
+    CHECK(offsetof(struct mounta_shm, table) == 16);
+}
+
+TEST_SUITE_END();
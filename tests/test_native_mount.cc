@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include <sys/mount.h>
+
+#include "native_mount.hh"
+
+TEST_SUITE_BEGIN("Native mount");
+
+using Options = std::vector<Automounter::MountOption>;
+
+/*!\test
+ * Options from the file system table are split into keys and values.
+ */
+TEST_CASE("Mount tool options are translated to kernel options")
+{
+    Options options;
+
+    REQUIRE(Automounter::parse_mount_tool_options("-o umask=222,utf8", options));
+    REQUIRE(options.size() == 2);
+    CHECK(options[0].first == "umask");
+    CHECK(options[0].second == "222");
+    CHECK(options[1].first == "utf8");
+    CHECK(options[1].second.empty());
+
+    options.clear();
+    REQUIRE(Automounter::parse_mount_tool_options("-oerrors=continue -o  nls=utf8", options));
+    REQUIRE(options.size() == 2);
+    CHECK(options[0].first == "errors");
+    CHECK(options[0].second == "continue");
+    CHECK(options[1].first == "nls");
+    CHECK(options[1].second == "utf8");
+}
+
+/*!\test
+ * No options at all is fine.
+ */
+TEST_CASE("Empty mount tool options")
+{
+    Options options;
+
+    CHECK(Automounter::parse_mount_tool_options("", options));
+    CHECK(Automounter::parse_mount_tool_options("  ", options));
+    CHECK(Automounter::parse_mount_tool_options(nullptr, options));
+    CHECK(options.empty());
+}
+
+/*!\test
+ * Anything but \c -o cannot be passed to the kernel.
+ */
+TEST_CASE("Untranslatable mount tool options are rejected")
+{
+    Options options;
+
+    CHECK_FALSE(Automounter::parse_mount_tool_options("-t vfat", options));
+    CHECK_FALSE(Automounter::parse_mount_tool_options("-o", options));
+    CHECK_FALSE(Automounter::parse_mount_tool_options("-o a,,b", options));
+    CHECK_FALSE(Automounter::parse_mount_tool_options("-o =x", options));
+    CHECK_FALSE(Automounter::parse_mount_tool_options("-o ro --bind", options));
+}
+
+/*!\test
+ * The default options of the mount tool end up as flags only.
+ */
+TEST_CASE("Generic mount options are taken out as mount flags")
+{
+    Options options;
+    unsigned long flags = 0;
+
+    REQUIRE(Automounter::parse_mount_tool_options("-o ro,noexec,nosuid,nodev,user", options));
+    Automounter::extract_mount_flags(options, flags);
+    CHECK(options.empty());
+    CHECK(flags == (MS_RDONLY | MS_NOEXEC | MS_NOSUID | MS_NODEV));
+}
+
+/*!\test
+ * Later options override earlier ones and flags passed in, options of the
+ * file system driver are kept in order.
+ */
+TEST_CASE("Generic mount options override flags and leave others alone")
+{
+    Options options;
+    unsigned long flags = MS_RDONLY | MS_NOEXEC;
+
+    REQUIRE(Automounter::parse_mount_tool_options("-o rw,noatime,defaults -o umask=222,utf8,exec", options));
+    Automounter::extract_mount_flags(options, flags);
+    REQUIRE(options.size() == 2);
+    CHECK(options[0].first == "umask");
+    CHECK(options[0].second == "222");
+    CHECK(options[1].first == "utf8");
+    CHECK(flags == MS_NOATIME);
+
+    options = Options{{"ro", "1"}};
+    flags = 0;
+    Automounter::extract_mount_flags(options, flags);
+    CHECK(options.size() == 1);
+    CHECK(flags == 0);
+}
+
+/*!\test
+ * Data argument for \c mount(2) is the comma-separated option list.
+ */
+TEST_CASE("Data for mount(2) system call")
+{
+    CHECK(Automounter::mk_mount_data(Options()).empty());
+    CHECK(Automounter::mk_mount_data(Options{{"umask", "222"}, {"utf8", ""}}) == "umask=222,utf8");
+}
+
+/*!\test
+ * Options are checked before anything is done by the kernel.
+ */
+TEST_CASE("Native mount fails with untranslatable options")
+{
+    const Automounter::NativeMountRequest request("/dev/sdx1", "/nonexistent/1",
+                                                  "vfat", "--bind",
+                                                  0);
+    std::string error_message;
+
+    CHECK_FALSE(Automounter::mount_native(request, error_message));
+    CHECK(error_message == "Cannot translate mount options \"--bind\"");
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "notify_socket.hh"
+
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+#include <unistd.h>
+
+TEST_SUITE_BEGIN("Service manager notification");
+
+/*!\test
+ * Path names are zero-terminated, abstract names are not.
+ */
+TEST_CASE("Notification socket addresses")
+{
+    struct sockaddr_un addr;
+    socklen_t length;
+
+    REQUIRE(Automounter::mk_notify_socket_address("/run/systemd/notify", addr, length));
+    CHECK(addr.sun_family == AF_UNIX);
+    CHECK(std::string(addr.sun_path) == "/run/systemd/notify");
+    CHECK(length == offsetof(struct sockaddr_un, sun_path) + 20);
+
+    REQUIRE(Automounter::mk_notify_socket_address("@notify", addr, length));
+    CHECK(addr.sun_path[0] == '\0');
+    CHECK(std::string(addr.sun_path + 1, 6) == "notify");
+    CHECK(length == offsetof(struct sockaddr_un, sun_path) + 7);
+}
+
+/*!\test
+ * Relative paths, empty names, and names too long for a socket address are
+ * not accepted.
+ */
+TEST_CASE("Invalid notification socket addresses are rejected")
+{
+    struct sockaddr_un addr;
+    socklen_t length = 0;
+
+    CHECK_FALSE(Automounter::mk_notify_socket_address(nullptr, addr, length));
+    CHECK_FALSE(Automounter::mk_notify_socket_address("", addr, length));
+    CHECK_FALSE(Automounter::mk_notify_socket_address("@", addr, length));
+    CHECK_FALSE(Automounter::mk_notify_socket_address("run/notify", addr, length));
+    CHECK_FALSE(Automounter::mk_notify_socket_address(
+                    ("/" + std::string(sizeof(addr.sun_path), 'x')).c_str(),
+                    addr, length));
+    CHECK(length == 0);
+}
+
+/*!\test
+ * The state is sent as a single datagram to the socket named in the
+ * environment.
+ */
+TEST_CASE("Readiness is sent to service manager")
+{
+    const std::string name("@mounta-test-notify-" + std::to_string(getpid()));
+
+    struct sockaddr_un addr;
+    socklen_t length;
+    REQUIRE(Automounter::mk_notify_socket_address(name.c_str(), addr, length));
+
+    const int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    REQUIRE(fd >= 0);
+    REQUIRE(bind(fd, reinterpret_cast<const struct sockaddr *>(&addr), length) == 0);
+
+    unsetenv("NOTIFY_SOCKET");
+    CHECK_FALSE(Automounter::notify_service_manager("READY=1"));
+
+    setenv("NOTIFY_SOCKET", name.c_str(), 1);
+    CHECK(Automounter::notify_service_manager("READY=1"));
+    unsetenv("NOTIFY_SOCKET");
+
+    char buffer[64];
+    const ssize_t received = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    close(fd);
+
+    REQUIRE(received > 0);
+    CHECK(std::string(buffer, received) == "READY=1");
+}
+
+TEST_SUITE_END();
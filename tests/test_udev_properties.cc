@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "udev_properties.hh"
+
+TEST_SUITE_BEGIN("udev properties");
+
+using Key = Devices::UdevProperties::Key;
+
+static const char udevadm_whole_disk[] =
+    "P: /devices/platform/soc/3f980000.usb/usb1/1-1/1-1.3/1-1.3:1.0/host0/target0:0:0/0:0:0:0/block/sda\n"
+    "N: sda\n"
+    "L: 0\n"
+    "S: disk/by-id/usb-SanDisk_Cruzer_Blade_4C530001230914117151-0:0\n"
+    "E: DEVPATH=/devices/platform/soc/3f980000.usb/usb1/1-1/1-1.3/1-1.3:1.0/host0/target0:0:0/0:0:0:0/block/sda\n"
+    "E: DEVNAME=/dev/sda\n"
+    "E: DEVTYPE=disk\n"
+    "E: ID_VENDOR=SanDisk\n"
+    "E: ID_MODEL=Cruzer_Blade\n"
+    "E: ID_SERIAL=SanDisk_Cruzer_Blade_4C530001230914117151-0:0\n"
+    "E: ID_SERIAL_SHORT=4C530001230914117151\n"
+    "E: ID_BUS=usb\n"
+    "E: ID_PART_TABLE_UUID=7b1c3a7e\n"
+    "E: ID_PART_TABLE_TYPE=dos\n"
+    "E: SUBSYSTEM=block\n"
+    "\n";
+
+static const char udevadm_partition[] =
+    "P: /devices/platform/soc/3f980000.usb/usb1/1-1/1-1.3/1-1.3:1.0/host0/target0:0:0/0:0:0:0/block/sda/sda1\n"
+    "N: sda1\n"
+    "E: DEVNAME=/dev/sda1\n"
+    "E: DEVTYPE=partition\n"
+    "E: ID_PART_TABLE_UUID=7b1c3a7e\n"
+    "E: ID_PART_TABLE_TYPE=dos\n"
+    "E: ID_FS_LABEL=MUSIC\n"
+    "E: ID_FS_LABEL_ENC=MUSIC\n"
+    "E: ID_FS_UUID=1A2B-3C4D\n"
+    "E: ID_FS_UUID_ENC=1A2B-3C4D\n"
+    "E: ID_FS_VERSION=FAT32\n"
+    "E: ID_FS_TYPE=vfat\n"
+    "E: ID_FS_USAGE=filesystem\n"
+    "E: ID_PART_ENTRY_UUID=7b1c3a7e-01\n"
+    "E: ID_PART_ENTRY_TYPE=0xc\n";
+
+/*!\test
+ * All properties of interest are extracted from a single pass over the
+ * output for a whole disk.
+ */
+TEST_CASE("Parse udevadm output for whole disk")
+{
+    Devices::UdevProperties props;
+
+    props.parse(udevadm_whole_disk, sizeof(udevadm_whole_disk) - 1);
+
+    CHECK(props.get(Key::DEVPATH) == "/devices/platform/soc/3f980000.usb/usb1/1-1/1-1.3/1-1.3:1.0/host0/target0:0:0/0:0:0:0/block/sda");
+    CHECK(props.get(Key::PART_TABLE_UUID) == "7b1c3a7e");
+    CHECK(props.get(Key::PART_ENTRY_UUID).empty());
+    CHECK(props.get(Key::FS_UUID).empty());
+    CHECK(props.get(Key::FS_LABEL).empty());
+    CHECK(props.get(Key::FS_TYPE).empty());
+    CHECK(props.get_number_of_unexpected_lines() == 0);
+
+    CHECK(props.get_best_uuid(true) == "7b1c3a7e");
+    CHECK(props.get_best_uuid(false).empty());
+
+    CHECK(props.get(Key::VENDOR) == "SanDisk");
+    CHECK(props.get(Key::MODEL) == "Cruzer_Blade");
+    CHECK(props.get(Key::SERIAL_SHORT) == "4C530001230914117151");
+}
+
+/*!\test
+ * File system UUID is preferred over partition UUIDs, and keys which are
+ * prefixes of other keys are not confused.
+ */
+TEST_CASE("Parse udevadm output for partition")
+{
+    Devices::UdevProperties props;
+
+    /* no trailing newline */
+    props.parse(udevadm_partition, sizeof(udevadm_partition) - 2);
+
+    CHECK(props.get(Key::PART_TABLE_UUID) == "7b1c3a7e");
+    CHECK(props.get(Key::PART_ENTRY_UUID) == "7b1c3a7e-01");
+    CHECK(props.get(Key::FS_UUID) == "1A2B-3C4D");
+    CHECK(props.get(Key::FS_LABEL) == "MUSIC");
+    CHECK(props.get(Key::FS_TYPE) == "vfat");
+    CHECK(props.get_number_of_unexpected_lines() == 0);
+
+    CHECK(props.get_best_uuid(true) == "1A2B-3C4D");
+    CHECK(props.get_best_uuid(false) == "1A2B-3C4D");
+}
+
+/*!\test
+ * Parsing new output discards previous results.
+ */
+TEST_CASE("Parsing again replaces old properties")
+{
+    Devices::UdevProperties props;
+
+    props.parse(udevadm_partition, sizeof(udevadm_partition) - 1);
+    props.parse(udevadm_whole_disk, sizeof(udevadm_whole_disk) - 1);
+
+    CHECK(props.get(Key::FS_UUID).empty());
+    CHECK(props.get(Key::FS_LABEL).empty());
+    CHECK(props.get(Key::FS_TYPE).empty());
+    CHECK(props.get_best_uuid(true) == "7b1c3a7e");
+}
+
+/*!\test
+ * Garbage is counted, but does not stop parsing.
+ */
+TEST_CASE("Unexpected lines are counted and skipped")
+{
+    static const char output[] =
+        "Unknown device, --name=, --path=, or absolute path in /dev/ or /sys expected.\n"
+        "E: ID_FS_TYPE=exfat\n"
+        "E:ID_FS_LABEL=broken\n"
+        "E: ID_FS_UUID\n"
+        "E: ID_FS_UUID=64A1-0F7E\n";
+
+    Devices::UdevProperties props;
+
+    props.parse(output, sizeof(output) - 1);
+
+    CHECK(props.get(Key::FS_TYPE) == "exfat");
+    CHECK(props.get(Key::FS_LABEL).empty());
+    CHECK(props.get(Key::FS_UUID) == "64A1-0F7E");
+    CHECK(props.get_number_of_unexpected_lines() == 2);
+}
+
+/*!\test
+ * Empty output yields no properties.
+ */
+TEST_CASE("Parse empty udevadm output")
+{
+    Devices::UdevProperties props;
+
+    props.parse("", 0);
+
+    CHECK(props.get(Key::DEVPATH).empty());
+    CHECK(props.get_best_uuid(true).empty());
+    CHECK(props.get_number_of_unexpected_lines() == 0);
+}
+
+/*!\test
+ * Property values refer to an internal copy of the output, so they neither
+ * depend on the input buffer nor on the object's address.
+ */
+TEST_CASE("Property values survive input buffer and move")
+{
+    std::string output(udevadm_partition);
+    Devices::UdevProperties props;
+
+    props.parse(output.c_str(), output.length());
+    output.assign(output.length(), 'x');
+
+    const Devices::UdevProperties moved(std::move(props));
+
+    CHECK(moved.get(Key::FS_LABEL) == "MUSIC");
+    CHECK(moved.get(Key::FS_TYPE) == "vfat");
+    CHECK(moved.get(Key::FS_TYPE).str() == "vfat");
+    CHECK_FALSE(moved.get(Key::FS_TYPE) == "vfa");
+    CHECK_FALSE(moved.get(Key::FS_TYPE) == "vfat32");
+}
+
+TEST_SUITE_END();
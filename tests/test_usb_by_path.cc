@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "usb_by_path.hh"
+#include "usb_topology.hh"
+
+TEST_SUITE_BEGIN("USB ports from /dev/disk/by-path");
+
+/*!\test
+ * Host controller and port path are taken from platform and PCI names.
+ */
+TEST_CASE("Parse by-path link names")
+{
+    static const char platform[] = "platform-3f980000.usb-usb-0:1.5:1.0-scsi-0:0:0:0";
+    static const char platform_dash[] = "platform-xhci-hcd.0.auto-usb-0:1:1.0-scsi-0:0:0:1";
+    static const char pci[] = "pci-0000:00:14.0-usb-0:2:1.0-scsi-0:0:0:0";
+    static const char pci_behind_platform[] =
+        "platform-fd500000.pcie-pci-0000:01:00.0-usb-0:2.4.1:1.0-scsi-0:0:0:0";
+
+    std::string controller;
+    std::string port_path;
+
+    REQUIRE(Devices::parse_usb_by_path_name(platform, sizeof(platform) - 1,
+                                            controller, port_path));
+    CHECK(controller == "3f980000.usb");
+    CHECK(port_path == "1.5:1.0");
+
+    REQUIRE(Devices::parse_usb_by_path_name(platform_dash, sizeof(platform_dash) - 1,
+                                            controller, port_path));
+    CHECK(controller == "xhci-hcd.0.auto");
+    CHECK(port_path == "1:1.0");
+
+    REQUIRE(Devices::parse_usb_by_path_name(pci, sizeof(pci) - 1,
+                                            controller, port_path));
+    CHECK(controller == "0000:00:14.0");
+    CHECK(port_path == "2:1.0");
+
+    REQUIRE(Devices::parse_usb_by_path_name(pci_behind_platform, sizeof(pci_behind_platform) - 1,
+                                            controller, port_path));
+    CHECK(controller == "0000:01:00.0");
+    CHECK(port_path == "2.4.1:1.0");
+}
+
+/*!\test
+ * Partitions and devices not connected via USB are not put into the map.
+ */
+TEST_CASE("Non-USB and partition links are ignored")
+{
+    Devices::UsbByPath by_path;
+
+    CHECK_FALSE(by_path.add("platform-3f980000.usb-usb-0:1.5:1.0-scsi-0:0:0:0-part1", "/dev/sda1"));
+    CHECK_FALSE(by_path.add("pci-0000:00:17.0-ata-1", "/dev/sdb"));
+    CHECK_FALSE(by_path.add("platform-fe340000.mmc", "/dev/mmcblk0"));
+    CHECK(by_path.size() == 0);
+}
+
+/*!\test
+ * Links are added and removed by name, and looked up by block device.
+ */
+TEST_CASE("Maintain map of block devices to USB locations")
+{
+    Devices::UsbByPath by_path;
+
+    REQUIRE(by_path.add("platform-3f980000.usb-usb-0:1.5:1.0-scsi-0:0:0:0", "/dev/sda"));
+    REQUIRE(by_path.add("platform-3f980000.usb-usb-0:1.3:1.0-scsi-0:0:0:0", "/dev/sdb"));
+    CHECK(by_path.size() == 2);
+
+    const auto *entry = by_path.find("/dev/sda");
+    REQUIRE(entry != nullptr);
+    CHECK(entry->controller_ == "3f980000.usb");
+    CHECK(entry->port_path_ == "1.5:1.0");
+
+    by_path.remove("platform-3f980000.usb-usb-0:1.5:1.0-scsi-0:0:0:0");
+    CHECK(by_path.find("/dev/sda") == nullptr);
+    CHECK(by_path.find("/dev/sdb") != nullptr);
+    CHECK(by_path.size() == 1);
+}
+
+/*!\test
+ * Ports resolved through sysfs before are found again by their by-path
+ * location.
+ */
+TEST_CASE("Find cached USB port by by-path location")
+{
+    static const char stick[] =
+        "../../devices/platform/soc/3f980000.usb/usb1/1-1/1-1.5/1-1.5:1.0/"
+        "host0/target0:0:0/0:0:0:0/block/sda";
+
+    Devices::UsbTopology topology;
+    Devices::UsbPort port;
+
+    CHECK_FALSE(topology.find_cached("3f980000.usb", "1.5:1.0", port));
+
+    REQUIRE(topology.resolve_link_target(stick, sizeof(stick) - 1, port));
+
+    Devices::UsbPort cached;
+
+    REQUIRE(topology.find_cached("3f980000.usb", "1.5:1.0", cached));
+    CHECK(cached.interface_path_ == port.interface_path_);
+    CHECK(cached.chain_ == "1-1.5");
+    CHECK(cached.bus_ == 1);
+
+    CHECK_FALSE(topology.find_cached("3f980000.usb", "1.3:1.0", cached));
+    CHECK_FALSE(topology.find_cached("3f980000.usb", "5:1.0", cached));
+    CHECK_FALSE(topology.find_cached("0000:00:14.0", "1.5:1.0", cached));
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "usb_topology.hh"
+
+TEST_SUITE_BEGIN("USB topology");
+
+static const char stick_behind_hub[] =
+    "../../devices/platform/soc/3f980000.usb/usb1/1-1/1-1.5/1-1.5:1.0/"
+    "host0/target0:0:0/0:0:0:0/block/sda";
+
+/*!\test
+ * Hub and port chain, bus number, and depth are taken from the USB interface
+ * node in the sysfs path.
+ */
+TEST_CASE("Parse USB port from sysfs path")
+{
+    static const char path[] =
+        "/sys/devices/platform/scb/fd500000.pcie/pci0000:00/0000:00:00.0/"
+        "0000:01:00.0/usb2/2-2/2-2.4/2-2.4.1/2-2.4.1:1.0/"
+        "host2/target2:0:0/2:0:0:0/block/sdc/sdc1";
+
+    Devices::UsbPort port;
+
+    REQUIRE(Devices::parse_usb_topology(path, sizeof(path) - 1, port));
+    CHECK(port.interface_path_ ==
+          "/sys/devices/platform/scb/fd500000.pcie/pci0000:00/0000:00:00.0/"
+          "0000:01:00.0/usb2/2-2/2-2.4/2-2.4.1/2-2.4.1:1.0");
+    CHECK(port.chain_ == "2-2.4.1");
+    CHECK(port.bus_ == 2);
+    CHECK(port.depth_ == 3);
+}
+
+/*!\test
+ * Devices not connected via USB are not resolved.
+ */
+TEST_CASE("Non-USB sysfs paths are rejected")
+{
+    static const char ata[] =
+        "/sys/devices/pci0000:00/0000:00:17.0/ata1/host0/target0:0:0/0:0:0:0/block/sda";
+    static const char mmc[] =
+        "/sys/devices/platform/emmc2bus/fe340000.mmc/mmc_host/mmc0/mmc0:aaaa/block/mmcblk0";
+    static const char no_device_node[] =
+        "/sys/devices/platform/usb1/1-1.5:1.0/host0/target0:0:0/0:0:0:0/block/sda";
+
+    Devices::UsbPort port;
+
+    CHECK_FALSE(Devices::parse_usb_topology(ata, sizeof(ata) - 1, port));
+    CHECK_FALSE(Devices::parse_usb_topology(mmc, sizeof(mmc) - 1, port));
+    CHECK_FALSE(Devices::parse_usb_topology(no_device_node, sizeof(no_device_node) - 1, port));
+    CHECK(port.chain_.empty());
+}
+
+/*!\test
+ * Symlink targets in /sys/dev/block are relative, and resolved ports are
+ * cached for further block devices on the same USB interface.
+ */
+TEST_CASE("Resolve block device link targets with cache")
+{
+    static const char second_lun[] =
+        "../../devices/platform/soc/3f980000.usb/usb1/1-1/1-1.5/1-1.5:1.0/"
+        "host0/target0:0:0/0:0:0:1/block/sdb";
+    static const char other_port[] =
+        "../../devices/platform/soc/3f980000.usb/usb1/1-1/1-1.3/1-1.3:1.0/"
+        "host1/target1:0:0/1:0:0:0/block/sdc";
+
+    Devices::UsbTopology topology;
+    Devices::UsbPort port;
+
+    REQUIRE(topology.resolve_link_target(stick_behind_hub, sizeof(stick_behind_hub) - 1, port));
+    CHECK(port.interface_path_ == "/sys/devices/platform/soc/3f980000.usb/usb1/1-1/1-1.5/1-1.5:1.0");
+    CHECK(port.chain_ == "1-1.5");
+    CHECK(port.bus_ == 1);
+    CHECK(port.depth_ == 2);
+    CHECK(topology.get_number_of_cached_ports() == 1);
+
+    Devices::UsbPort cached;
+
+    REQUIRE(topology.resolve_link_target(second_lun, sizeof(second_lun) - 1, cached));
+    CHECK(cached.interface_path_ == port.interface_path_);
+    CHECK(cached.chain_ == "1-1.5");
+    CHECK(topology.get_number_of_cached_ports() == 1);
+
+    REQUIRE(topology.resolve_link_target(other_port, sizeof(other_port) - 1, port));
+    CHECK(port.chain_ == "1-1.3");
+    CHECK(topology.get_number_of_cached_ports() == 2);
+}
+
+/*!\test
+ * An interface node which is a prefix of another one must not match.
+ */
+TEST_CASE("Cached interface path must match whole path components")
+{
+    static const char port_1_1_1[] =
+        "../../devices/usb1/1-1/1-1:1.0/host0/target0:0:0/0:0:0:0/block/sda";
+    static const char port_1_1_10[] =
+        "../../devices/usb1/1-1/1-1:1.00/host1/target1:0:0/1:0:0:0/block/sdb";
+
+    Devices::UsbTopology topology;
+    Devices::UsbPort port;
+
+    REQUIRE(topology.resolve_link_target(port_1_1_1, sizeof(port_1_1_1) - 1, port));
+    REQUIRE(topology.resolve_link_target(port_1_1_10, sizeof(port_1_1_10) - 1, port));
+    CHECK(port.interface_path_ == "/sys/devices/usb1/1-1/1-1:1.00");
+    CHECK(topology.get_number_of_cached_ports() == 2);
+}
+
+/*!\test
+ * Ports are switched off through their hub, which is the root hub for
+ * devices plugged directly into the host.
+ */
+TEST_CASE("Path to port disable attribute is derived from port chain")
+{
+    CHECK(Devices::mk_usb_port_disable_path("1-1.5") ==
+          "/sys/bus/usb/devices/1-1:1.0/1-1-port5/disable");
+    CHECK(Devices::mk_usb_port_disable_path("2-2.4.1") ==
+          "/sys/bus/usb/devices/2-2.4:1.0/2-2.4-port1/disable");
+    CHECK(Devices::mk_usb_port_disable_path("1-3") ==
+          "/sys/bus/usb/devices/1-0:1.0/usb1-port3/disable");
+    CHECK(Devices::mk_usb_port_disable_path("3-12", "/tmp/sys") ==
+          "/tmp/sys/bus/usb/devices/3-0:1.0/usb3-port12/disable");
+}
+
+/*!\test
+ * Anything which is not a hub and port chain is rejected, in particular
+ * strings which could do harm in a shell command.
+ */
+TEST_CASE("Invalid port chains yield no disable attribute path")
+{
+    CHECK(Devices::mk_usb_port_disable_path("").empty());
+    CHECK(Devices::mk_usb_port_disable_path("1").empty());
+    CHECK(Devices::mk_usb_port_disable_path("1-").empty());
+    CHECK(Devices::mk_usb_port_disable_path("-1").empty());
+    CHECK(Devices::mk_usb_port_disable_path("1-1.").empty());
+    CHECK(Devices::mk_usb_port_disable_path("1-1..5").empty());
+    CHECK(Devices::mk_usb_port_disable_path("1-1-5").empty());
+    CHECK(Devices::mk_usb_port_disable_path("1-1;reboot").empty());
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "devices.hh"
+#include "fsmount_options.hh"
+#include "external_tools.hh"
+
+#include "mock_messages.hh"
+#include "mock_os.hh"
+#include "mock_devices_os.hh"
+
+#include <vector>
+
+/* Directories are only created and removed in memory */
+static std::vector<std::string> created_directories;
+static std::vector<std::string> removed_directories;
+static bool fail_mkdir;
+
+bool os_mkdir_hierarchy(const char *path, bool must_not_exist)
+{
+    if(fail_mkdir)
+        return false;
+
+    created_directories.emplace_back(path);
+    return true;
+}
+
+bool os_rmdir(const char *path, bool must_exist)
+{
+    removed_directories.emplace_back(path);
+    return true;
+}
+
+int os_stat(const char *path, struct stat *buf)
+{
+    FAIL("Unexpected call");
+    return -1;
+}
+
+void os_nanosleep(const struct timespec *tp)
+{
+    FAIL("Unexpected call");
+}
+
+/*
+ * State transitions of #Devices::Volume for mounts and unmounts run in the
+ * background.
+ */
+TEST_SUITE_BEGIN("Volume states");
+
+static Automounter::ExternalTools tools(
+            Automounter::ExternalTools::Command("/bin/mount",          "-r"),
+            Automounter::ExternalTools::Command("/bin/umount",         nullptr),
+            Automounter::ExternalTools::Command("/usr/bin/mountpoint", "-q"),
+            Automounter::ExternalTools::Command("/bin/udevadm",        nullptr),
+            Automounter::ExternalTools::Command("/bin/findmnt",        "-n"),
+            Automounter::ExternalTools::Command("/usr/bin/tee",        nullptr)
+);
+
+class Fixture
+{
+  protected:
+    std::unique_ptr<MockMessages::Mock> mock_messages;
+    std::unique_ptr<MockOS::Mock> mock_os;
+    std::unique_ptr<MockDevicesOs::Mock> mock_devices_os;
+
+    const Automounter::FSMountOptions mount_options;
+    Devices::SharedData shared;
+    std::shared_ptr<Devices::Device> device;
+
+    explicit Fixture():
+        mock_messages(std::make_unique<MockMessages::Mock>()),
+        mock_os(std::make_unique<MockOS::Mock>()),
+        mock_devices_os(std::make_unique<MockDevicesOs::Mock>()),
+        shared(tools, std::string()),
+        device(std::make_shared<Devices::Device>(Devices::ID(), "usb-Disk_0:0",
+                                                 false, shared.strings_))
+    {
+        MockMessages::singleton = mock_messages.get();
+        MockOS::singleton = mock_os.get();
+        MockDevicesOs::singleton = mock_devices_os.get();
+
+        created_directories.clear();
+        removed_directories.clear();
+        fail_mkdir = false;
+
+        /* externally managed, so that no residual directories are searched
+         * for when the device is destroyed */
+        device->accept();
+        device->set_mountpoint_directory("/run/MounTA/1");
+    }
+
+    ~Fixture()
+    {
+        device = nullptr;
+
+        try
+        {
+            mock_messages->done();
+            mock_os->done();
+            mock_devices_os->done();
+        }
+        catch(...)
+        {
+            /* no throwing from dtors */
+        }
+
+        MockMessages::singleton = nullptr;
+        MockOS::singleton = nullptr;
+        MockDevicesOs::singleton = nullptr;
+    }
+
+    std::unique_ptr<Devices::Volume> mk_volume(int idx, const char *devname)
+    {
+        return std::make_unique<Devices::Volume>(device, idx, "Label",
+                                                 "0c1f8cb8-4c2e-4c23-8fe5-ea8a2b309598",
+                                                 "ext4", devname, 0, shared);
+    }
+};
+
+/*!\test
+ * Volume goes through all states of a successful mount and unmount.
+ */
+TEST_CASE_FIXTURE(Fixture, "Volume is mounted and unmounted in the background")
+{
+    auto vol(mk_volume(1, "/dev/sdx1"));
+    REQUIRE(vol->get_state() == Devices::Volume::PENDING);
+
+    std::string command;
+    REQUIRE(vol->begin_mount(mount_options, command));
+    CHECK(vol->get_state() == Devices::Volume::MOUNTING);
+    CHECK(command == "/bin/mount -r -o errors=continue /dev/sdx1 \"/run/MounTA/1/1\"");
+    REQUIRE(created_directories.size() == 1);
+    CHECK(created_directories[0] == "/run/MounTA/1/1");
+
+    vol->finish_mount(true);
+    CHECK(vol->get_state() == Devices::Volume::MOUNTED);
+    CHECK(vol->get_mountpoint_name() == "/run/MounTA/1/1");
+    CHECK(removed_directories.empty());
+
+    REQUIRE(vol->begin_unmount(command));
+    CHECK(vol->get_state() == Devices::Volume::UNMOUNTING);
+    CHECK(command == "/bin/umount  \"/run/MounTA/1/1\"");
+
+    vol->finish_unmount(true);
+    CHECK(vol->get_state() == Devices::Volume::UNMOUNTED);
+    CHECK(vol->get_mountpoint_name().empty());
+    REQUIRE(removed_directories.size() == 1);
+    CHECK(removed_directories[0] == "/run/MounTA/1/1");
+}
+
+/*!\test
+ * Unmounted volumes can be mounted again.
+ */
+TEST_CASE_FIXTURE(Fixture, "Unmounted volume is mounted again")
+{
+    auto vol(mk_volume(2, "/dev/sdx2"));
+    std::string command;
+
+    REQUIRE(vol->begin_mount(mount_options, command));
+    vol->finish_mount(true);
+    REQUIRE(vol->begin_unmount(command));
+    vol->finish_unmount(true);
+    REQUIRE(vol->get_state() == Devices::Volume::UNMOUNTED);
+
+    REQUIRE(vol->begin_mount(mount_options, command));
+    CHECK(vol->get_state() == Devices::Volume::MOUNTING);
+    CHECK(command == "/bin/mount -r -o errors=continue /dev/sdx2 \"/run/MounTA/1/2\"");
+    CHECK(created_directories.size() == 2);
+
+    vol->finish_mount(true);
+    CHECK(vol->get_state() == Devices::Volume::MOUNTED);
+
+    REQUIRE(vol->begin_unmount(command));
+    vol->finish_unmount(true);
+    CHECK(vol->get_state() == Devices::Volume::UNMOUNTED);
+    CHECK(removed_directories.size() == 2);
+}
+
+/*!\test
+ * A failed mount removes the mountpoint, but may be retried.
+ */
+TEST_CASE_FIXTURE(Fixture, "Failed mount leaves volume unusable")
+{
+    auto vol(mk_volume(1, "/dev/sdx1"));
+    std::string command;
+
+    REQUIRE(vol->begin_mount(mount_options, command));
+    vol->finish_mount(false);
+    CHECK(vol->get_state() == Devices::Volume::UNUSABLE);
+    CHECK(vol->get_mountpoint_name().empty());
+    REQUIRE(removed_directories.size() == 1);
+    CHECK(removed_directories[0] == "/run/MounTA/1/1");
+
+    REQUIRE(vol->begin_mount(mount_options, command));
+    CHECK(vol->get_state() == Devices::Volume::MOUNTING);
+    vol->finish_mount(false);
+    CHECK(vol->get_state() == Devices::Volume::UNUSABLE);
+    CHECK(removed_directories.size() == 2);
+}
+
+/*!\test
+ * No mount tool is run if the mountpoint cannot be created.
+ */
+TEST_CASE_FIXTURE(Fixture, "Volume is unusable if mountpoint cannot be created")
+{
+    auto vol(mk_volume(1, "/dev/sdx1"));
+    std::string command("garbage");
+
+    fail_mkdir = true;
+
+    CHECK_FALSE(vol->begin_mount(mount_options, command));
+    CHECK(command.empty());
+    CHECK(vol->get_state() == Devices::Volume::UNUSABLE);
+    CHECK(removed_directories.empty());
+}
+
+/*!\test
+ * A failed unmount keeps the volume mounted, including its mountpoint.
+ */
+TEST_CASE_FIXTURE(Fixture, "Failed unmount leaves volume mounted")
+{
+    auto vol(mk_volume(1, "/dev/sdx1"));
+    std::string command;
+
+    REQUIRE(vol->begin_mount(mount_options, command));
+    vol->finish_mount(true);
+    REQUIRE(vol->begin_unmount(command));
+    vol->finish_unmount(false);
+    CHECK(vol->get_state() == Devices::Volume::MOUNTED);
+    CHECK(vol->get_mountpoint_name() == "/run/MounTA/1/1");
+    CHECK(removed_directories.empty());
+
+    REQUIRE(vol->begin_unmount(command));
+    vol->finish_unmount(true);
+    CHECK(vol->get_state() == Devices::Volume::UNMOUNTED);
+    CHECK(removed_directories.size() == 1);
+}
+
+/*!\test
+ * Volumes of the same device are mounted concurrently and complete in any
+ * order without affecting each other.
+ */
+TEST_CASE_FIXTURE(Fixture, "Concurrent mounts of volumes on one device are independent")
+{
+    auto vol1(mk_volume(1, "/dev/sdx1"));
+    auto vol2(mk_volume(2, "/dev/sdx2"));
+    auto vol3(mk_volume(3, "/dev/sdx3"));
+    std::string command;
+
+    REQUIRE(vol1->begin_mount(mount_options, command));
+    REQUIRE(vol2->begin_mount(mount_options, command));
+    REQUIRE(vol3->begin_mount(mount_options, command));
+    CHECK(created_directories.size() == 3);
+
+    vol3->finish_mount(true);
+    CHECK(vol1->get_state() == Devices::Volume::MOUNTING);
+    CHECK(vol2->get_state() == Devices::Volume::MOUNTING);
+    CHECK(vol3->get_state() == Devices::Volume::MOUNTED);
+
+    vol1->finish_mount(false);
+    CHECK(vol1->get_state() == Devices::Volume::UNUSABLE);
+    CHECK(vol2->get_state() == Devices::Volume::MOUNTING);
+    CHECK(vol3->get_state() == Devices::Volume::MOUNTED);
+    REQUIRE(removed_directories.size() == 1);
+    CHECK(removed_directories[0] == "/run/MounTA/1/1");
+
+    vol2->finish_mount(true);
+    CHECK(vol2->get_state() == Devices::Volume::MOUNTED);
+    CHECK(vol2->get_mountpoint_name() == "/run/MounTA/1/2");
+    CHECK(vol3->get_mountpoint_name() == "/run/MounTA/1/3");
+
+    REQUIRE(vol2->begin_unmount(command));
+    REQUIRE(vol3->begin_unmount(command));
+    vol2->finish_unmount(true);
+    vol3->finish_unmount(true);
+    CHECK(vol2->get_state() == Devices::Volume::UNMOUNTED);
+    CHECK(vol3->get_state() == Devices::Volume::UNMOUNTED);
+    CHECK(removed_directories.size() == 3);
+}
+
+/*!\test
+ * A specific file system driver is passed to the mount tool, and another one
+ * may be tried after a failure without leaving state MOUNTING.
+ */
+TEST_CASE_FIXTURE(Fixture, "Volume is mounted with fallback file system driver")
+{
+    static constexpr Automounter::FSDriver kernel_driver("ntfs3", "-o umask=222", "ntfs3", nullptr);
+    static constexpr Automounter::FSDriver fuse_driver("ntfs-3g", "-o umask=222", "fuse", "/sbin/mount.ntfs-3g");
+
+    auto vol(mk_volume(1, "/dev/sdx1"));
+    std::string command;
+
+    REQUIRE(vol->begin_mount(mount_options, &kernel_driver, command));
+    CHECK(vol->get_state() == Devices::Volume::MOUNTING);
+    CHECK(vol->get_fs_driver() == &kernel_driver);
+    CHECK(command == "/bin/mount -r -t ntfs3 -o umask=222 /dev/sdx1 \"/run/MounTA/1/1\"");
+
+    REQUIRE(vol->retry_mount(mount_options, fuse_driver, command));
+    CHECK(vol->get_state() == Devices::Volume::MOUNTING);
+    CHECK(vol->get_fs_driver() == &fuse_driver);
+    CHECK(command == "/bin/mount -r -t ntfs-3g -o umask=222 /dev/sdx1 \"/run/MounTA/1/1\"");
+    CHECK(created_directories.size() == 1);
+    CHECK(removed_directories.empty());
+
+    vol->finish_mount(true);
+    CHECK(vol->get_state() == Devices::Volume::MOUNTED);
+    CHECK(vol->get_fs_driver() == &fuse_driver);
+
+    REQUIRE(vol->begin_unmount(command));
+    vol->finish_unmount(true);
+
+    /* the mount tool chooses */
+    REQUIRE(vol->begin_mount(mount_options, command));
+    CHECK(vol->get_fs_driver() == nullptr);
+    CHECK(command == "/bin/mount -r -o errors=continue /dev/sdx1 \"/run/MounTA/1/1\"");
+    vol->finish_mount(false);
+}
+
+TEST_SUITE_END();
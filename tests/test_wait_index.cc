@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026  T+A elektroakustik GmbH & Co. KG
+ *
+ * This file is part of MounTA.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA  02110-1301, USA.
+ */
+
+
+#if HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <doctest.h>
+
+#include "wait_index.hh"
+
+TEST_SUITE_BEGIN("Wait index");
+
+/*!\test
+ * All waiters for a key are taken at once, others are left alone.
+ */
+TEST_CASE("Waiters are taken by key")
+{
+    Automounter::WaitIndex<int> index;
+
+    index.add("uuid-a", 1);
+    index.add("uuid-b", 2);
+    index.add("uuid-a", 3);
+    CHECK(index.size() == 3);
+
+    const auto a(index.take("uuid-a"));
+    REQUIRE(a.size() == 2);
+    CHECK(a[0] == 1);
+    CHECK(a[1] == 3);
+    CHECK(index.size() == 1);
+
+    CHECK(index.take("uuid-a").empty());
+    CHECK(index.take("uuid-c").empty());
+
+    const auto b(index.take("uuid-b"));
+    REQUIRE(b.size() == 1);
+    CHECK(b[0] == 2);
+    CHECK(index.size() == 0);
+}
+
+/*!\test
+ * Timed out waiters are removed individually.
+ */
+TEST_CASE("Single waiter is removed")
+{
+    Automounter::WaitIndex<int> index;
+
+    index.add("uuid-a", 1);
+    index.add("uuid-a", 2);
+
+    CHECK(index.remove("uuid-a", 1));
+    CHECK_FALSE(index.remove("uuid-a", 1));
+    CHECK_FALSE(index.remove("uuid-b", 2));
+    CHECK(index.size() == 1);
+
+    CHECK(index.remove("uuid-a", 2));
+    CHECK(index.size() == 0);
+    CHECK(index.take("uuid-a").empty());
+}
+
+/*!\test
+ * On shutdown, all waiters are taken regardless of their keys.
+ */
+TEST_CASE("All waiters are taken")
+{
+    Automounter::WaitIndex<int> index;
+
+    index.add("uuid-a", 1);
+    index.add("uuid-b", 2);
+    index.add("uuid-c", 3);
+
+    auto all(index.take_all());
+    std::sort(all.begin(), all.end());
+
+    REQUIRE(all.size() == 3);
+    CHECK(all[0] == 1);
+    CHECK(all[2] == 3);
+    CHECK(index.size() == 0);
+    CHECK(index.take("uuid-b").empty());
+}
+
+TEST_SUITE_END();